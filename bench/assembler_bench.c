@@ -0,0 +1,184 @@
+/**
+ * Assembler phase benchmark.
+ * Assembles each given source and reports, separately for macro expansion, the first cycle,
+ * the second cycle and output writing: the time taken, lines/sec, words/sec and the peak RSS
+ * reached by the end of the phase. Every file is assembled in its own process, so the peak RSS
+ * of a file is not hidden by a larger file measured before it.
+ *
+ * Usage: assembler_bench <file1> [file2] ...   (base names, without the .as extension)
+ */
+
+/* fork, getrusage and clock_gettime are not part of ANSI C, request them from the POSIX headers */
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+#include "assembler.h"
+#include "macro_processor.h"
+#include "source_file.h"
+#include "line_buffer.h"
+#include "diagnostics.h"
+#include "utils.h"
+
+#define BENCH_PHASE_COUNT 4
+
+const char* BENCH_PHASE_NAMES[BENCH_PHASE_COUNT] = {"macro", "first cycle", "second cycle", "output"};
+
+
+/**
+ * @return The current monotonic time in seconds.
+ */
+double now(void) {
+    struct timespec time;
+
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec + time.tv_nsec / 1e9;
+}
+
+/**
+ * @return The peak resident set size of the process so far, in kilobytes.
+ */
+long peak_rss_kb(void) {
+    struct rusage usage;
+
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+/**
+ * @param filename The file to count the lines of.
+ * @return The number of lines in the file.
+ */
+unsigned long count_file_lines(const char* filename) {
+    source_file file;
+    line_reader reader;
+    line_view line;
+    unsigned long count = 0;
+
+    if (source_file_open(&file, filename)) {
+        return 0;
+    }
+    line_reader_init(&reader, file.data, file.size);
+    while (line_reader_next(&reader, &line)) {
+        count++;
+    }
+    source_file_close(&file);
+    return count;
+}
+
+/**
+ * Prints the result line of a phase.
+ *
+ * @param base_name The file measured.
+ * @param phase The index of the phase.
+ * @param seconds The time taken by the phase.
+ * @param lines The number of lines processed by the phase.
+ * @param words The number of words produced by the file.
+ */
+void print_phase(const char* base_name, int phase, double seconds, unsigned long lines, unsigned long words) {
+    if (seconds <= 0) {
+        seconds = 1e-9;
+    }
+    printf("%-28s %-13s %10.4f %14.0f %14.0f %12ld\n", base_name, BENCH_PHASE_NAMES[phase], seconds,
+           lines / seconds, words / seconds, peak_rss_kb());
+}
+
+/**
+ * Assembles a single file, measuring every phase.
+ *
+ * @param base_name The base name of the file (without the .as extension).
+ * @return 0 on success, 1 if the file could not be assembled.
+ */
+int bench_file(char* base_name) {
+    char as_file[FILENAME_MAX];
+    char am_file[FILENAME_MAX];
+    macro_table macros;
+    line_buffer source;
+    assembly_unit unit;
+    object_file image;
+    diagnostics diag;
+    unsigned long as_lines, am_lines = 0, words = 0;
+    double start;
+    int failed;
+
+    copy_filename_with_different_extension(base_name, as_file, ".as");
+    copy_filename_with_different_extension(base_name, am_file, ".am");
+    as_lines = count_file_lines(as_file);
+
+    macro_table_init(&macros);
+    line_buffer_init(&source);
+    assembly_init(&unit);
+    memset(&image, 0, sizeof(image));
+    diagnostics_init(&diag);
+
+    /* Every phase runs only if the previous one succeeded */
+    start = now();
+    failed = macro_process_file(as_file, &macros, &source, &diag, NULL);
+    if (!failed) {
+        am_lines = line_buffer_count(&source);
+        print_phase(base_name, 0, now() - start, as_lines, 0);
+        start = now();
+        failed = first_cycle(&unit, &source, &diag);
+    }
+    if (!failed) {
+        words = (unit.ICF - CODE_BASE_ADDRESS) + unit.DCF;
+        print_phase(base_name, 1, now() - start, am_lines, words);
+        start = now();
+        failed = second_cycle(&unit, &diag);
+    }
+    if (!failed) {
+        print_phase(base_name, 2, now() - start, am_lines, words);
+        start = now();
+        failed = assembly_image(&unit, &image) || save_output_files(am_file, &image, TEXT_OBJECT, &diag, NULL);
+        object_file_free(&image);
+    }
+    if (!failed) {
+        print_phase(base_name, 3, now() - start, am_lines, words);
+    }
+
+    diagnostics_flush(&diag, stderr);
+    diagnostics_free(&diag);
+    assembly_free(&unit);
+    line_buffer_free(&source);
+    macro_table_free(&macros);
+    return failed;
+}
+
+int main(int argc, char* argv[]) {
+    int i;
+    int status;
+    int failed = 0;
+    pid_t child;
+
+    if (argc < 2) {
+        printf("Usage: %s <file1> [file2] ...\n", argv[0]);
+        return 1;
+    }
+
+    printf("%-28s %-13s %10s %14s %14s %12s\n", "file", "phase", "seconds", "lines/sec", "words/sec", "peak RSS KB");
+    for (i = 1; i < argc; i++) {
+        fflush(stdout);
+        child = fork();
+        if (child < 0) {
+            printf("Error: Could not start a process for %s.\n", argv[i]);
+            return 1;
+        }
+        if (child == 0) {
+            status = bench_file(argv[i]);
+            fflush(stdout);
+            _exit(status);
+        }
+        if (waitpid(child, &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            printf("Error: Could not assemble %s.\n", argv[i]);
+            failed = 1;
+        }
+    }
+
+    return failed;
+}
@@ -0,0 +1,312 @@
+/**
+ * Synthetic corpus generator.
+ * Writes a large, valid assembly source to the standard output: macro definitions and invocations,
+ * `.extern`/`.entry` symbols, labeled `.data`/`.string` directives and instructions cycling through
+ * every opcode with every addressing mode combination allowed by OPCODE_TABLE.
+ *
+ * Usage: generate_corpus <lines> [-m macros] [-x externs] [-e entries] [-d data%] [-l label%] [-s seed]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "consts.h"
+
+#define MACRO_BODY_LINES 3
+#define MAX_DATA_VALUES 8
+#define STRING_LENGTH 12
+#define IMMEDIATE_RANGE 2000
+#define ADDRESS_MODE_COUNT 4
+
+/* An opcode with one of its allowed combinations of addressing modes */
+typedef struct {
+    const OpcodeRule* rule;
+    int src_mode;
+    int dest_mode;
+} instruction_form;
+
+/* Generator settings and state */
+typedef struct {
+    unsigned long lines;
+    unsigned long macros;
+    unsigned long externs;
+    unsigned long entries;
+    unsigned long data_percent;
+    unsigned long label_percent;
+    unsigned long seed;
+    unsigned long statements;
+    unsigned long code_labels;  /* labels on instructions: L0, L1, ... */
+    unsigned long data_labels;  /* labels on directives: D0, D1, ... */
+    instruction_form forms[64];
+    int form_count;
+    int next_form;
+} corpus;
+
+
+/**
+ * @param corpus The generator state.
+ * @param range The number of possible values.
+ * @return A pseudo random number in [0, range).
+ */
+unsigned long next_random(corpus* corpus, unsigned long range) {
+    corpus->seed = (corpus->seed * 1103515245UL + 12345UL) & 0xFFFFFFFFUL;
+    return range ? (corpus->seed >> 8) % range : 0;
+}
+
+/**
+ * Lists every opcode with every allowed combination of addressing modes.
+ *
+ * @param corpus The generator state.
+ */
+void collect_instruction_forms(corpus* corpus) {
+    int i, src, dest;
+
+    corpus->form_count = 0;
+    for (i = 0; i < OPCODE_TABLE_SIZE; i++) {
+        const OpcodeRule* rule = &OPCODE_TABLE[i];
+        /* Without a source (or destination) operand, the mode set holds a single mode 0 */
+        unsigned int src_modes = rule->num_of_operands == 2 ? rule->source_modes : MODE_BIT(0);
+        unsigned int dest_modes = rule->num_of_operands >= 1 ? rule->dest_modes : MODE_BIT(0);
+
+        for (src = 0; src < ADDRESS_MODE_COUNT; src++) {
+            for (dest = 0; dest < ADDRESS_MODE_COUNT; dest++) {
+                if ((src_modes & MODE_BIT(src)) && (dest_modes & MODE_BIT(dest))) {
+                    instruction_form* form = &corpus->forms[corpus->form_count++];
+                    form->rule = rule;
+                    form->src_mode = src;
+                    form->dest_mode = dest;
+                }
+            }
+        }
+    }
+    corpus->next_form = 0;
+}
+
+/**
+ * @param corpus The generator state.
+ * @param statement The index of a statement.
+ * @return 1 if the statement is a `.data`/`.string` directive, 0 if it is an instruction.
+ */
+int is_data_statement(const corpus* corpus, unsigned long statement) {
+    return (statement * 37 % 100) < corpus->data_percent;
+}
+
+/**
+ * @param corpus The generator state.
+ * @param statement The index of a statement.
+ * @return 1 if the statement has a label.
+ */
+int is_labeled_statement(const corpus* corpus, unsigned long statement) {
+    return (statement * 61 % 100) < corpus->label_percent;
+}
+
+/**
+ * Writes an operand in the given addressing mode, referring to labels that are defined in the corpus.
+ *
+ * @param corpus The generator state.
+ * @param mode The addressing mode.
+ */
+void write_operand(corpus* corpus, int mode) {
+    unsigned long choice;
+
+    switch (mode) {
+        case 0:
+            printf("#%ld", (long)next_random(corpus, IMMEDIATE_RANGE) - IMMEDIATE_RANGE / 2);
+            break;
+        case 2:
+            printf("&L%lu", next_random(corpus, corpus->code_labels));
+            break;
+        case 3:
+            printf("r%lu", next_random(corpus, 8));
+            break;
+        default:
+            /* a code label, a data label or an external symbol */
+            choice = next_random(corpus, 3);
+            if (choice == 2 && corpus->externs) {
+                printf("X%lu", next_random(corpus, corpus->externs));
+            } else if (choice == 1 && corpus->data_labels) {
+                printf("D%lu", next_random(corpus, corpus->data_labels));
+            } else {
+                printf("L%lu", next_random(corpus, corpus->code_labels));
+            }
+            break;
+    }
+}
+
+/**
+ * Writes the next instruction form, with its operands.
+ *
+ * @param corpus The generator state.
+ */
+void write_instruction(corpus* corpus) {
+    const instruction_form* form = &corpus->forms[corpus->next_form];
+
+    corpus->next_form = (corpus->next_form + 1) % corpus->form_count;
+    printf("%s", OPCODE_STRINGS[form->rule->opcode]);
+    if (form->rule->num_of_operands == 2) {
+        printf(" ");
+        write_operand(corpus, form->src_mode);
+        printf(", ");
+        write_operand(corpus, form->dest_mode);
+    } else if (form->rule->num_of_operands == 1) {
+        printf(" ");
+        write_operand(corpus, form->dest_mode);
+    }
+    printf("\n");
+}
+
+/**
+ * Writes a `.data` or a `.string` directive.
+ *
+ * @param corpus The generator state.
+ */
+void write_data(corpus* corpus) {
+    unsigned long count, i;
+
+    if (next_random(corpus, 2)) {
+        printf(".string \"");
+        for (i = 0; i < STRING_LENGTH; i++) {
+            putchar('a' + (int)next_random(corpus, 26));
+        }
+        printf("\"\n");
+        return;
+    }
+    count = 1 + next_random(corpus, MAX_DATA_VALUES);
+    printf(".data ");
+    for (i = 0; i < count; i++) {
+        printf(i ? ", %ld" : "%ld", (long)next_random(corpus, 100000) - 50000);
+    }
+    printf("\n");
+}
+
+/**
+ * Counts the statements and the labels of the corpus, so operands can refer to any label.
+ *
+ * @param corpus The generator state.
+ */
+void plan_corpus(corpus* corpus) {
+    unsigned long overhead = 1 + corpus->externs + corpus->entries + corpus->macros * (MACRO_BODY_LINES + 2);
+    unsigned long i;
+
+    corpus->statements = corpus->lines > overhead ? corpus->lines - overhead : 1;
+    corpus->code_labels = 0;
+    corpus->data_labels = 0;
+    for (i = 0; i < corpus->statements; i++) {
+        if (i == 0 || is_labeled_statement(corpus, i)) {
+            if (is_data_statement(corpus, i) && i != 0) {
+                corpus->data_labels++;
+            } else {
+                corpus->code_labels++;
+            }
+        }
+    }
+    if (corpus->entries > corpus->code_labels) {
+        corpus->entries = corpus->code_labels;
+    }
+}
+
+/**
+ * Writes the whole corpus to the standard output.
+ *
+ * @param corpus The generator state.
+ */
+void write_corpus(corpus* corpus) {
+    unsigned long i, j;
+    unsigned long code_label = 0, data_label = 0;
+
+    printf("; synthetic corpus: %lu lines, %lu macros, %lu externs, %lu entries\n",
+           corpus->lines, corpus->macros, corpus->externs, corpus->entries);
+
+    for (i = 0; i < corpus->externs; i++) {
+        printf(".extern X%lu\n", i);
+    }
+
+    for (i = 0; i < corpus->macros; i++) {
+        printf("mcro M%lu\n", i);
+        for (j = 0; j < MACRO_BODY_LINES; j++) {
+            write_instruction(corpus);
+        }
+        printf("mcroend\n");
+    }
+
+    for (i = 0; i < corpus->statements; i++) {
+        /* The first statement is a labeled instruction, so code labels always exist */
+        int labeled = i == 0 || is_labeled_statement(corpus, i);
+        int is_data = i != 0 && is_data_statement(corpus, i);
+
+        if (!labeled && corpus->macros && i % 10 == 5) {
+            printf("M%lu\n", next_random(corpus, corpus->macros));
+            continue;
+        }
+        if (labeled) {
+            if (is_data) {
+                printf("D%lu: ", data_label++);
+            } else {
+                printf("L%lu: ", code_label++);
+            }
+        }
+        if (is_data) {
+            write_data(corpus);
+        } else {
+            write_instruction(corpus);
+        }
+    }
+
+    /* Spread the entries over the code labels */
+    for (i = 0; i < corpus->entries; i++) {
+        printf(".entry L%lu\n", i * (corpus->code_labels / corpus->entries));
+    }
+}
+
+/**
+ * @param value The option value.
+ * @param result Receives the number.
+ * @return 1 if the value is a number, 0 otherwise.
+ */
+int parse_count(const char* value, unsigned long* result) {
+    char* end;
+
+    if (value == NULL) {
+        return 0;
+    }
+    *result = strtoul(value, &end, 10);
+    return end != value && *end == '\0';
+}
+
+int main(int argc, char* argv[]) {
+    corpus corpus;
+    unsigned long* target;
+    int i;
+
+    if (argc < 2 || !parse_count(argv[1], &corpus.lines) || corpus.lines == 0) {
+        printf("Usage: %s <lines> [-m macros] [-x externs] [-e entries] [-d data%%] [-l label%%] [-s seed]\n", argv[0]);
+        return 1;
+    }
+    corpus.macros = corpus.lines / 500 + 1;
+    corpus.externs = corpus.lines / 200 + 1;
+    corpus.entries = corpus.lines / 200 + 1;
+    corpus.data_percent = 20;
+    corpus.label_percent = 25;
+    corpus.seed = 1;
+
+    for (i = 2; i < argc; i++) {
+        target = NULL;
+        if (!strcmp(argv[i], "-m")) target = &corpus.macros;
+        else if (!strcmp(argv[i], "-x")) target = &corpus.externs;
+        else if (!strcmp(argv[i], "-e")) target = &corpus.entries;
+        else if (!strcmp(argv[i], "-d")) target = &corpus.data_percent;
+        else if (!strcmp(argv[i], "-l")) target = &corpus.label_percent;
+        else if (!strcmp(argv[i], "-s")) target = &corpus.seed;
+        if (target == NULL || !parse_count(argv[i + 1], target)) {
+            printf("Error: invalid option %s\n", argv[i]);
+            return 1;
+        }
+        i++;
+    }
+
+    collect_instruction_forms(&corpus);
+    plan_corpus(&corpus);
+    write_corpus(&corpus);
+    return 0;
+}
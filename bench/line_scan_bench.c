@@ -0,0 +1,231 @@
+/**
+ * Line scanner benchmark.
+ * Compares scanning lines for their blanks, first colon and comma errors one character at a time with
+ * <ctype.h>, as the lexer used to, with scan_line (the CHAR_CLASS table and SSE2 when available), and
+ * validating labels with isalpha/isalnum versus the CHAR_CLASS table. Checks that all agree.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+
+#include "consts.h"
+#include "line_scan.h"
+
+#define SCANS 20000000UL
+
+
+/* Source lines of the shapes the assembler sees, including ones with comma errors */
+const char* LINES[] = {
+    "MAIN:   mov  #-5, r1",
+    "        cmp  LOOP, &END",
+    "LOOP:   add  r3, r4   ",
+    "\tjmp &LOOP",
+    "STR:    .string \"a, b: c;\"",
+    "DATA1:  .data 7, -57, 17, 9, 3000, -1, 42",
+    "; a comment, with: punctuation",
+    "",
+    "        ",
+    "        prn #48",
+    "K: .data 1,, 2",
+    "        mov r1, r2,",
+    "LONGLABELNAMEFORTHEBENCHMARK1: lea LONGLABELNAMEFORTHEBENCHMARK2, r7   ; eighty",
+    "        .extern EXTERNALLABEL",
+    "        .entry MAIN",
+    "S2: .string \"unterminated, string",
+    "        stop"
+};
+
+/* Labels, valid and not */
+const char* LABELS[] = {
+    "MAIN", "LOOP", "L1234", "x", "LONGLABELNAMEFORTHEBENCHMARK1", "1BAD", "BAD_LABEL", "Bad-label", "r1x", "END"
+};
+
+#define LINE_COUNT (sizeof(LINES) / sizeof(LINES[0]))
+#define LABEL_COUNT (sizeof(LABELS) / sizeof(LABELS[0]))
+
+
+/**
+ * Scans a line one character at a time with <ctype.h>, the way the lexer did before scan_line.
+ *
+ * @param line The line.
+ * @param length The length of the line.
+ * @param scan Receives the first and end of the statement, its first colon and its comma errors.
+ */
+void scan_line_ctype(const char* line, size_t length, line_scan* scan) {
+    size_t start = 0;
+    size_t end = length;
+    size_t i;
+    int after_comma = 0;
+
+    scan->colon = SCAN_NONE;
+    scan->consecutive_commas = 0;
+    scan->open_string = 0;
+
+    while (start < end && isspace((unsigned char)line[start])) {
+        start++;
+    }
+    while (end > start && isspace((unsigned char)line[end - 1])) {
+        end--;
+    }
+    scan->first = start;
+    scan->end = end;
+
+    for (i = start; i < end; i++) {
+        char c = line[i];
+
+        if (c == '"') {
+            scan->open_string = !scan->open_string;
+            after_comma = 0;
+        } else if (scan->open_string) {
+            continue;
+        } else if (c == ',') {
+            if (after_comma) {
+                scan->consecutive_commas = 1;
+            }
+            after_comma = 1;
+        } else if (!isspace((unsigned char)c)) {
+            after_comma = 0;
+            if (c == ':' && scan->colon == SCAN_NONE) {
+                scan->colon = i;
+            }
+        }
+    }
+}
+
+/**
+ * @param label The label.
+ * @return 1 if the label is a letter followed by letters and digits, checked with <ctype.h>.
+ */
+int is_label_ctype(const char* label) {
+    size_t i;
+
+    if (!isalpha((unsigned char)label[0])) {
+        return 0;
+    }
+    for (i = 1; label[i]; i++) {
+        if (!isalnum((unsigned char)label[i])) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * @param label The label.
+ * @return 1 if the label is a letter followed by letters and digits, checked with CHAR_CLASS.
+ */
+int is_label_table(const char* label) {
+    size_t i;
+
+    if (!IS_ALPHA(label[0])) {
+        return 0;
+    }
+    for (i = 1; label[i]; i++) {
+        if (!IS_ALNUM(label[i])) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * @param a A scan by the lexer's former loop.
+ * @param b A scan by scan_line.
+ * @return 1 if the scans agree on everything the former loop computed.
+ */
+int same_scan(const line_scan* a, const line_scan* b) {
+    return a->first == b->first && a->end == b->end && a->colon == b->colon &&
+           a->consecutive_commas == b->consecutive_commas && a->open_string == b->open_string;
+}
+
+/**
+ * Scans every line over and over.
+ *
+ * @param scanner The scanner.
+ * @param checksum Receives a sum of the results, so the work is not optimized away.
+ * @return The time taken in seconds.
+ */
+double time_scanner(void (*scanner)(const char*, size_t, line_scan*), unsigned long* checksum) {
+    size_t lengths[LINE_COUNT];
+    line_scan scan;
+    clock_t start;
+    unsigned long i;
+
+    for (i = 0; i < LINE_COUNT; i++) {
+        lengths[i] = strlen(LINES[i]);
+    }
+    *checksum = 0;
+    start = clock();
+    for (i = 0; i < SCANS; i++) {
+        scanner(LINES[i % LINE_COUNT], lengths[i % LINE_COUNT], &scan);
+        *checksum += scan.end + scan.colon + scan.consecutive_commas;
+    }
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+/**
+ * Validates every label over and over.
+ *
+ * @param validator The validator.
+ * @param checksum Receives the number of valid labels.
+ * @return The time taken in seconds.
+ */
+double time_validator(int (*validator)(const char*), unsigned long* checksum) {
+    clock_t start = clock();
+    unsigned long i;
+
+    *checksum = 0;
+    for (i = 0; i < SCANS; i++) {
+        *checksum += validator(LABELS[i % LABEL_COUNT]);
+    }
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+int main(void) {
+    line_scan expected, scan;
+    double ctype_seconds, scalar_seconds, vector_seconds;
+    double ctype_label_seconds, table_label_seconds;
+    unsigned long ctype_sum, scalar_sum, vector_sum;
+    size_t i;
+    int failed = 0;
+
+    for (i = 0; i < LINE_COUNT; i++) {
+        scan_line_ctype(LINES[i], strlen(LINES[i]), &expected);
+        scan_line_scalar(LINES[i], strlen(LINES[i]), &scan);
+        failed |= !same_scan(&expected, &scan);
+        scan_line(LINES[i], strlen(LINES[i]), &scan);
+        failed |= !same_scan(&expected, &scan);
+    }
+    for (i = 0; i < LABEL_COUNT; i++) {
+        failed |= is_label_ctype(LABELS[i]) != is_label_table(LABELS[i]);
+    }
+
+    ctype_seconds = time_scanner(scan_line_ctype, &ctype_sum);
+    scalar_seconds = time_scanner(scan_line_scalar, &scalar_sum);
+    vector_seconds = time_scanner(scan_line, &vector_sum);
+    failed |= ctype_sum != scalar_sum || ctype_sum != vector_sum;
+
+    printf("%24s %16s\n", "line scanner", "lines/sec");
+    printf("%24s %16.0f\n", "ctype loop", SCANS / ctype_seconds);
+    printf("%24s %16.0f\n", "scan_line_scalar", SCANS / scalar_seconds);
+    printf("%24s %16.0f\n", "scan_line", SCANS / vector_seconds);
+    printf("speedup: %.2fx\n", ctype_seconds / vector_seconds);
+
+    ctype_label_seconds = time_validator(is_label_ctype, &ctype_sum);
+    table_label_seconds = time_validator(is_label_table, &scalar_sum);
+    failed |= ctype_sum != scalar_sum;
+
+    printf("%24s %16s\n", "label check", "labels/sec");
+    printf("%24s %16.0f\n", "isalpha/isalnum", SCANS / ctype_label_seconds);
+    printf("%24s %16.0f\n", "CHAR_CLASS", SCANS / table_label_seconds);
+    printf("speedup: %.2fx\n", ctype_label_seconds / table_label_seconds);
+
+    if (failed) {
+        printf("Error: the scanners disagree\n");
+        return 1;
+    }
+    return 0;
+}
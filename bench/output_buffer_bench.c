@@ -0,0 +1,104 @@
+/**
+ * Object file writer benchmark.
+ * Compares writing object file lines ("%07d %06X\n") through fprintf, as the assembler used to,
+ * with the output buffer (table driven formatting and a single write), and checks both
+ * produce the same bytes.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "output_buffer.h"
+
+#define WORDS 2000000
+#define FPRINTF_FILE "bench/output_fprintf.tmp"
+#define BUFFER_FILE "bench/output_buffer.tmp"
+
+
+/**
+ * @param index The index of the word.
+ * @return A pseudo random 24-bit word.
+ */
+unsigned int word_value(unsigned long index) {
+    return (unsigned int)((index * 2654435761UL) & 0xFFFFFF);
+}
+
+/**
+ * @param filename The file to read.
+ * @param size Receives the size of the file.
+ * @return The content of the file (to be freed by the caller), or NULL on failure.
+ */
+char* read_file(const char* filename, long* size) {
+    FILE* file = fopen(filename, "rb");
+    char* content;
+
+    if (!file) {
+        return NULL;
+    }
+    fseek(file, 0, SEEK_END);
+    *size = ftell(file);
+    rewind(file);
+    content = (char*)malloc(*size + 1);
+    if (content && fread(content, 1, *size, file) != (size_t)*size) {
+        free(content);
+        content = NULL;
+    }
+    fclose(file);
+    return content;
+}
+
+int main(void) {
+    FILE* file;
+    output_buffer output;
+    unsigned long i;
+    clock_t start;
+    double fprintf_seconds, buffer_seconds;
+    char* fprintf_content;
+    char* buffer_content;
+    long fprintf_size, buffer_size;
+
+    start = clock();
+    file = fopen(FPRINTF_FILE, "w");
+    if (!file) {
+        printf("Error: Could not create %s\n", FPRINTF_FILE);
+        return 1;
+    }
+    for (i = 0; i < WORDS; i++) {
+        fprintf(file, "%07d ", (int)(i + 100));
+        fprintf(file, "%06X\n", word_value(i));
+    }
+    fclose(file);
+    fprintf_seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    start = clock();
+    output_buffer_init(&output, WORDS * 15);
+    for (i = 0; i < WORDS; i++) {
+        output_append_decimal(&output, i + 100, 7, '0');
+        output_append_char(&output, ' ');
+        output_append_hex(&output, word_value(i), 6);
+        output_append_char(&output, '\n');
+    }
+    output_buffer_write_file(&output, BUFFER_FILE);
+    output_buffer_free(&output);
+    buffer_seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    printf("%16s %16s\n", "writer", "words/sec");
+    printf("%16s %16.0f\n", "fprintf", WORDS / fprintf_seconds);
+    printf("%16s %16.0f\n", "output_buffer", WORDS / buffer_seconds);
+    printf("speedup: %.2fx\n", fprintf_seconds / buffer_seconds);
+
+    fprintf_content = read_file(FPRINTF_FILE, &fprintf_size);
+    buffer_content = read_file(BUFFER_FILE, &buffer_size);
+    if (!fprintf_content || !buffer_content || fprintf_size != buffer_size ||
+        memcmp(fprintf_content, buffer_content, fprintf_size)) {
+        printf("Error: outputs differ\n");
+    }
+    free(fprintf_content);
+    free(buffer_content);
+    remove(FPRINTF_FILE);
+    remove(BUFFER_FILE);
+
+    return 0;
+}
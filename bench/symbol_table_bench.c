@@ -0,0 +1,65 @@
+/**
+ * Symbol table benchmark.
+ * Measures the average lookup cost for growing label counts; with the hashed symbol table
+ * the cost per lookup should stay flat instead of growing with the number of labels.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "symbol_table.h"
+
+#define LOOKUPS 2000000
+#define NAME_LENGTH 32
+
+
+int main(void) {
+    size_t label_counts[] = {1000, 10000, 100000, 1000000};
+    int num_sizes = sizeof(label_counts) / sizeof(label_counts[0]);
+    int i;
+    size_t j, found;
+    char (*names)[NAME_LENGTH];
+    symbol_table symbols;
+    clock_t start;
+    double seconds;
+
+    printf("%10s %14s %14s\n", "labels", "insert ns/op", "lookup ns/op");
+    for (i = 0; i < num_sizes; i++) {
+        names = malloc(label_counts[i] * NAME_LENGTH);
+        if (!names) {
+            printf("Error: Memory allocation failed.\n");
+            return 1;
+        }
+        for (j = 0; j < label_counts[i]; j++) {
+            sprintf(names[j], "LBL%lu", (unsigned long)j);
+        }
+
+        symbol_table_init(&symbols);
+        start = clock();
+        for (j = 0; j < label_counts[i]; j++) {
+            symbol_table_insert(&symbols, names[j], (int)j, code_label);
+        }
+        seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+        printf("%10lu %14.1f", (unsigned long)label_counts[i], seconds * 1e9 / label_counts[i]);
+
+        found = 0;
+        start = clock();
+        for (j = 0; j < LOOKUPS; j++) {
+            /* Stride through the names so lookups are not served from the same cache lines */
+            if (symbol_table_lookup(&symbols, names[(j * 7919) % label_counts[i]])) {
+                found++;
+            }
+        }
+        seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+        printf(" %14.1f\n", seconds * 1e9 / LOOKUPS);
+
+        if (found != LOOKUPS) {
+            printf("Error: %lu lookups failed.\n", (unsigned long)(LOOKUPS - found));
+        }
+        symbol_table_free(&symbols);
+        free(names);
+    }
+
+    return 0;
+}
@@ -0,0 +1,104 @@
+/**
+ * Allocation counters: the calls, bytes and peak of the memory held by each subsystem of a file,
+ * counted by the tables that allocate it. Without counters the calls go straight to the C library.
+ */
+
+#include "alloc_counters.h"
+
+
+alloc_counters* subsystem_counters(alloc_counters* counters, alloc_subsystem subsystem) {
+    return counters ? &counters[subsystem] : NULL;
+}
+
+/**
+ * Counts a successful allocation or reallocation.
+ *
+ * @param counters The counters, may be NULL.
+ * @param old_size The size of the block before the call (0 for a new block).
+ * @param size The size of the block after the call.
+ * @param realloc_call Whether a block already allocated was reallocated.
+ */
+void count_call(alloc_counters* counters, size_t old_size, size_t size, int realloc_call) {
+    if (!counters) {
+        return;
+    }
+    counters->calls++;
+    counters->reallocs += realloc_call;
+    counters->bytes += size;
+    counters->live_bytes += size - old_size;
+    if (counters->live_bytes > counters->peak_bytes) {
+        counters->peak_bytes = counters->live_bytes;
+    }
+}
+
+void* counted_malloc(alloc_counters* counters, size_t size) {
+    void* block = malloc(size);
+
+    if (block) {
+        count_call(counters, 0, size, 0);
+    }
+    return block;
+}
+
+void* counted_calloc(alloc_counters* counters, size_t count, size_t size) {
+    void* block = calloc(count, size);
+
+    if (block) {
+        count_call(counters, 0, count * size, 0);
+    }
+    return block;
+}
+
+void* counted_realloc(alloc_counters* counters, void* block, size_t old_size, size_t size) {
+    void* new_block = realloc(block, size);
+
+    if (new_block) {
+        count_call(counters, block ? old_size : 0, size, block != NULL);
+    }
+    return new_block;
+}
+
+void counted_free(alloc_counters* counters, void* block, size_t size) {
+    if (block) {
+        free(block);
+        count_frees(counters, 1, size);
+    }
+}
+
+void count_frees(alloc_counters* counters, size_t count, size_t size) {
+    if (counters) {
+        counters->frees += count;
+        counters->live_bytes -= size;
+    }
+}
+
+void count_held(alloc_counters* counters, size_t size) {
+    if (counters) {
+        counters->live_bytes += size;
+        if (counters->live_bytes > counters->peak_bytes) {
+            counters->peak_bytes = counters->live_bytes;
+        }
+    }
+}
+
+void alloc_counters_add(alloc_counters* total, const alloc_counters* file) {
+    total->calls += file->calls;
+    total->reallocs += file->reallocs;
+    total->frees += file->frees;
+    total->bytes += file->bytes;
+    if (file->live_bytes > total->live_bytes) {
+        total->live_bytes = file->live_bytes;
+    }
+    if (file->peak_bytes > total->peak_bytes) {
+        total->peak_bytes = file->peak_bytes;
+    }
+}
+
+void alloc_counters_join(alloc_counters* counters, const alloc_counters* other) {
+    counters->calls += other->calls;
+    counters->reallocs += other->reallocs;
+    counters->frees += other->frees;
+    counters->bytes += other->bytes;
+    counters->live_bytes += other->live_bytes;
+    counters->peak_bytes += other->peak_bytes;
+}
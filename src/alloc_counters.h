@@ -0,0 +1,102 @@
+#pragma once
+
+#include <stdlib.h>
+
+
+/* The subsystems whose allocations are counted separately */
+typedef enum {
+    MACRO_ALLOCS,     /* the macro table */
+    SOURCE_ALLOCS,    /* the expanded source */
+    SYMBOL_ALLOCS,    /* the symbol table and its label names */
+    DATA_ALLOCS,      /* the data section */
+    CODE_ALLOCS,      /* the code section and the operands left for the second cycle */
+    EXTERNAL_ALLOCS,  /* the uses of external labels */
+    OUTPUT_ALLOCS,    /* the object image and the content of the output files */
+    SUBSYSTEM_COUNT
+} alloc_subsystem;
+
+/* The allocations of a subsystem. The counters are not synchronized: the tables counted in the same
+ * counters must be used by a single thread at a time.
+ */
+typedef struct {
+    unsigned long calls;     /* allocations and reallocations */
+    unsigned long reallocs;  /* reallocations of a block already allocated */
+    unsigned long frees;
+    size_t bytes;            /* the bytes asked for by all the calls */
+    size_t live_bytes;       /* the bytes held right now: memory kept after the end of a file, or leaked */
+    size_t peak_bytes;       /* the most bytes held at any time */
+} alloc_counters;
+
+/**
+ * @param counters The counters of all the subsystems, indexed by alloc_subsystem, NULL if not counted.
+ * @param subsystem The subsystem.
+ * @return The counters of the subsystem, NULL if not counted.
+ */
+alloc_counters* subsystem_counters(alloc_counters* counters, alloc_subsystem subsystem);
+
+/**
+ * @param counters The counters, NULL if the allocation is not counted.
+ * @param size The size of the block.
+ * @return The block, or NULL on memory allocation failure.
+ */
+void* counted_malloc(alloc_counters* counters, size_t size);
+
+/**
+ * @param counters The counters, NULL if the allocation is not counted.
+ * @param count The number of elements.
+ * @param size The size of an element.
+ * @return The zeroed block, or NULL on memory allocation failure.
+ */
+void* counted_calloc(alloc_counters* counters, size_t count, size_t size);
+
+/**
+ * @param counters The counters, NULL if the allocation is not counted.
+ * @param block The block, or NULL to allocate a new one.
+ * @param old_size The size of the block (0 if there is none).
+ * @param size The new size of the block.
+ * @return The block, or NULL on memory allocation failure (the old block is then kept).
+ */
+void* counted_realloc(alloc_counters* counters, void* block, size_t old_size, size_t size);
+
+/**
+ * @param counters The counters, NULL if the release is not counted.
+ * @param block The block, may be NULL.
+ * @param size The size of the block.
+ */
+void counted_free(alloc_counters* counters, void* block, size_t size);
+
+/**
+ * Counts blocks released by the caller.
+ *
+ * @param counters The counters, may be NULL.
+ * @param count The number of blocks.
+ * @param size The size of all the blocks.
+ */
+void count_frees(alloc_counters* counters, size_t count, size_t size);
+
+/**
+ * Counts memory allocated before the counters were attached to its table (e.g., kept from the
+ * previous file) as held, without counting a call.
+ *
+ * @param counters The counters, may be NULL.
+ * @param size The number of bytes held.
+ */
+void count_held(alloc_counters* counters, size_t size);
+
+/**
+ * Adds the allocations of a file to the totals of a batch. Calls and bytes are summed, the held
+ * and peak bytes keep the largest value (the files share the memory kept between them).
+ *
+ * @param total The batch totals.
+ * @param file The counters of the file.
+ */
+void alloc_counters_add(alloc_counters* total, const alloc_counters* file);
+
+/**
+ * Adds allocations made by another thread at the same time as the ones of the counters. Everything
+ * is summed, the peaks too, as if the peaks had been reached at the same time (an upper bound).
+ *
+ * @param counters The counters.
+ * @param other The counters of the other thread.
+ */
+void alloc_counters_join(alloc_counters* counters, const alloc_counters* other);
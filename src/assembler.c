@@ -8,7 +8,8 @@
  * 1. First Cycle: Parses the input file, builds the symbol table, and translates data and code sections.
  * 2. Second Cycle: Resolves symbols and generates the final machine code.
  * 
- * Outputs:
+ * The assembled tables are turned into an in-memory object image (see object_file.h), from which the
+ * output files are written:
  * - Object file (.obj): Contains the machine code.
  * - Entries file (.ent): Lists entry labels and their addresses.
  * - Externals file (.ext): Lists external labels and their usage addresses.
@@ -17,20 +18,18 @@
 #include "assembler.h"
 
 #include <stdlib.h>
-#include <ctype.h>
 #include <string.h>
 
 #include "utils.h"
+#include "lexer.h"
 #include "consts.h"
+#include "symbol_table.h"
+#include "vector.h"
+#include "output_buffer.h"
+#include "source_file.h"
+#include "object_file.h"
 
-#define MAX_BUF_SIZE 100
-#define MAX_INSTRUCTIONS 1000
 #define LINE_MAX_SIZE 80
-#define CODE_BASE_ADDRESS 100
-#define IMMEDIATE_ADDRESS_MODE 0
-#define DIRECT_ADDRESS_MODE 1
-#define REALTIVE_ADDRESS_MODE 2
-#define REGISTER_ADDRESS_MODE 3
 
 
 /**
@@ -53,13 +52,13 @@ int is_valid_label(const char *label) {
     }
 
     /* Check first character (must be a letter) */
-    if (!isalpha(label[0])) {
+    if (!IS_ALPHA(label[0])) {
         return 0;
     }
 
-    /* Check remaining characters (must be alphanumeric) */
+    /* Check remaining characters (must be alphanumeric), with the CHAR_CLASS table */
     for (i = 1; i < len; i++) {
-        if (!isalnum(label[i])) {
+        if (!IS_ALNUM(label[i])) {
             return 0;
         }
     }
@@ -68,259 +67,73 @@ int is_valid_label(const char *label) {
 }
 
 /**
- * Extracts a label from a line of assembly code. Assumes the label ends with ':'.
+ * Translates the operands of a `.data` directive and populates the data array with integer values.
  * 
- * @param line The line containing the label.
- * @param label The buffer to store the extracted label.
- */
-void get_label(char* line, char* label) {
-    /* Find the position of ':' */
-    char *colon_pos = strchr(line, ':');
-
-    /* Extract the label */
-    int label_length = colon_pos - line;
-    
-    /* Copy the label to a separate string and remove trailing spaces */
-    strncpy(label, line, label_length);
-    label[label_length] = '\0';
-}
-
-/**
- * Checks if a label exists in the symbol table.
- * 
- * @param label The label to check.
- * @param label_table The symbol table.
- * @param label_count The number of labels in the table.
- * @return 1 if the label exists, 0 otherwise.
- */
-int is_label_exist(char* label, label_element* label_table, size_t label_count) {
-    int i;
-    for (i = 0; i < label_count; i++)
-    {
-        if (!strcmp(label_table[i].label_name, label)) {
-            return 1;
-        }
-    }
-    
-    return 0;
-}
-
-/**
- * @param ins The instruction string.
- * @return 1 if the instruction is a `.data` directive, 0 otherwise.
- */
-int is_data_instruction(char* ins) {
-    return NULL != strstr(ins, ".data");
-}
-
-/**
- * @param ins The instruction string.
- * @return 1 if the instruction is a `.entry` directive, 0 otherwise.
- */
-int is_entry_instruction(char* ins) {
-    return NULL != strstr(ins, ".entry");
-}
-
-/**
- * @param ins The instruction string.
- * @return 1 if the instruction is a `.extern` directive, 0 otherwise.
- */
-int is_extern_instruction(char* ins) {
-    return NULL != strstr(ins, ".extern");
-}
-
-/**
- * @param ins The instruction string.
- * @return 1 if the instruction is a `.string` directive, 0 otherwise.
- */
-int is_string_instruction(char* ins) {
-    return NULL != strstr(ins, ".string");
-}
-
-/**
- * Adds a label to the symbol table, reallocating memory as needed.
- * 
- * @param label_table Pointer to the symbol table.
- * @param label_count Pointer to the number of labels in the table.
- * @param label The label to add.
- * @param address The address associated with the label.
- * @param label_type The type of the label (e.g., data, code, extern).
- * @return SUCCESS on success, MEMORY_ALLOCATION_FAILED on failure.
- */
-int add_label_to_symbol_table(label_element** label_table, size_t* label_count, char* label, size_t address, label_options label_type) {
-    char* label_copy;
-    size_t current_label_count = *label_count;
-    /* Allocate memory for the new label table (increase the size) */
-    if (extend_array((void**)label_table, label_count, current_label_count + 1, sizeof(label_element))) {
-        return MEMORY_ALLOCATION_FAILED;
-    }
-
-    /* Assign values to the new label entry */
-    (*label_table)[current_label_count].address = address;
-    (*label_table)[current_label_count].label_type = label_type;
-
-    /* Allocate memory for the label name and copy it */
-    label_copy = (char*)malloc(strlen((label)) + 1);
-    if (!label_copy) {
-        return MEMORY_ALLOCATION_FAILED;
-    }
-    strcpy(label_copy, label);
-
-    (*label_table)[current_label_count].label_name = label_copy;
-
-    return SUCCESS; /* Success */
-}
-
-/**
- * Parses a `.data` directive and populates the data array with integer values.
- * 
- * @param data The data array to populate.
- * @param count Pointer to the current count of data entries.
- * @param line The line containing the `.data` directive.
+ * @param data_table The data vector to populate.
+ * @param ir The lexed `.data` line.
  * @return SUCCESS on success, 1 on failure.
  * 
  */
-int translate_data(data** data_table, size_t* count, char* line) {
-    char *token = strtok(line, " \t");
-    int value;
-    size_t temp_count;
-
-    if (!token || strcmp(token, ".data")) return 1; /* Ensure it's a `.data` directive */
+int translate_data(vector* data_table, const line_ir* ir) {
+    size_t i;
+    data* entry;
 
-    while ((token = strtok(NULL, ",")) != NULL) {
-        strip_whitespace(token);
-        if (strlen(token) == 0) {
+    for (i = 0; i < ir->operand_count; i++) {
+        if (strlen(ir->operands[i].text) == 0) {
             return 1;
         }
-        value = atoi(token); /* Convert the token into an integer */
 
-        temp_count = *count;
-        if (extend_array((void**)data_table, count, *count + 1, sizeof(data))) {
+        entry = (data*)vector_push(data_table);
+        if (!entry) {
             return 1;
         }
 
-        (*data_table)[temp_count].value.integer = value; /* Use the `data` struct's integer field */
+        entry->value.integer = atoi(ir->operands[i].text); /* Use the `data` struct's integer field */
     }
     return SUCCESS; /* Success */
 }
 
 /**
- * Parses a `.string` directive and populates the data array with ASCII values.
+ * Translates the operand of a `.string` directive and populates the data array with ASCII values.
  * 
- * @param data The data array to populate.
- * @param count Pointer to the current count of data entries.
- * @param line The line containing the `.string` directive.
+ * @param data_table The data vector to populate.
+ * @param ir The lexed `.string` line.
  * @return SUCCESS on success, 1 on failure.
  */
-int translate_string(data** data_table, size_t* count, char* line) {
+int translate_string(vector* data_table, const line_ir* ir) {
     size_t str_len;
-    int i;
-    size_t temp_count; 
-    char *token = strtok(line, "\""); /* Tokenize by " */
-    strip_whitespace(token);
-    if (!token || strcmp(token, ".string")) return 1; /* Ensure it's a `.string` directive */
+    size_t i;
+    data* entries;
+    const char* text;
 
-    token = strtok(NULL, "\""); /* Get the string inside quotes */
-    if (!token) {
+    if (ir->operand_count != 1 || strlen(ir->operands[0].text) == 0) {
         return 1;  /* if "" not provided */
     }
 
-    str_len = strlen(token);
-    temp_count = *count;
-    if (extend_array((void**)data_table, count, *count + str_len + 1, sizeof(data))) {
+    text = ir->operands[0].text;
+    str_len = strlen(text);
+    entries = (data*)vector_extend(data_table, str_len + 1);
+    if (!entries) {
         return 1;
     }
 
     for (i = 0; i < str_len; i++) {
-        (*data_table)[temp_count].value.ascii = (int)token[i]; /* Use the `data` struct's integer field */
-        temp_count++;
+        entries[i].value.ascii = (int)text[i]; /* Use the `data` struct's integer field */
     }
-    (*data_table)[temp_count].value.ascii = 0; /* null */
+    entries[str_len].value.ascii = 0; /* null */
 
     return SUCCESS; /* Success */
 }
 
-/**
- * @param str The string representation of the opcode.
- * @return The corresponding opcode enum value, or INVALID if not found.
- */
-opcode get_opcode(const char* str) {
-    int i;
-    for (i = 0; i < INVALID; i++) {
-        if (!strcmp(str, OPCODE_STRINGS[i])) {
-            return (opcode)i;
-        }
-    }
-    return INVALID;  /* Return INVALID if not found */
-}
-
-/**
- * Parses an instruction line, extracting the opcode and operands.
- * 
- * @param instr The instruction structure to populate.
- * @param line The line containing the instruction.
- */
-void parse_instruction(instruction* instr, const char* line) {
-    char buffer[MAX_BUF_SIZE];
-    char* token;
-    int i = 0;
-
-    instr->num_of_operands = 0;
-    
-    strcpy(buffer, line);  /* Copy to modify safely */
-    token = strtok(buffer, " \t");  /* First token (opcode) */
-    if (!token) {
-        instr->opcode = INVALID;
-        return;
-    }
-
-    instr->opcode = get_opcode(token);
-    if (instr->opcode == INVALID) {
-        return;
-    }
-    
-    /* Extract operands */
-    while (i < MAX_OPERANDS && (token = strtok(NULL, ","))) {
-        strip_whitespace(token);
-        strcpy(instr->operands[i], token);
-        instr->num_of_operands++;
-        i++;
-    }
-
-    if (strtok(NULL, ",") != NULL) {
-        instr->opcode = INVALID;  /* Mark as invalid */
-    }
-}
-
-/**
- * Identifies the addressing mode of an operand.
- * 
- * @param operand The operand string.
- * @return The addressing mode of the operand.
- * 
- */
-int get_addressing_mode(const char* operand) {
-    if (!operand) return -1;
-    if (operand[0] == '#') return IMMEDIATE_ADDRESS_MODE;
-    if (operand[0] == '&') return REALTIVE_ADDRESS_MODE;
-    if (operand[0] == 'r' && strlen(operand) == 2 && operand[1] >= '0' && operand[1] <= '7') return REGISTER_ADDRESS_MODE;
-    return DIRECT_ADDRESS_MODE;
-}
-
 /**
  * Checks if an addressing mode is allowed for an operand.
  * 
- * @param mode The addressing mode to check.
- * @param allowed_modes Array of allowed addressing modes.
- * @param num_modes The number of allowed modes.
+ * @param mode The addressing mode to check, -1 for an empty operand.
+ * @param allowed_modes The MODE_BIT set of allowed addressing modes.
  * @return 1 if the mode is allowed, 0 otherwise.
  */
-int is_mode_allowed(int mode, const int allowed_modes[], int num_modes) {
-    int i;
-    for (i = 0; i < num_modes; i++) {
-        if (allowed_modes[i] == mode) return 1;
-    }
-    return 0;
+int is_mode_allowed(int mode, unsigned int allowed_modes) {
+    return mode >= 0 && (allowed_modes & MODE_BIT(mode)) != 0;
 }
 
 /**
@@ -330,13 +143,11 @@ int is_mode_allowed(int mode, const int allowed_modes[], int num_modes) {
  * @return Pointer to the corresponding opcode rule, or NULL if not found.
  */
 const OpcodeRule* get_opcode_rule(opcode opcode) {
-    int i;
-    for (i = 0; i < OPCODE_TABLE_SIZE; i++) {
-        if (OPCODE_TABLE[i].opcode == opcode) {
-            return &OPCODE_TABLE[i];  /* Return pointer to found rule */
-        }
+    /* OPCODE_TABLE is in opcode order */
+    if ((int)opcode < 0 || (int)opcode >= OPCODE_TABLE_SIZE) {
+        return NULL;  /* Return NULL if not found */
     }
-    return NULL;  /* Return NULL if not found */
+    return &OPCODE_TABLE[opcode];
 }
 
 /**
@@ -345,7 +156,7 @@ const OpcodeRule* get_opcode_rule(opcode opcode) {
  * @param instr The instruction to validate.
  * @return SUCCESS if the instruction is valid, or an error code otherwise.
  */
-int validate_instruction(const instruction* instr) {
+int validate_instruction(const line_ir* instr) {
     /* Find the corresponding opcode rule */
     const OpcodeRule* rule = get_opcode_rule(instr->opcode);
     if (!rule) {
@@ -353,27 +164,27 @@ int validate_instruction(const instruction* instr) {
     }
 
     /* Check number of operands */
-    if (instr->num_of_operands != rule->num_of_operands) {
+    if (instr->operand_count != rule->num_of_operands) {
         return WRONG_AMOUNT_OF_OPERANDS;
     }
 
     /* Validate addressing modes correctly */
-    if (instr->num_of_operands == 2) {
+    if (instr->operand_count == 2) {
         /* Instruction has both source and destination operands */
-        int src_mode = get_addressing_mode(instr->operands[0]);
-        int dest_mode = get_addressing_mode(instr->operands[1]);
+        int src_mode = instr->operands[0].address_mode;
+        int dest_mode = instr->operands[1].address_mode;
 
-        if (!is_mode_allowed(src_mode, rule->valid_source_modes, rule->num_source_modes)) {
+        if (!is_mode_allowed(src_mode, rule->source_modes)) {
             return INVALID_SRC_OPERAND_ADDRESSING_MODE;
         }
-        if (!is_mode_allowed(dest_mode, rule->valid_dest_modes, rule->num_dest_modes)) {
+        if (!is_mode_allowed(dest_mode, rule->dest_modes)) {
             return INVALID_DST_OPERAND_ADDRESSING_MODE;
         }
-    } else if (instr->num_of_operands == 1) {
+    } else if (instr->operand_count == 1) {
         /* Instruction only has a destination operand */
-        int dest_mode = get_addressing_mode(instr->operands[0]);
+        int dest_mode = instr->operands[0].address_mode;
 
-        if (!is_mode_allowed(dest_mode, rule->valid_dest_modes, rule->num_dest_modes)) {
+        if (!is_mode_allowed(dest_mode, rule->dest_modes)) {
             return INVALID_DST_OPERAND_ADDRESSING_MODE;
         }
     }
@@ -382,608 +193,643 @@ int validate_instruction(const instruction* instr) {
 }
 
 /**
- * Writes the first word of machine code in hexadecimal format to a file.
- * 
- * @param file The file pointer to write to.
- * @param first_word The first word structure to write.
- */
-void write_first_word_hex_to_file(FILE* file, first_word* first_word) {
-    unsigned int value = 0;
-
-    value |= (first_word->E            & 0x1)      << 0;   
-    value |= (first_word->R            & 0x1)      << 1;   
-    value |= (first_word->A            & 0x1)      << 2;   
-    value |= (first_word->funct        & 0x1F)     << 3;   
-    value |= (first_word->dest_reg     & 0x7)      << 8;   
-    value |= (first_word->dest_address & 0x3)      << 11;  
-    value |= (first_word->src_reg      & 0x7)      << 13;  
-    value |= (first_word->src_address  & 0x3)      << 16;  
-    value |= (first_word->opcode_value & 0x3F)     << 18;  
-
-    fprintf(file, "%06X\n", value & 0xFFFFFF);
-}
-
-/**
- * Writes an operand of machine code in hexadecimal format to a file.
+ * Encodes the first word of an instruction: the template of its opcode with the addressing modes
+ * and registers of its operands.
  * 
- * @param file The file pointer to write to.
- * @param operand The operand structure to write.
+ * @param instr The instruction.
+ * @return The value of the word.
  */
-void write_operand_hex_to_file(FILE* file, operand* operand) {
-    unsigned int value = 0;
+machine_word encode_first_word(const line_ir* instr) {
+    machine_word word = OPCODE_TABLE[instr->opcode].first_word;
+    const operand_span* source;
+    const operand_span* dest;
 
-    value |= (operand->E        & 0x1)       << 0;   
-    value |= (operand->R        & 0x1)       << 1;   
-    value |= (operand->A        & 0x1)       << 2;   
-    value |= (operand->integer  & 0x1FFFFF)  << 3;   
-
-    fprintf(file, "%06X\n", value & 0xFFFFFF);
-}
-
-/**
- * Generates the first word of machine code for an instruction.
- * 
- * @param instr The instruction to generate the first word for.
- * @return The generated first word structure.
- */
-first_word generate_first_word(const instruction* instr) {
-    const OpcodeRule* opcode_rule = get_opcode_rule(instr->opcode);
-    first_word first_word_val;
-
-    first_word_val.A = 1;
-    first_word_val.R = 0;
-    first_word_val.E = 0;
-    first_word_val.opcode_value = opcode_rule->opcode_value;
-    first_word_val.funct = opcode_rule->funct;
-    if (instr->num_of_operands == 2) {
-        first_word_val.src_address = get_addressing_mode(instr->operands[0]);
-        if (first_word_val.src_address == REGISTER_ADDRESS_MODE) {
-            first_word_val.src_reg = instr->operands[0][1] - '0';
-        } else {
-            first_word_val.src_reg = 0;
-        }
-        first_word_val.dest_address = get_addressing_mode(instr->operands[1]);
-        if (first_word_val.dest_address == REGISTER_ADDRESS_MODE) {
-            first_word_val.dest_reg = instr->operands[1][1] - '0';
-        } else {
-            first_word_val.dest_reg = 0;
-        }
-    } else if (instr->num_of_operands == 1) {
-        first_word_val.src_address = 0;
-        first_word_val.src_reg = 0;
-        first_word_val.dest_address = get_addressing_mode(instr->operands[0]);
-        if (first_word_val.dest_address == REGISTER_ADDRESS_MODE) {
-            first_word_val.dest_reg = instr->operands[0][1] - '0';
-        } else {
-            first_word_val.dest_reg = 0;
-        }
-    } else {
-        first_word_val.src_address = 0;
-        first_word_val.src_reg = 0;
-        first_word_val.dest_address = 0;
-        first_word_val.dest_reg = 0;
+    if (instr->operand_count == 0) {
+        return word;
     }
 
-    return first_word_val;
-}
-
-/**
- * Calculates the number of words required for an instruction, including operands.
- * 
- * @param instr The instruction to calculate the number of words for.
- * @return The number of words required for the instruction.
- */
-int calculate_number_of_words(const instruction* instr) {
-    if (instr->num_of_operands == 2) {
-        /* Instruction has both source and destination operands */
-        int src_mode = get_addressing_mode(instr->operands[0]);
-        int dest_mode = get_addressing_mode(instr->operands[1]);
+    dest = &instr->operands[instr->operand_count - 1];
+    word |= (machine_word)dest->address_mode << DEST_MODE_SHIFT;
+    if (dest->address_mode == REGISTER_ADDRESS_MODE) {
+        word |= (machine_word)(dest->text[1] - '0') << DEST_REG_SHIFT;
+    }
 
-        return 1 + (src_mode != REGISTER_ADDRESS_MODE) + (dest_mode != REGISTER_ADDRESS_MODE);
-    } else if (instr->num_of_operands == 1) {
-        /* Instruction only has a destination operand */
-        int dest_mode = get_addressing_mode(instr->operands[0]);
-        return 1 + (dest_mode != REGISTER_ADDRESS_MODE);
+    if (instr->operand_count == 2) {
+        source = &instr->operands[0];
+        word |= (machine_word)source->address_mode << SRC_MODE_SHIFT;
+        if (source->address_mode == REGISTER_ADDRESS_MODE) {
+            word |= (machine_word)(source->text[1] - '0') << SRC_REG_SHIFT;
+        }
     }
-    return 1;
+    return word;
 }
 
 /**
- * Generates the machine code for an operand.
+ * Encodes an operand word.
  * 
- * @param operand_val The operand string to generate code for.
- * @return The generated operand structure.
+ * @param value The value of the operand (truncated to its 21 bits).
+ * @param are The A,R,E field of the word.
+ * @return The value of the word.
  */
-operand generate_operand_code(char* operand_val) {
-    operand operand = {0};
-    operand.A = 1;
-    operand.R = 0;
-    operand.E = 0;
-    operand.integer = atoi(operand_val+1); /* skip the # */
-    return operand;
+machine_word encode_operand(long value, machine_word are) {
+    return (((machine_word)value & OPERAND_MASK) << OPERAND_SHIFT) | are;
 }
 
 /**
- * Builds the machine code for an instruction, resolving immediate operands.
+ * Encodes an instruction at the end of the code image. Immediate operands are encoded in place,
+ * operands referring to labels are left zero for the second cycle.
  * 
- * @param instr The instruction to build.
- * @param machine_code The machine code structure to populate.
- * @return The number of operands resolved.
+ * @param instr The instruction to encode.
+ * @param words The code image.
+ * @return The first word of the instruction, or NULL on memory allocation failure.
  */
-int build_instruction(instruction* instr, machine_code* machine_code) {
+machine_word* encode_instruction(const line_ir* instr, vector* words) {
+    machine_word* word;
+    int count = 1;
     int i;
-    int amount_opernads_resolved = 0;
-    int operand_code_index = 0;
-    int address_mode;
 
-    machine_code->first_word_val = generate_first_word(instr);
-    for (i = 0; i < instr->num_of_operands; i++) {
-        address_mode = get_addressing_mode(instr->operands[i]);
-        if (address_mode == IMMEDIATE_ADDRESS_MODE) {
-            amount_opernads_resolved++;
-            machine_code->operand_code[operand_code_index] = generate_operand_code(instr->operands[i]);
-        }
-        if (address_mode != REGISTER_ADDRESS_MODE) {
-            operand_code_index++;  /* no additional word for reg address */
+    for (i = 0; i < instr->operand_count; i++) {
+        count += instr->operands[i].address_mode != REGISTER_ADDRESS_MODE;  /* no additional word for reg address */
+    }
+    word = (machine_word*)vector_extend(words, count);
+    if (!word) {
+        return NULL;
+    }
+
+    word[0] = encode_first_word(instr);
+    count = 1;
+    for (i = 0; i < instr->operand_count; i++) {
+        if (instr->operands[i].address_mode == IMMEDIATE_ADDRESS_MODE) {
+            word[count++] = encode_operand(atoi(instr->operands[i].text + 1), ARE_ABSOLUTE);  /* skip the # */
+        } else if (instr->operands[i].address_mode != REGISTER_ADDRESS_MODE) {
+            word[count++] = 0;
         }
     }
-    return amount_opernads_resolved;
+    return word;
 }
 
 /**
- * Saves the object file (.obj) containing the machine code.
+ * Writes an output buffer to the file with the given extension, reporting a failure.
  * 
  * @param filename The name of the assembly file.
- * @param code The machine code array.
- * @param code_count The number of machine code entries.
- * @param data The data array.
- * @param data_count The number of data entries.
- * @param ICF The final instruction counter value.
- * @param DCF The final data counter value.
+ * @param extension The extension of the output file.
+ * @param output The content of the file.
+ * @param diag The diagnostics of the file.
+ * @return SUCCESS on success, 1 if the file could not be written.
  */
-void save_obj_file(const char* filename, machine_code* code, size_t code_count, data* data, size_t data_count, size_t ICF, size_t DCF) {
-    char obj_filename[FILENAME_MAX];
-    FILE* file = NULL;
-    int line_number = CODE_BASE_ADDRESS;
-    int i, j;
+int write_output_file(const char* filename, const char* extension, output_buffer* output, diagnostics* diag) {
+    char output_filename[FILENAME_MAX];
+    int result;
 
-    copy_filename_with_different_extension(filename, obj_filename, ".obj");
-    file = fopen(obj_filename, "w");
-
-    fprintf(file, "%7ld %ld\n", ICF-CODE_BASE_ADDRESS, DCF);
-    for (i = 0; i < code_count; i++)
-    {
-        fprintf(file, "%07d ", line_number++);
-        write_first_word_hex_to_file(file, &code[i].first_word_val);
-
-        for (j = 0; j < code[i].L-1; j++)
-        {
-            fprintf(file, "%07d ", line_number++);
-            write_operand_hex_to_file(file, &code[i].operand_code[j]);
-        }
+    copy_filename_with_different_extension(filename, output_filename, extension);
+    result = output_buffer_write_file(output, output_filename);
+    if (result) {
+        report(diag, "Could not create output file: %s\n", output_filename);
     }
-    for (i = 0; i < data_count; i++)
-    {
-        fprintf(file, "%07d %06X\n", line_number++, data[i].value.integer);
-    }
-
-    fclose(file);
+    output_buffer_free(output);
+    return result;
 }
 
 /**
- * Saves the entries file (.ent) listing entry labels and their addresses.
+ * Records a fixup for every operand of an instruction that refers to a label.
  * 
- * @param filename The name of the assembly file.
- * @param label_table The symbol table.
- * @param label_count The number of labels in the table.
+ * @param instr The instruction.
+ * @param word_index The index of the first word of the instruction in the code image.
+ * @param line_number The source line of the instruction.
+ * @param symbols The symbol table, receiving the referenced labels.
+ * @param fixups The fixups vector to append to.
+ * @return SUCCESS on success, MEMORY_ALLOCATION_FAILED on failure.
  */
-void save_entries_file(const char* filename, label_element* label_table, size_t label_count) {
-    char ent_filename[FILENAME_MAX];
-    FILE* file = NULL;
+int record_operand_fixups(const line_ir* instr, size_t word_index, int line_number, symbol_table* symbols, vector* fixups) {
     int i;
+    int operand_code_index = 0;
+    int address_mode;
+    const char* label_name;
+    fixup* operand_fixup_entry;
+
+    for (i = 0; i < instr->operand_count; i++) {
+        address_mode = instr->operands[i].address_mode;
+        if (address_mode == REGISTER_ADDRESS_MODE) {
+            continue;  /* no additional word for reg address */
+        }
+        if (address_mode != IMMEDIATE_ADDRESS_MODE) {
+            label_name = instr->operands[i].text;
+            if (address_mode == REALTIVE_ADDRESS_MODE) {
+                /* contain & as prefix */
+                label_name++;
+            }
 
-    copy_filename_with_different_extension(filename, ent_filename, ".ent");
-    file = fopen(ent_filename, "w");
-
-    for (i = 0; i < label_count; i++) {
-        if (label_table[i].label_type & entry_label) {
-            fprintf(file, "%s %07d\n", label_table[i].label_name, label_table[i].address);
+            operand_fixup_entry = (fixup*)vector_push(fixups);
+            if (!operand_fixup_entry) {
+                return MEMORY_ALLOCATION_FAILED;
+            }
+            operand_fixup_entry->type = operand_fixup;
+            operand_fixup_entry->word_index = word_index + 1 + operand_code_index;
+            operand_fixup_entry->operand_index = operand_code_index;
+            operand_fixup_entry->address_mode = address_mode;
+            operand_fixup_entry->line_number = line_number;
+            if (symbol_table_reference(symbols, label_name, &operand_fixup_entry->symbol_id)) {
+                return MEMORY_ALLOCATION_FAILED;
+            }
         }
+        operand_code_index++;
     }
 
-    fclose(file);
+    return SUCCESS;
 }
 
 /**
- * Saves the externals file (.ext) listing external labels and their usage addresses.
+ * Records the fixup for a `.entry` directive; entries are resolved (and reported) in the second cycle.
  * 
- * @param filename The name of the assembly file.
- * @param externals The externals array.
- * @param externals_count The number of externals.
+ * @param ir The lexed `.entry` line.
+ * @param symbols The symbol table, receiving the referenced label.
+ * @param fixups The fixups vector to append to.
+ * @return SUCCESS on success, MEMORY_ALLOCATION_FAILED on failure.
  */
-void save_externals_file(const char* filename, external_info* externals, size_t externals_count) {
-    char ext_filename[FILENAME_MAX];
-    FILE* file = NULL;
-    int i;
+int record_entry_fixup(const line_ir* ir, symbol_table* symbols, vector* fixups) {
+    fixup* entry = (fixup*)vector_push(fixups);
+    const char* name;
 
-    copy_filename_with_different_extension(filename, ext_filename, ".ext");
-    file = fopen(ext_filename, "w");
+    if (!entry) {
+        return MEMORY_ALLOCATION_FAILED;
+    }
+    entry->line_number = ir->line_number;
+    entry->word_index = 0;
+    entry->operand_index = 0;
+    entry->address_mode = 0;
+    entry->symbol_id = 0;
 
-    for (i = 0; i < externals_count; i++) {
-        fprintf(file, "%s %07d\n", externals[i].label_name, externals[i].address);
+    /* The only operand is the name */
+    if (ir->operand_count != 1 || strlen(ir->operands[0].text) == 0) {
+        entry->type = invalid_entry_line;
+        return SUCCESS;
     }
 
-    fclose(file);
+    name = ir->operands[0].text;
+    entry->type = is_reserved_word(name) ? invalid_entry_label : entry_fixup;
+    return symbol_table_reference(symbols, name, &entry->symbol_id);
 }
 
-/**
- * Performs the second cycle of the assembly process
- * 
- * @param file The file pointer to the assembly file.
- * @param label_table The symbol table.
- * @param label_count The number of labels in the table.
- * @param code The machine code array.
- * @param code_count The number of machine code entries.
- * @param externals The externals array to populate.
- * @param externals_count Pointer to the count of externals.
- * @return 0 on success, 1 if errors were encountered.
- */
-int second_cycle(FILE* file, label_element* label_table, size_t label_count, machine_code* code, size_t code_count, external_info** externals, size_t* externals_count) {
-    char line[MAX_BUF_SIZE];  /* Line Max Size = 80 */
-    char label[MAX_LABEL_LENGTH + 1] = {0};
-    int code_line_number = 0;
-    int line_number = 0;
+int resolve_fixups(assembly_unit* unit, size_t first, size_t end, int mark_entries, vector* externals,
+                   diagnostics* diag) {
+    symbol_table* symbols = &unit->symbols;
+    machine_word* words = VECTOR_ITEMS(unit->code, machine_word);
+    const vector* fixups = &unit->fixups;
     int is_code_with_errors = 0;
-    int i, j;
-    char* label_copy;
-    char* mod_line;
+    size_t i;
 
-    rewind(file);
-    while (fgets(line, sizeof(line), file) != NULL) {
-        line_number++;
-        strip_whitespace(line);
+    for (i = first; i < end; i++) {
+        const fixup* current = &VECTOR_ITEMS(*fixups, fixup)[i];
+        label_element* label = symbol_table_get(symbols, current->symbol_id);
+        size_t address;
+        external_info* external;
 
-        if (line[0] == ';' || strlen(line) == 0) {
-            /* comment - skip */
+        diag->line_number = current->line_number;
+        if (current->type == invalid_entry_line) {
+            report(diag, "Error: Invalid entry line. Line number (%d)\n", current->line_number);
+            is_code_with_errors = 1;
             continue;
         }
-
-        mod_line = line;
-        if (strchr(line, ':')) {
-            get_label(line, label);  /* cant be wrong label - because we check in first cycle */
-            mod_line += strlen(label) + 1;
-        }
-
-        strip_whitespace(mod_line);
-        
-        if (is_data_instruction(mod_line) || is_string_instruction(mod_line) || is_extern_instruction(mod_line)) {
+        if (current->type == invalid_entry_label) {
+            report(diag, "Error: Invalid entry label (%s) encountered.\n", label->label_name);
+            is_code_with_errors = 1;
             continue;
         }
-        if (is_entry_instruction(mod_line)) {
-            char* token = strtok(mod_line, " \t"); /* Tokenize by space or tab */
-            int found = 0;
-            if (!token || strcmp(token, ".entry")) {
-                printf("Error: Invalid entry line. Line number (%d)\n", line_number);
-                is_code_with_errors = 1;
+        if (current->type == entry_fixup) {
+            if (label->label_type != undefined_label) {
+                if (mark_entries) {
+                    label->label_type |= entry_label;
+                }
                 continue;
             }
-            token = strtok(NULL, " \t"); /* Get the next token, which is the name */
-            if (is_reserved_word(token)) {
-                printf("Error: Invalid entry label (%s) encountered.\n", token);
+            report(diag, "Error: Entry Label (%s) doesn't exists.\n", label->label_name);
+            is_code_with_errors = 1;
+            continue;
+        }
+
+        /* operand_fixup */
+        if (label->label_type == undefined_label) {
+            report(diag, "Error: Label (%s) doesn't exists.\n", label->label_name);
+            is_code_with_errors = 1;
+            continue;
+        }
+
+        address = CODE_BASE_ADDRESS + current->word_index;
+        if (label->label_type == extern_label) {
+            if (current->address_mode == REALTIVE_ADDRESS_MODE) {
+                report(diag, "Error: Invalid jump to external address (%s).\n", label->label_name);
                 is_code_with_errors = 1;
                 continue;
             }
 
-            for (i = 0; i < label_count; i++)
-            {
-                if (!strcmp(token, label_table[i].label_name)) {
-                    label_table[i].label_type |= entry_label;
-                    found = 1;
-                }
-            }
-            if (found) {
+            external = (external_info*)vector_push(externals);
+            if (!external) {
+                report(diag, "Error: Memory allocation failed.\n");
+                is_code_with_errors = 1;
                 continue;
             }
-            
-            printf("Error: Entry Label (%s) doesn't exists.\n", token);
-            is_code_with_errors = 1;
-            continue;
+            external->address = address;
+            external->symbol_id = current->symbol_id;
+            words[current->word_index] = ARE_EXTERNAL;
+        } else if (current->address_mode == REALTIVE_ADDRESS_MODE) {
+            /* relative to the first word of the instruction */
+            words[current->word_index] = encode_operand(label->address - (long)(address - 1 - current->operand_index),
+                                                        ARE_ABSOLUTE);
+        } else {
+            /* address mode == DIRECT_ADDRESS_MODE */
+            words[current->word_index] = encode_operand(label->address, ARE_RELOCATABLE);
         }
+    }
+    diag->line_number = 0;
 
-        if (code[code_line_number].need_to_resolve) {
-            instruction instr;
-            size_t temp_count;
-            int address_mode;
-            int operand_code_index = 0;
-            int label_type;
-            int label_address;
-            char* label_name;
-
-            parse_instruction(&instr, mod_line);
-            for (i = 0; i < instr.num_of_operands; i++) {
-                address_mode = get_addressing_mode(instr.operands[i]);
-                if (address_mode == IMMEDIATE_ADDRESS_MODE) {
-                    operand_code_index++;  /* already built */
-                    continue;
-                }
-                if (address_mode == REGISTER_ADDRESS_MODE) {
-                    continue;  /* no additional word for reg address */
-                }
-
-                label_name = instr.operands[i];
-                if (address_mode == REALTIVE_ADDRESS_MODE) {
-                    /* contain & as prefix */
-                    label_name++;
-                }
-                if (!is_label_exist(label_name, label_table, label_count)) {
-                    printf("Error: Label (%s) doesn't exists.\n", label_name);
-                    is_code_with_errors = 1;
-                    continue;
-                }
+    return is_code_with_errors;
+}
 
-                for (j = 0; j < label_count; j++)
-                {
-                    if (!strcmp(label_name, label_table[j].label_name)) {
-                        label_address = label_table[j].address;
-                        label_type = label_table[j].label_type;
-                        break;
-                    }
-                }
+void mark_entry_labels(assembly_unit* unit) {
+    const fixup* fixups = VECTOR_ITEMS(unit->fixups, fixup);
+    label_element* label;
+    size_t i;
 
-                if (label_type == extern_label) {
-                    if (address_mode == REALTIVE_ADDRESS_MODE) {
-                        printf("Error: Invalid jump to external address (%s).\n", label_name);
-                        is_code_with_errors = 1;
-                        continue;
-                    }
-
-                    temp_count = *externals_count;
-                    if (extend_array((void**)externals, externals_count, *externals_count + 1, sizeof(external_info))) {
-                        printf("Error: Memory allocation failed.\n");
-                        is_code_with_errors = 1;
-                        continue;
-                    }
-                    (*externals)[temp_count].address = code[code_line_number].IC + 1 + operand_code_index;
-
-                    label_copy = (char*)malloc(strlen((label_name)) + 1);
-                    if (!label_copy) {
-                        printf("Error: Memory allocation failed.\n");
-                        is_code_with_errors = 1;
-                        continue;
-                    }
-                    strcpy(label_copy, label_name);
-                    (*externals)[temp_count].label_name = label_copy;
-
-                    code[code_line_number].operand_code[operand_code_index].A = 0;
-                    code[code_line_number].operand_code[operand_code_index].R = 0;
-                    code[code_line_number].operand_code[operand_code_index].E = 1;
-                    code[code_line_number].operand_code[operand_code_index].integer = 0;
-                } else {
-                    code[code_line_number].operand_code[operand_code_index].E = 0;
-                    if (address_mode == REALTIVE_ADDRESS_MODE) {
-                        code[code_line_number].operand_code[operand_code_index].A = 1;                        
-                        code[code_line_number].operand_code[operand_code_index].R = 0;
-                        code[code_line_number].operand_code[operand_code_index].integer = label_address - code[code_line_number].IC;
-                    } else {
-                        /* address mode == DIRECT_ADDRESS_MODE */
-                        code[code_line_number].operand_code[operand_code_index].A = 0;
-                        code[code_line_number].operand_code[operand_code_index].R = 1;
-                        code[code_line_number].operand_code[operand_code_index].integer = label_address;
-                    }
-                }
-                operand_code_index++;
+    for (i = 0; i < unit->fixups.count; i++) {
+        if (fixups[i].type == entry_fixup) {
+            label = symbol_table_get(&unit->symbols, fixups[i].symbol_id);
+            if (label->label_type != undefined_label) {
+                label->label_type |= entry_label;
             }
-            
         }
-        code_line_number++;
     }
+}
 
-    return is_code_with_errors;
+/**
+ * Performs the second cycle of the assembly process: applies the fixups recorded by the first cycle,
+ * marking entry labels and resolving operands that refer to labels. No source text is processed.
+ * 
+ * @param unit The tables built by the first cycle; the externals table is populated.
+ * @param diag The diagnostics of the file.
+ * @return 0 on success, 1 if errors were encountered.
+ */
+int second_cycle(assembly_unit* unit, diagnostics* diag) {
+    return resolve_fixups(unit, 0, unit->fixups.count, 1, &unit->externals, diag);
+}
+
+int assembly_reserve(assembly_unit* unit, size_t line_count) {
+    if (symbol_table_reserve(&unit->symbols, line_count) || vector_reserve(&unit->code, 2 * line_count) ||
+        vector_reserve(&unit->data, line_count)) {
+        return MEMORY_ALLOCATION_FAILED;
+    }
+    return SUCCESS;
 }
 
 /**
- * Performs the first cycle of the assembly process
+ * Records the label of a `.entry` or `.extern` line, which is checked for duplicates but not defined.
  * 
- * @param filename The name of the assembly file to process.
+ * @param label The label of the line.
+ * @param unit The tables being built.
+ * @return SUCCESS on success, MEMORY_ALLOCATION_FAILED on failure.
  */
-void first_cycle(char* filename) {
-    char line[MAX_BUF_SIZE];
-    char label[MAX_LABEL_LENGTH + 1] = {0};
+int record_label_check(const char* label, assembly_unit* unit) {
+    size_t* check = (size_t*)vector_push(&unit->label_checks);
+
+    if (!check) {
+        return MEMORY_ALLOCATION_FAILED;
+    }
+    return symbol_table_reference(&unit->symbols, label, check);
+}
+
+int first_cycle_lines(assembly_unit* unit, const char* text, size_t size, int first_line, diagnostics* diag) {
+    line_reader reader;
+    line_view line;
+    const char* label;
+    const char* name;
     int last_error;
     int is_code_with_errors = 0;
-    int i;
-    int amount_opernads_resolved;
-    int L;
-    int line_number = 0;
-    int is_line_with_label = 0;
-    char* mod_line;
-    char* token;
-    size_t IC = CODE_BASE_ADDRESS, DC = 0, ICF, DCF;
-    instruction ins;
-    
-    machine_code code[MAX_INSTRUCTIONS];
-    data* data = NULL;
-    external_info* externals = NULL;
-    label_element* label_table = NULL;
-    size_t label_count = 0, data_count = 0, code_count = 0, externals_count = 0;
+    int line_number;
+    size_t IC = CODE_BASE_ADDRESS + unit->code.count, DC = unit->data.count;
+    line_ir ir;
     size_t data_count_temp;
 
-    FILE *file;
-
-    file = fopen(filename, "r");
-    if (!file) {
-        printf("Error: The specified file (%s) does not exist.\n", filename);
-        return;
-    }
-    
-    while (fgets(line, sizeof(line), file) != NULL) {
-        line_number++;
-        if (strlen(line) > LINE_MAX_SIZE) {
-            printf("Error: Line number: (%d) too long.\n", line_number);
+    line_reader_init(&reader, text, size);
+    reader.line_number = first_line - 1;
+    while (line_reader_next(&reader, &line)) {
+        line_number = line.line_number;
+        diag->line_number = line_number;
+        if (line.length > LINE_MAX_SIZE) {
+            report(diag, "Error: Line number: (%d) too long, the limit is %d characters.\n", line_number, LINE_MAX_SIZE);
             is_code_with_errors = 1;
             continue;
         }
-        strip_whitespace(line);
 
-        if (line[0] == ';' || strlen(line) == 0) {
-            /* comment - skip */
-            continue;
+        switch (lex_line(line.text, line.length, line_number, &ir)) {
+            case LINE_EMPTY:
+                /* empty or comment - skip */
+                continue;
+            case LINE_MULTIPLE_COMMAS:
+                report(diag, "Error: Multiple commas in line (%d).\n", line_number);
+                is_code_with_errors = 1;
+                continue;
+            case LINE_TRAILING_COMMA:
+                report(diag, "Error: comma at the end of line (%d).\n", line_number);
+                is_code_with_errors = 1;
+                continue;
+            default:
+                break;
         }
 
-        if (is_consecutive(line, ',')) {
-            printf("Error: Multiple commas in line (%d).\n", line_number);
+        label = ir.label;
+        if (label && !is_valid_label(label)) {  /* can be wrong label so raise error */
+            report(diag, "Error: Invalid label (%s) encountered.\n", label);
             is_code_with_errors = 1;
             continue;
         }
 
-        /* check trailing commas */
-        if (strlen(line) > 0 && line[strlen(line) - 1] == ',') {
-            printf("Error: comma at the end of line (%d).\n", line_number);
+        if (label && symbol_table_lookup(&unit->symbols, label)) {
+            report(diag, "Error: Label (%s) already exists.\n", label);
             is_code_with_errors = 1;
             continue;
         }
 
-        if (strchr(line, ':')) {
-            is_line_with_label = 1;
-            get_label(line, label);  /* can be wrong label so raise error */
-            if (!is_valid_label(label)) {
-                printf("Error: Invalid label (%s) encountered.\n", label);
-                is_code_with_errors = 1;
-                continue;
-            }
-        } else {
-            is_line_with_label = 0;
-        }
-
-        mod_line = line;
-        if (is_line_with_label) {
-            mod_line += strlen(label) + 1;  /* now line is a command without label (+1 for :)*/
-        }
-        strip_whitespace(mod_line);
-
-        if (is_line_with_label && is_label_exist(label, label_table, label_count)) {
-            printf("Error: Label (%s) already exists.\n", label);
+        if (label && (ir.directive == ENTRY_DIRECTIVE || ir.directive == EXTERN_DIRECTIVE) &&
+            record_label_check(label, unit)) {
+            report(diag, "Error: Memory allocation failed.\n");
             is_code_with_errors = 1;
             continue;
         }
 
-        if (is_data_instruction(mod_line) || is_string_instruction(mod_line)) {
-            if (is_line_with_label) {
-                last_error = add_label_to_symbol_table(&label_table, &label_count, label, DC, data_label);
+        if (ir.directive == DATA_DIRECTIVE || ir.directive == STRING_DIRECTIVE) {
+            if (label) {
+                last_error = symbol_table_insert(&unit->symbols, label, DC, data_label);
                 if (last_error) {
-                    printf("Error: Couldn't add label (%s) to table.\n", label);
+                    report(diag, "Error: Couldn't add label (%s) to table.\n", label);
                     is_code_with_errors = 1;
                     continue;
                 }
             }
-            data_count_temp = data_count;
-            if (is_data_instruction(mod_line)) {
-                last_error = translate_data(&data, &data_count, mod_line);
+            data_count_temp = unit->data.count;
+            if (ir.directive == DATA_DIRECTIVE) {
+                last_error = translate_data(&unit->data, &ir);
             } else {
-                last_error = translate_string(&data, &data_count, mod_line);
+                last_error = translate_string(&unit->data, &ir);
             }
             if (last_error) {
-                printf("Error: Couldn't translate data/string. Line number (%d)\n", line_number);
+                report(diag, "Error: Couldn't translate data/string. Line number (%d)\n", line_number);
                 is_code_with_errors = 1;
                 continue;
             }
-            DC += (data_count - data_count_temp);
+            DC += (unit->data.count - data_count_temp);
         }
 
-        else if (is_entry_instruction(mod_line)) {
+        else if (ir.directive == ENTRY_DIRECTIVE) {
+            if (record_entry_fixup(&ir, &unit->symbols, &unit->fixups)) {
+                report(diag, "Error: Memory allocation failed.\n");
+                is_code_with_errors = 1;
+            }
             continue;
         } 
-        else if (is_extern_instruction(mod_line)) {
-            token = strtok(mod_line, " \t"); /* Tokenize by space or tab */
-            if (!token || strcmp(token, ".extern")) {
-                printf("Error: Invalid extern line. Line number (%d)\n", line_number);
+        else if (ir.directive == EXTERN_DIRECTIVE) {
+            /* The only operand is the name */
+            if (ir.operand_count != 1 || strlen(ir.operands[0].text) == 0) {
+                report(diag, "Error: Invalid extern line. Line number (%d)\n", line_number);
                 is_code_with_errors = 1;
                 continue;
             }
-            token = strtok(NULL, " \t"); /* Get the next token, which is the name */
-            if (is_reserved_word(token)) {
-                printf("Error: Invalid extern label (%s) encountered.\n", token);
+            name = ir.operands[0].text;
+            if (is_reserved_word(name)) {
+                report(diag, "Error: Invalid extern label (%s) encountered.\n", name);
                 is_code_with_errors = 1;
                 continue;
             }
 
-            last_error = add_label_to_symbol_table(&label_table, &label_count, token, IC, extern_label);
+            last_error = symbol_table_insert(&unit->symbols, name, IC, extern_label);
             if (last_error) {
-                printf("Error: Couldn't add label (%s) to symbol table.\n", token);
+                report(diag, "Error: Couldn't add label (%s) to symbol table.\n", name);
                 is_code_with_errors = 1;
                 continue;
             }
         }
         else {
             /* this is an instruction! */
-            if (is_line_with_label) {
-                last_error = add_label_to_symbol_table(&label_table, &label_count, label, IC, code_label);
+            if (label) {
+                last_error = symbol_table_insert(&unit->symbols, label, IC, code_label);
                 if (last_error) {
-                    printf("Error: Couldn't add label (%s) to symbol table.\n", label);
+                    report(diag, "Error: Couldn't add label (%s) to symbol table.\n", label);
                     is_code_with_errors = 1;
                     continue;
                 }
             }
-            parse_instruction(&ins, mod_line);
-            last_error = validate_instruction(&ins);
+            last_error = validate_instruction(&ir);
             if (last_error) {
-                printf("Error: Couldn't validate instruction (%s) linu number (%d).\n", line, line_number);
+                report(diag, "Error: Couldn't validate instruction (%s) linu number (%d).\n", ir.source, line_number);
                 is_code_with_errors = 1;
                 continue;
             }
 
-            L = calculate_number_of_words(&ins);
-            if (L == 1) {
-                code[code_count].operand_code = NULL;    
-            } else {
-                code[code_count].operand_code = (operand*)malloc(sizeof(operand) * (L-1));
+            if (!encode_instruction(&ir, &unit->code) ||
+                record_operand_fixups(&ir, IC - CODE_BASE_ADDRESS, line_number, &unit->symbols, &unit->fixups)) {
+                report(diag, "Error: Memory allocation failed.\n");
+                is_code_with_errors = 1;
+                continue;
             }
-            code[code_count].IC = IC;
-            code[code_count].L = L;
-            amount_opernads_resolved = build_instruction(&ins, &code[code_count]);  /* build all the immediate vals */
-            code[code_count].need_to_resolve = amount_opernads_resolved != (L - 1);
-            IC += L;
-            code_count++;
+            IC = CODE_BASE_ADDRESS + unit->code.count;
         }
     }
 
-    if (!is_code_with_errors) {
-        ICF = IC;
-        DCF = DC;
-        for (i = 0; i < label_count; i++)
-        {
-            if (label_table[i].label_type == data_label) {
-                label_table[i].address += ICF;
-            }
+    diag->line_number = 0;
+    return is_code_with_errors;
+}
+
+void close_first_cycle(assembly_unit* unit) {
+    size_t i;
+
+    /* The data section follows the code section */
+    unit->ICF = CODE_BASE_ADDRESS + unit->code.count;
+    unit->DCF = unit->data.count;
+    for (i = 0; i < symbol_table_count(&unit->symbols); i++)
+    {
+        label_element* label = symbol_table_at(&unit->symbols, i);
+        if (label->label_type == data_label) {
+            label->address += unit->ICF;
         }
-        
-        last_error = second_cycle(file, label_table, label_count, code, code_count, &externals, &externals_count);
-        if (!last_error) {
-            save_obj_file(filename, code, code_count, data, data_count, ICF, DCF);
-            save_entries_file(filename, label_table, label_count);
-            save_externals_file(filename, externals, externals_count);
+    }
+}
+
+/**
+ * Performs the first cycle of the assembly process: lexes every line, builds the symbol table,
+ * translates the data and code sections and records the fixups left for the second cycle.
+ * 
+ * @param unit The tables to build.
+ * @param source The expanded source (content of the .am file).
+ * @param diag The diagnostics of the file.
+ * @return 0 on success, 1 if errors were encountered.
+ */
+int first_cycle(assembly_unit* unit, const line_buffer* source, diagnostics* diag) {
+    /* Size the tables from the number of lines, so a typical file needs (almost) no reallocations */
+    if (assembly_reserve(unit, line_buffer_count(source))) {
+        report(diag, "Error: Memory allocation failed.\n");
+        return 1;
+    }
+    if (first_cycle_lines(unit, VECTOR_ITEMS(source->text, char), source->text.count, 1, diag)) {
+        return 1;
+    }
+    close_first_cycle(unit);
+    return 0;
+}
+
+void assembly_init(assembly_unit* unit) {
+    symbol_table_init(&unit->symbols);
+    vector_init(&unit->code, sizeof(machine_word));
+    vector_init(&unit->data, sizeof(data));
+    vector_init(&unit->externals, sizeof(external_info));
+    vector_init(&unit->fixups, sizeof(fixup));
+    vector_init(&unit->label_checks, sizeof(size_t));
+    unit->ICF = CODE_BASE_ADDRESS;
+    unit->DCF = 0;
+    unit->counters = NULL;
+}
+
+void assembly_track(assembly_unit* unit, alloc_counters* counters) {
+    unit->counters = counters;
+    symbol_table_track(&unit->symbols, subsystem_counters(counters, SYMBOL_ALLOCS));
+    vector_track(&unit->label_checks, subsystem_counters(counters, SYMBOL_ALLOCS));
+    vector_track(&unit->code, subsystem_counters(counters, CODE_ALLOCS));
+    vector_track(&unit->fixups, subsystem_counters(counters, CODE_ALLOCS));
+    vector_track(&unit->data, subsystem_counters(counters, DATA_ALLOCS));
+    vector_track(&unit->externals, subsystem_counters(counters, EXTERNAL_ALLOCS));
+}
+
+void assembly_free(assembly_unit* unit) {
+    symbol_table_free(&unit->symbols);
+    vector_free(&unit->code);
+    vector_free(&unit->data);
+    vector_free(&unit->externals);
+    vector_free(&unit->fixups);
+    vector_free(&unit->label_checks);
+}
+
+int assembly_image(const assembly_unit* unit, object_file* image) {
+    const machine_word* code = VECTOR_ITEMS(unit->code, machine_word);
+    const data* data_words = VECTOR_ITEMS(unit->data, data);
+    const external_info* externals = VECTOR_ITEMS(unit->externals, external_info);
+    unsigned long word_index = 0;
+    unsigned long entry_index = 0;
+    unsigned long relocation_index = 0;
+    size_t strings_size = 0;
+    char* name;
+    int i;
+
+    memset(image, 0, sizeof(*image));
+    image->counters = subsystem_counters(unit->counters, OUTPUT_ALLOCS);
+    image->base_address = CODE_BASE_ADDRESS;
+    image->ICF = unit->ICF;
+    image->DCF = unit->DCF;
+    image->word_count = unit->ICF - CODE_BASE_ADDRESS + unit->DCF;
+    image->extern_count = unit->externals.count;
+
+    /* Count the labels and relocations first, so every array is allocated once */
+    for (i = 0; i < symbol_table_count(&unit->symbols); i++) {
+        const label_element* label = symbol_table_at(&unit->symbols, i);
+        if (label->label_type & entry_label) {
+            image->entry_count++;
+            strings_size += strlen(label->label_name) + 1;
         }
     }
+    for (i = 0; i < unit->externals.count; i++) {
+        strings_size += strlen(symbol_table_get(&unit->symbols, externals[i].symbol_id)->label_name) + 1;
+    }
+    for (i = 0; i < unit->code.count; i++) {
+        image->relocation_count += (code[i] & ARE_RELOCATABLE) != 0;
+    }
 
-    for (i = 0; i < label_count; i++)
-    {
-        free(label_table[i].label_name);
+    image->file.data = (char*)counted_malloc(image->counters, strings_size ? strings_size : 1);
+    image->file.size = strings_size;
+    if (!image->file.data || object_file_allocate(image)) {
+        object_file_free(image);
+        return MEMORY_ALLOCATION_FAILED;
     }
-    free(label_table);
-    free(data);
-    for (i = 0; i < code_count; i++)
-    {
-        if (code[i].operand_code != NULL) {
-            free(code[i].operand_code);
+
+    for (i = 0; i < unit->code.count; i++) {
+        image->words[word_index++] = code[i];
+        if (code[i] & ARE_RELOCATABLE) {
+            image->relocations[relocation_index++] = CODE_BASE_ADDRESS + i;
         }
     }
-    for (i = 0; i < externals_count; i++)
-    {
-        free(externals[i].label_name);
+    for (i = 0; i < unit->data.count; i++) {
+        image->words[word_index++] = (unsigned long)(unsigned int)data_words[i].value.integer;
+    }
+
+    /* The string table holds the entry names, then the external names */
+    name = image->file.data;
+    for (i = 0; i < symbol_table_count(&unit->symbols); i++) {
+        const label_element* label = symbol_table_at(&unit->symbols, i);
+        if (label->label_type & entry_label) {
+            strcpy(name, label->label_name);
+            image->entries[entry_index].name = name;
+            image->entries[entry_index++].address = label->address;
+            name += strlen(name) + 1;
+        }
+    }
+    for (i = 0; i < unit->externals.count; i++) {
+        strcpy(name, symbol_table_get(&unit->symbols, externals[i].symbol_id)->label_name);
+        image->externals[i].name = name;
+        image->externals[i].address = externals[i].address;
+        name += strlen(name) + 1;
     }
-    free(externals);
+    return SUCCESS;
 }
 
-void assemble(char* filename) {
-    first_cycle(filename);
-}
\ No newline at end of file
+int save_output_files(const char* filename, const object_file* image, object_format format, diagnostics* diag,
+                      assembly_stats* stats) {
+    char output_filename[FILENAME_MAX];
+    output_buffer output;
+    stats_timer timer;
+    int result = 0;
+
+    if (format == BINARY_OBJECT) {
+        stats_start(&timer);
+        copy_filename_with_different_extension(filename, output_filename, BINARY_OBJECT_EXTENSION);
+        result = object_file_write(image, output_filename);
+        if (result) {
+            report(diag, "Could not create output file: %s\n", output_filename);
+        }
+        stats_stop(stats, OBJ_WRITER_PHASE, &timer);
+        return result;
+    }
+
+    /* Every word takes a line of OBJ_LINE_SIZE characters */
+    stats_start(&timer);
+    output_buffer_init_counted(&output, (image->word_count + 1) * OBJ_LINE_SIZE, image->counters);
+    object_append_obj_text(&output, image);
+    result |= write_output_file(filename, ".obj", &output, diag);
+    stats_stop(stats, OBJ_WRITER_PHASE, &timer);
+
+    stats_start(&timer);
+    output_buffer_init_counted(&output, 0, image->counters);
+    object_append_labels_text(&output, image->entries, image->entry_count);
+    result |= write_output_file(filename, ".ent", &output, diag);
+    stats_stop(stats, ENT_WRITER_PHASE, &timer);
+
+    stats_start(&timer);
+    output_buffer_init_counted(&output, image->extern_count * (MAX_LABEL_LENGTH + OBJ_LINE_SIZE), image->counters);
+    object_append_labels_text(&output, image->externals, image->extern_count);
+    result |= write_output_file(filename, ".ext", &output, diag);
+    stats_stop(stats, EXT_WRITER_PHASE, &timer);
+    return result;
+}
+
+void collect_assembly_stats(const assembly_unit* unit, assembly_stats* stats) {
+    size_t i;
+
+    stats->labels += symbol_table_count(&unit->symbols);
+    stats->data_words += unit->data.count;
+    stats->code_words += unit->code.count;
+    for (i = 0; i < unit->fixups.count; i++) {
+        if (VECTOR_ITEMS(unit->fixups, fixup)[i].type == operand_fixup) {
+            stats->unresolved_operands++;
+        }
+    }
+    stats->externals += unit->externals.count;
+
+    stats->label_table_bytes = symbol_table_bytes(&unit->symbols);
+    stats->data_table_bytes = vector_bytes(&unit->data);
+    stats->code_table_bytes = vector_bytes(&unit->code);
+    stats->externals_table_bytes = vector_bytes(&unit->externals);
+}
@@ -2,11 +2,158 @@
 
 #include <stdio.h>
 
+#include "consts.h"
 #include "data_structs.h"
+#include "vector.h"
+#include "symbol_table.h"
+#include "line_buffer.h"
+#include "diagnostics.h"
+#include "stats.h"
+#include "object_file.h"
+
+/* The tables built while assembling a single file */
+typedef struct {
+    symbol_table symbols;
+    vector code;       /* machine_word items, the code image (one item per word) */
+    vector data;       /* data items */
+    vector externals;  /* external_info items, filled by the second cycle */
+    vector fixups;     /* fixup items, in source order */
+    vector label_checks;  /* size_t items, the symbol ids of the labels of `.entry` and `.extern` lines,
+                           * which are checked for duplicates but not defined */
+    size_t ICF;        /* final instruction counter */
+    size_t DCF;        /* final data counter */
+    alloc_counters* counters;  /* the counters of every subsystem, indexed by alloc_subsystem, NULL if not counted */
+} assembly_unit;
+
+/* The outcome of assembling a file */
+typedef enum {
+    ASSEMBLED,        /* the object image was built (and the output files were written) */
+    MACRO_FAILED,     /* errors were found while expanding the macros */
+    ASSEMBLY_FAILED,  /* errors were found in the source */
+    OUTPUT_FAILED     /* the source is valid but an output file could not be written */
+} assembly_result;
+
+/**
+ * Initializes empty assembly tables.
+ * 
+ * @param unit The tables to initialize.
+ */
+void assembly_init(assembly_unit* unit);
+
+/**
+ * Counts the allocations of the assembly tables, and of the object image built from them, in the
+ * counters of their subsystems from now on.
+ * 
+ * @param unit The tables.
+ * @param counters The counters of every subsystem, indexed by alloc_subsystem, NULL to stop counting.
+ */
+void assembly_track(assembly_unit* unit, alloc_counters* counters);
+
+/**
+ * Releases the memory held by the assembly tables.
+ * 
+ * @param unit The tables to free.
+ */
+void assembly_free(assembly_unit* unit);
+
+/**
+ * Performs the first cycle: builds the symbol table, the code and data sections and the fixups.
+ * 
+ * @param unit The tables to build.
+ * @param source The expanded source (content of the .am file).
+ * @param diag The diagnostics of the file.
+ * @return 0 on success, 1 if errors were encountered.
+ */
+int first_cycle(assembly_unit* unit, const line_buffer* source, diagnostics* diag);
+
+/**
+ * Reserves room in the tables for a number of source lines, so a typical source needs (almost) no reallocations.
+ * 
+ * @param unit The tables.
+ * @param line_count The number of lines.
+ * @return SUCCESS on success, MEMORY_ALLOCATION_FAILED on failure.
+ */
+int assembly_reserve(assembly_unit* unit, size_t line_count);
+
+/**
+ * Performs the first cycle over a run of lines, appending to the tables: instruction and data counters
+ * continue from the code and data already in the tables. The first cycle of a whole source is
+ * first_cycle_lines over all of its lines followed by close_first_cycle.
+ * 
+ * @param unit The tables to build.
+ * @param text The lines.
+ * @param size The size of the lines in bytes.
+ * @param first_line The line number of the first line.
+ * @param diag The diagnostics of the file.
+ * @return 0 on success, 1 if errors were encountered.
+ */
+int first_cycle_lines(assembly_unit* unit, const char* text, size_t size, int first_line, diagnostics* diag);
+
+/**
+ * Ends the first cycle: sets the final counters and moves the data labels after the code section.
+ * 
+ * @param unit The tables built by the first cycle.
+ */
+void close_first_cycle(assembly_unit* unit);
+
+/**
+ * Performs the second cycle: resolves the fixups recorded by the first cycle.
+ * 
+ * @param unit The tables built by the first cycle.
+ * @param diag The diagnostics of the file.
+ * @return 0 on success, 1 if errors were encountered.
+ */
+int second_cycle(assembly_unit* unit, diagnostics* diag);
+
+/**
+ * Performs the second cycle over a range of the fixups. Ranges resolved at the same time must not
+ * mark entries: the entry labels are then marked afterwards with mark_entry_labels.
+ * 
+ * @param unit The tables built by the first cycle.
+ * @param first The first fixup of the range.
+ * @param end One past the last fixup of the range.
+ * @param mark_entries Whether to mark the labels of the entry fixups as entries.
+ * @param externals Receives the uses of external labels (external_info items), in fixup order.
+ * @param diag Receives the messages of the range.
+ * @return 0 on success, 1 if errors were encountered.
+ */
+int resolve_fixups(assembly_unit* unit, size_t first, size_t end, int mark_entries, vector* externals,
+                   diagnostics* diag);
+
+/**
+ * Marks the labels named by the entry fixups as entries.
+ * 
+ * @param unit The tables built by the first cycle.
+ */
+void mark_entry_labels(assembly_unit* unit);
+
+/**
+ * Builds the object image of an assembled file: its code and data words, its entry and external labels
+ * (with their own copy of the names) and the addresses of its relocatable words.
+ * 
+ * @param unit The tables resolved by the second cycle.
+ * @param image Receives the image, released with object_file_free.
+ * @return SUCCESS on success, MEMORY_ALLOCATION_FAILED on failure.
+ */
+int assembly_image(const assembly_unit* unit, object_file* image);
+
+/**
+ * Adds the counters and the table sizes of an assembled file to its statistics.
+ * 
+ * @param unit The tables of the file.
+ * @param stats The statistics of the file.
+ */
+void collect_assembly_stats(const assembly_unit* unit, assembly_stats* stats);
 
 /**
- * This function initiates the assembly process by calling the first cycle.
+ * Writes the object, entries and externals files of an assembled file.
  * 
- * @param filename The name of the assembly file to process.
+ * @param filename The name of the assembly file, used to name the output files.
+ * @param image The object image of the file.
+ * @param format Whether to write the .obj, .ent and .ext text files or a single binary object file.
+ * @param diag The diagnostics of the file.
+ * @param stats Receives the time taken by each writer, NULL if statistics are not collected.
+ * @return 0 on success, 1 if a file could not be written.
  */
-void assemble(char* filename);
+int save_output_files(const char* filename, const object_file* image, object_format format, diagnostics* diag,
+                      assembly_stats* stats);
@@ -0,0 +1,409 @@
+/**
+ * Batch driver: reads the input files, assembles them with the assembler library and writes the
+ * output files, either one by one or concurrently on a pool of worker threads.
+ * Every file is processed with its own assembler context (one per worker, reused between files)
+ * and its own diagnostics, so the workers share no mutable state.
+ */
+
+/* pthreads are not part of ANSI C, request them from the POSIX headers */
+#define _POSIX_C_SOURCE 200112L
+
+#include "batch.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+#include "consts.h"
+#include "utils.h"
+#include "assembler.h"
+#include "libassembler.h"
+#include "line_buffer.h"
+#include "source_file.h"
+#include "diagnostics.h"
+#include "build_cache.h"
+#include "split_driver.h"
+
+
+/* Tables used while processing a single file, reused between the files of a worker */
+typedef struct {
+    assembler_context* assembler;
+    build_cache* cache;  /* shared by all the workers, NULL if results are not cached */
+    int split_threads;   /* the threads a large file is split across */
+} file_context;
+
+/* State shared by the workers of a concurrent batch */
+typedef struct {
+    char** files;
+    int file_count;
+    const assembler_options* options;
+    build_cache* cache;
+    assembler_context* contexts;  /* one per worker */
+    int next_context;      /* the next context to hand out to a worker */
+    diagnostics* outputs;  /* the buffered output of each file */
+    assembly_stats* stats; /* the statistics of each file, NULL if not collected */
+    int* done;             /* whether each file was processed */
+    int next_file;         /* the next file to hand out to a worker */
+    int split_threads;     /* the threads a large file is split across, the jobs left over by the workers */
+    pthread_mutex_t lock;
+    pthread_cond_t file_done;
+} batch_state;
+
+/**
+ * Macro processes and assembles a single file.
+ * 
+ * @param base_name The base name of the file (without the .as extension).
+ * @param options The assembler options.
+ * @param context The tables used for processing the file.
+ * @param diag Receives the output of the file.
+ * @param stats Receives the statistics of the file, NULL if statistics are not collected.
+ */
+void process_file(char* base_name, const assembler_options* options, file_context* context, diagnostics* diag,
+                  assembly_stats* stats) {
+    char as_file[FILENAME_MAX];
+    char am_file[FILENAME_MAX];
+    double start = stats_wall_time();
+    source_file input;
+    object_file image;
+    cache_key key;
+    cached_outcome outcome = CACHED_MACRO_FAILED;
+    size_t messages_start;
+    assembly_result result;
+    int cacheable = 0;
+    int failed;
+
+    if (stats) {
+        stats_init(stats);
+        stats->files = 1;
+    }
+
+    copy_filename_with_different_extension(base_name, as_file, ".as");
+    copy_filename_with_different_extension(base_name, am_file, ".am");
+    report(diag, "### Starting processing on file %s ###\n", as_file);
+    messages_start = diag->text.count;
+
+    if (source_file_open(&input, as_file)) {
+        report(diag, "File not found: %s\n", as_file);
+        if (stats) {
+            stats->elapsed_seconds = stats_wall_time() - start;
+        }
+        return;
+    }
+
+    /* restore unchanged files from the cache */
+    if (context->cache) {
+        build_cache_key(context->cache, input.data, input.size, &key);
+        if (build_cache_restore(context->cache, &key, input.data, input.size, am_file, options->emit_am, diag,
+                                &outcome)) {
+            if (outcome != CACHED_MACRO_FAILED) {
+                report(diag, "### Finished processing on file %s ###\n", as_file);
+            }
+            source_file_close(&input);
+            if (stats) {
+                stats->elapsed_seconds = stats_wall_time() - start;
+            }
+            return;
+        }
+        cacheable = 1;
+    }
+
+    /* macro process files into memory */
+    failed = expand_source(context->assembler, input.data, input.size, diag, stats);
+
+    /* assemble files */
+    if (!failed) {
+        if (options->emit_am && line_buffer_write_file(&context->assembler->source, am_file)) {
+            report(diag, "Could not create output file: %s\n", am_file);
+            cacheable = 0;
+        }
+        result = assemble_expanded_split(context->assembler, &image, diag, stats, context->split_threads);
+        if (result == ASSEMBLED && save_output_files(am_file, &image, options->format, diag, stats)) {
+            result = OUTPUT_FAILED;
+        }
+        object_file_free(&image);
+        switch (result) {
+            case ASSEMBLED:
+                outcome = CACHED_ASSEMBLED;
+                break;
+            case ASSEMBLY_FAILED:
+                outcome = CACHED_ASSEMBLY_FAILED;
+                break;
+            default:
+                cacheable = 0;  /* a failure to write is not a property of the source */
+                break;
+        }
+    }
+
+    if (cacheable) {
+        build_cache_store(context->cache, &key, input.data, input.size, outcome,
+                          (char*)diag->text.items + messages_start, diag->text.count - messages_start,
+                          &context->assembler->source, am_file);
+    }
+    source_file_close(&input);
+    if (!failed) {
+        report(diag, "### Finished processing on file %s ###\n", as_file);
+    }
+
+    if (stats) {
+        stats->elapsed_seconds = stats_wall_time() - start;
+    }
+}
+
+/**
+ * Prints the statistics of a file or of the batch: text with the regular output, JSON lines on stderr.
+ * 
+ * @param base_name The base name of the file, or NULL for the totals of the batch.
+ * @param options The assembler options.
+ * @param stats The statistics to print.
+ */
+void print_stats(const char* base_name, const assembler_options* options, const assembly_stats* stats) {
+    char as_file[FILENAME_MAX];
+    FILE* out = options->stats == JSON_STATS ? stderr : stdout;
+
+    if (base_name) {
+        copy_filename_with_different_extension(base_name, as_file, ".as");
+    }
+    stats_print(out, base_name ? as_file : NULL, stats, options->stats);
+    fflush(out);
+}
+
+/**
+ * Worker thread: takes the next unprocessed file until all files were handed out.
+ * 
+ * @param arg The batch state.
+ * @return NULL.
+ */
+void* batch_worker(void* arg) {
+    batch_state* state = (batch_state*)arg;
+    file_context context;
+    int file_index;
+
+    pthread_mutex_lock(&state->lock);
+    context.assembler = &state->contexts[state->next_context++];
+    pthread_mutex_unlock(&state->lock);
+    context.cache = state->cache;
+    context.split_threads = state->split_threads;
+
+    for (;;) {
+        pthread_mutex_lock(&state->lock);
+        file_index = state->next_file++;
+        pthread_mutex_unlock(&state->lock);
+        if (file_index >= state->file_count) {
+            break;
+        }
+
+        process_file(state->files[file_index], state->options, &context, &state->outputs[file_index],
+                     state->stats ? &state->stats[file_index] : NULL);
+
+        pthread_mutex_lock(&state->lock);
+        state->done[file_index] = 1;
+        pthread_cond_broadcast(&state->file_done);
+        pthread_mutex_unlock(&state->lock);
+    }
+
+    return NULL;
+}
+
+/**
+ * Assembles the files one by one, printing the output of each file as soon as it is done.
+ * 
+ * @param files The base names of the files.
+ * @param file_count The number of files.
+ * @param options The assembler options.
+ * @param assembler The assembler context used for every file.
+ * @param cache The build cache, NULL if results are not cached.
+ * @param total Receives the totals of the batch, NULL if statistics are not collected.
+ */
+void assemble_files_sequentially(char* files[], int file_count, const assembler_options* options,
+                                 assembler_context* assembler, build_cache* cache, assembly_stats* total) {
+    file_context context;
+    diagnostics diag;
+    assembly_stats stats;
+    int i;
+
+    context.assembler = assembler;
+    context.cache = cache;
+    context.split_threads = options->jobs;
+    diagnostics_init(&diag);
+
+    for (i = 0; i < file_count; i++) {
+        process_file(files[i], options, &context, &diag, total ? &stats : NULL);
+        diagnostics_flush(&diag, stdout);
+        if (total) {
+            print_stats(files[i], options, &stats);
+            stats_add(total, &stats);
+        }
+    }
+
+    diagnostics_free(&diag);
+}
+
+/**
+ * Assembles the files concurrently, printing the output of each file in input order.
+ * 
+ * @param files The base names of the files.
+ * @param file_count The number of files.
+ * @param options The assembler options.
+ * @param worker_count The number of worker threads.
+ * @param contexts The assembler contexts of the workers, at least worker_count of them.
+ * @param cache The build cache, NULL if results are not cached.
+ * @param total Receives the totals of the batch, NULL if statistics are not collected.
+ */
+void assemble_files_concurrently(char* files[], int file_count, const assembler_options* options, int worker_count,
+                                 assembler_context* contexts, build_cache* cache, assembly_stats* total) {
+    batch_state state;
+    pthread_t* workers;
+    int started = 0;
+    int i;
+
+    state.files = files;
+    state.file_count = file_count;
+    state.options = options;
+    state.cache = cache;
+    state.contexts = contexts;
+    state.next_context = 0;
+    state.next_file = 0;
+    state.split_threads = options->jobs / worker_count;
+    state.outputs = (diagnostics*)malloc(file_count * sizeof(diagnostics));
+    state.stats = total ? (assembly_stats*)malloc(file_count * sizeof(assembly_stats)) : NULL;
+    state.done = (int*)calloc(file_count, sizeof(int));
+    workers = (pthread_t*)malloc(worker_count * sizeof(pthread_t));
+    if (!state.outputs || (total && !state.stats) || !state.done || !workers) {
+        free(state.outputs);
+        free(state.stats);
+        free(state.done);
+        free(workers);
+        assemble_files_sequentially(files, file_count, options, contexts, cache, total);
+        return;
+    }
+    for (i = 0; i < file_count; i++) {
+        diagnostics_init(&state.outputs[i]);
+    }
+    pthread_mutex_init(&state.lock, NULL);
+    pthread_cond_init(&state.file_done, NULL);
+
+    for (i = 0; i < worker_count; i++) {
+        if (pthread_create(&workers[started], NULL, batch_worker, &state) == 0) {
+            started++;
+        }
+    }
+    if (started == 0) {
+        /* No threads available, do the work on this thread */
+        batch_worker(&state);
+    }
+
+    /* Print the output of every file in input order, as soon as it is available */
+    for (i = 0; i < file_count; i++) {
+        pthread_mutex_lock(&state.lock);
+        while (!state.done[i]) {
+            pthread_cond_wait(&state.file_done, &state.lock);
+        }
+        pthread_mutex_unlock(&state.lock);
+
+        diagnostics_flush(&state.outputs[i], stdout);
+        diagnostics_free(&state.outputs[i]);
+        if (total) {
+            print_stats(files[i], options, &state.stats[i]);
+            stats_add(total, &state.stats[i]);
+        }
+    }
+
+    for (i = 0; i < started; i++) {
+        pthread_join(workers[i], NULL);
+    }
+    pthread_mutex_destroy(&state.lock);
+    pthread_cond_destroy(&state.file_done);
+    free(state.outputs);
+    free(state.stats);
+    free(state.done);
+    free(workers);
+}
+
+void batch_tables_init(batch_tables* tables) {
+    tables->contexts = NULL;
+    tables->count = 0;
+}
+
+/**
+ * Makes sure there is an assembler context for every worker.
+ * 
+ * @param tables The tables.
+ * @param count The number of contexts needed.
+ * @return SUCCESS on success, MEMORY_ALLOCATION_FAILED on failure.
+ */
+int batch_tables_reserve(batch_tables* tables, int count) {
+    assembler_context* contexts;
+
+    if (count <= tables->count) {
+        return SUCCESS;
+    }
+    contexts = (assembler_context*)realloc(tables->contexts, count * sizeof(assembler_context));
+    if (!contexts) {
+        return MEMORY_ALLOCATION_FAILED;
+    }
+    tables->contexts = contexts;
+    for (; tables->count < count; tables->count++) {
+        assembler_context_init(&tables->contexts[tables->count]);
+    }
+    return SUCCESS;
+}
+
+void batch_tables_free(batch_tables* tables) {
+    int i;
+
+    for (i = 0; i < tables->count; i++) {
+        assembler_context_free(&tables->contexts[i]);
+    }
+    free(tables->contexts);
+    batch_tables_init(tables);
+}
+
+void assemble_files(char* files[], int file_count, const assembler_options* options, batch_tables* tables) {
+    batch_tables batch;
+    batch_tables* use_tables = tables ? tables : &batch;
+    assembly_stats total;
+    assembly_stats* collect = options->stats != NO_STATS ? &total : NULL;
+    const char* text_outputs[] = {".obj", ".ent", ".ext", NULL};
+    const char* binary_outputs[] = {BINARY_OBJECT_EXTENSION, NULL};
+    build_cache cache;
+    build_cache* use_cache = NULL;
+    int worker_count = options->jobs < file_count ? options->jobs : file_count;
+    double start = stats_wall_time();
+
+    /* Without resident tables, the tables live as long as the batch */
+    batch_tables_init(&batch);
+    if (batch_tables_reserve(use_tables, worker_count)) {
+        printf("Error: Memory allocation failed.\n");
+        batch_tables_free(&batch);
+        return;
+    }
+
+    if (options->cache_dir) {
+        if (build_cache_open(&cache, options->cache_dir, (size_t)options->cache_size * 1024 * 1024,
+                             options->format == BINARY_OBJECT ? binary_outputs : text_outputs) == SUCCESS) {
+            use_cache = &cache;
+        } else {
+            printf("Error: Could not open the cache directory %s, assembling without a cache.\n", options->cache_dir);
+        }
+    }
+
+    stats_init(&total);
+    if (worker_count <= 1) {
+        assemble_files_sequentially(files, file_count, options, use_tables->contexts, use_cache, collect);
+    } else {
+        assemble_files_concurrently(files, file_count, options, worker_count, use_tables->contexts, use_cache,
+                                    collect);
+    }
+
+    if (use_cache) {
+        build_cache_close(&cache);
+        printf("Cache: %lu hits, %lu misses, %lu entries evicted\n", cache.hits, cache.misses, cache.evicted);
+    }
+
+    if (collect) {
+        /* The files of a concurrent batch overlap, the batch takes the wall time between its start and end */
+        total.elapsed_seconds = stats_wall_time() - start;
+        print_stats(NULL, options, &total);
+    }
+    batch_tables_free(&batch);
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "stats.h"
+#include "object_file.h"
+#include "libassembler.h"
+
+/* The default size limit of the build cache, in megabytes */
+#define DEFAULT_CACHE_SIZE_MB 256
+
+/* Options controlling how a batch of files is assembled */
+typedef struct {
+    int emit_am;               /* also write the expanded source to the .am file */
+    int jobs;                  /* number of files assembled concurrently */
+    object_format format;      /* text .obj/.ent/.ext files or a binary object file */
+    stats_format stats;        /* print the statistics of every file and of the batch */
+    const char* cache_dir;     /* directory of the build cache, NULL if results are not cached */
+    unsigned long cache_size;  /* size limit of the build cache, in megabytes */
+} assembler_options;
+
+/* The assembler contexts of the workers, kept between the batches of a resident assembler
+ * so later batches reuse the memory of the earlier ones */
+typedef struct {
+    assembler_context* contexts;
+    int count;
+} batch_tables;
+
+/**
+ * Initializes empty batch tables.
+ * 
+ * @param tables The tables to initialize.
+ */
+void batch_tables_init(batch_tables* tables);
+
+/**
+ * Releases the memory held by the batch tables.
+ * 
+ * @param tables The tables to free.
+ */
+void batch_tables_free(batch_tables* tables);
+
+/**
+ * Macro processes and assembles a batch of files. With more than one job the files are assembled
+ * concurrently on a pool of worker threads; the output of each file is buffered and printed
+ * in input order, so it is the same as when assembling the files one by one.
+ * With statistics enabled, the statistics of each file follow its output and the batch totals
+ * are printed last (JSON lines go to stderr, so the regular output is unchanged).
+ * With a cache directory, unchanged files are restored from the cache instead of being assembled,
+ * and the number of cache hits and misses is printed at the end.
+ * 
+ * @param files The base names of the files to assemble (without the .as extension).
+ * @param file_count The number of files.
+ * @param options The assembler options.
+ * @param tables Tables kept between batches, grown as needed; NULL to use tables freed with the batch.
+ */
+void assemble_files(char* files[], int file_count, const assembler_options* options, batch_tables* tables);
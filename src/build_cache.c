@@ -0,0 +1,395 @@
+/**
+ * Content-addressed build cache: the messages and the output files of a source are stored under a hash
+ * of the assembler version and the source content, so an unchanged source is restored instead of being
+ * macro processed and assembled again. An entry keeps the source it was made from and is only restored
+ * for that exact source, so two sources whose hashes collide never share results. Entries are written to a temporary file and renamed into place,
+ * so concurrent workers and concurrent assembler runs never see a partial entry. The temporary files
+ * of a run that died while writing are removed by the eviction of a later run.
+ */
+
+/* The directory and file calls are not part of ANSI C, request them from the POSIX headers */
+#define _POSIX_C_SOURCE 200112L
+
+#include "build_cache.h"
+
+#include <string.h>
+#include <errno.h>
+#include <dirent.h>
+#include <time.h>
+#include <utime.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include "consts.h"
+#include "utils.h"
+#include "vector.h"
+#include "source_file.h"
+
+#define CACHE_MAGIC "ASMCACH2"
+#define CACHE_ENTRY_EXTENSION ".entry"
+#define CACHE_TEMP_EXTENSION ".tmp"
+
+/* A temporary file older than this was left by a run that died before renaming it into place */
+#define STALE_TEMP_SECONDS 60
+
+/* Everything that changes the output of the assembler. The id is the same for every build of the same
+ * version, so rebuilding the assembler keeps the cache.
+ */
+#define CACHE_BUILD_ID ASSEMBLER_VERSION " " OUTPUT_VERSION
+
+/* The sections of a cache entry, stored one after the other after the header */
+enum {
+    SOURCE_SECTION,
+    MESSAGES_SECTION,
+    AM_SECTION,
+    FIRST_OUTPUT_SECTION,
+    SECTION_COUNT = FIRST_OUTPUT_SECTION + MAX_CACHED_OUTPUTS
+};
+
+/* The header of a cache entry */
+typedef struct {
+    char magic[8];
+    unsigned long outcome;
+    unsigned long sizes[SECTION_COUNT];
+} cache_entry_header;
+
+/* A file of the cache directory, considered for eviction */
+typedef struct {
+    char name[CACHE_KEY_SIZE];
+    time_t last_used;
+    size_t size;
+} cache_file;
+
+
+int build_cache_open(build_cache* cache, const char* dir, size_t max_bytes, const char* const* outputs) {
+    if (strlen(dir) >= sizeof(cache->dir)) {
+        return 1;
+    }
+    for (cache->output_count = 0; outputs[cache->output_count]; cache->output_count++) {
+        if (cache->output_count == MAX_CACHED_OUTPUTS) {
+            return 1;
+        }
+        cache->outputs[cache->output_count] = outputs[cache->output_count];
+    }
+    if (mkdir(dir, 0777) != 0 && errno != EEXIST) {
+        return 1;
+    }
+    strcpy(cache->dir, dir);
+    cache->max_bytes = max_bytes;
+    cache->hits = 0;
+    cache->misses = 0;
+    cache->evicted = 0;
+    cache->next_temp = 0;
+    pthread_mutex_init(&cache->lock, NULL);
+    return SUCCESS;
+}
+
+/**
+ * Hashes a block of bytes into a running FNV-1a hash of 32 bits.
+ *
+ * @param hash The hash so far.
+ * @param data The bytes to add.
+ * @param length The number of bytes.
+ * @return The updated hash.
+ */
+unsigned long hash_update(unsigned long hash, const char* data, size_t length) {
+    size_t i;
+
+    for (i = 0; i < length; i++) {
+        hash ^= (unsigned char)data[i];
+        hash = (hash * 16777619UL) & 0xFFFFFFFFUL;
+    }
+    return hash;
+}
+
+void build_cache_key(const build_cache* cache, const char* source, size_t size, cache_key* key) {
+    unsigned long low = 2166136261UL;
+    unsigned long high = 0x811C9DC5UL ^ 0x5BD1E995UL;  /* a second, independent starting point */
+    int i;
+
+    low = hash_update(low, CACHE_BUILD_ID, sizeof(CACHE_BUILD_ID));
+    for (i = 0; i < cache->output_count; i++) {
+        low = hash_update(low, cache->outputs[i], strlen(cache->outputs[i]) + 1);
+    }
+    low = hash_update(low, source, size);
+    high = hash_update(high, source, size);
+    high = hash_update(high, CACHE_BUILD_ID, sizeof(CACHE_BUILD_ID));
+    sprintf(key->name, "%08lx%08lx-%lx" CACHE_ENTRY_EXTENSION, high, low, (unsigned long)size);
+}
+
+/**
+ * @param cache The cache.
+ * @param name The name of a file in the cache directory.
+ * @param path Receives the path of the file.
+ */
+void cache_path(const build_cache* cache, const char* name, char* path) {
+    sprintf(path, "%s/%s", cache->dir, name);
+}
+
+/**
+ * Writes a block of bytes to a file, replacing its content.
+ *
+ * @param filename The name of the file.
+ * @param data The content of the file.
+ * @param length The length of the content in bytes.
+ * @return SUCCESS on success, 1 if the file could not be written.
+ */
+int write_bytes(const char* filename, const char* data, size_t length) {
+    FILE* file = fopen(filename, "wb");
+    int failed;
+
+    if (!file) {
+        return 1;
+    }
+    failed = length && fwrite(data, 1, length, file) != length;
+    failed |= fclose(file) != 0;
+    return failed;
+}
+
+/**
+ * Counts a cache lookup.
+ *
+ * @param cache The cache.
+ * @param hit Whether the lookup was a hit.
+ */
+void count_lookup(build_cache* cache, int hit) {
+    pthread_mutex_lock(&cache->lock);
+    if (hit) {
+        cache->hits++;
+    } else {
+        cache->misses++;
+    }
+    pthread_mutex_unlock(&cache->lock);
+}
+
+/**
+ * Checks that a cache entry is complete and locates its sections.
+ *
+ * @param entry The content of the entry.
+ * @param header Receives the header of the entry.
+ * @param sections Receives the start of every section.
+ * @return 1 if the entry is valid, 0 otherwise.
+ */
+int read_entry(const source_file* entry, cache_entry_header* header, const char* sections[SECTION_COUNT]) {
+    size_t offset = sizeof(*header);
+    int i;
+
+    if (entry->size < sizeof(*header)) {
+        return 0;
+    }
+    memcpy(header, entry->data, sizeof(*header));
+    if (memcmp(header->magic, CACHE_MAGIC, sizeof(header->magic)) != 0 || header->outcome > CACHED_ASSEMBLED) {
+        return 0;
+    }
+    for (i = 0; i < SECTION_COUNT; i++) {
+        if (header->sizes[i] > entry->size - offset) {
+            return 0;
+        }
+        sections[i] = entry->data + offset;
+        offset += header->sizes[i];
+    }
+    return offset == entry->size;
+}
+
+int build_cache_restore(build_cache* cache, const cache_key* key, const char* source, size_t size,
+                        const char* am_file, int emit_am, diagnostics* diag, cached_outcome* outcome) {
+    char path[FILENAME_MAX];
+    char output_file[FILENAME_MAX];
+    source_file entry;
+    cache_entry_header header;
+    const char* sections[SECTION_COUNT];
+    int i;
+
+    cache_path(cache, key->name, path);
+    if (source_file_open(&entry, path)) {
+        count_lookup(cache, 0);
+        return 0;
+    }
+    /* The key is only a hash: the entry is another source's if the hashes collide */
+    if (!read_entry(&entry, &header, sections) || header.sizes[SOURCE_SECTION] != size ||
+        (size && memcmp(sections[SOURCE_SECTION], source, size) != 0)) {
+        source_file_close(&entry);
+        count_lookup(cache, 0);
+        return 0;
+    }
+
+    *outcome = (cached_outcome)header.outcome;
+    report_text(diag, sections[MESSAGES_SECTION], header.sizes[MESSAGES_SECTION]);
+    if (emit_am && *outcome != CACHED_MACRO_FAILED &&
+        write_bytes(am_file, sections[AM_SECTION], header.sizes[AM_SECTION])) {
+        report(diag, "Could not create output file: %s\n", am_file);
+    }
+    for (i = 0; i < cache->output_count && *outcome == CACHED_ASSEMBLED; i++) {
+        copy_filename_with_different_extension(am_file, output_file, cache->outputs[i]);
+        if (write_bytes(output_file, sections[FIRST_OUTPUT_SECTION + i], header.sizes[FIRST_OUTPUT_SECTION + i])) {
+            report(diag, "Could not create output file: %s\n", output_file);
+        }
+    }
+    source_file_close(&entry);
+
+    /* Mark the entry as recently used, so it is evicted last */
+    utime(path, NULL);
+    count_lookup(cache, 1);
+    return 1;
+}
+
+void build_cache_store(build_cache* cache, const cache_key* key, const char* as_source, size_t as_size,
+                       cached_outcome outcome, const char* messages, size_t messages_length,
+                       const line_buffer* source, const char* am_file) {
+    char path[FILENAME_MAX];
+    char temp_path[FILENAME_MAX];
+    char output_file[FILENAME_MAX];
+    source_file outputs[MAX_CACHED_OUTPUTS];
+    cache_entry_header header;
+    FILE* file;
+    int opened = 0;
+    int failed = 0;
+    int i;
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CACHE_MAGIC, sizeof(header.magic));
+    header.outcome = outcome;
+    header.sizes[SOURCE_SECTION] = as_size;
+    header.sizes[MESSAGES_SECTION] = messages_length;
+    header.sizes[AM_SECTION] = outcome == CACHED_MACRO_FAILED ? 0 : source->text.count;
+
+    /* The outputs of an assembled file are taken from the files just written */
+    if (outcome == CACHED_ASSEMBLED) {
+        for (; opened < cache->output_count; opened++) {
+            copy_filename_with_different_extension(am_file, output_file, cache->outputs[opened]);
+            if (source_file_open(&outputs[opened], output_file)) {
+                break;
+            }
+            header.sizes[FIRST_OUTPUT_SECTION + opened] = outputs[opened].size;
+        }
+        failed = opened != cache->output_count;
+    }
+
+    pthread_mutex_lock(&cache->lock);
+    /* Numbered per process, and the process id keeps other runs sharing the directory apart */
+    sprintf(temp_path, "%s/%s.%lu.%lu" CACHE_TEMP_EXTENSION, cache->dir, key->name, (unsigned long)getpid(),
+            cache->next_temp++);
+    pthread_mutex_unlock(&cache->lock);
+
+    file = failed ? NULL : fopen(temp_path, "wb");
+    if (file) {
+        failed = fwrite(&header, sizeof(header), 1, file) != 1;
+        failed |= as_size && fwrite(as_source, 1, as_size, file) != as_size;
+        failed |= messages_length && fwrite(messages, 1, messages_length, file) != messages_length;
+        failed |= header.sizes[AM_SECTION] &&
+                  fwrite(source->text.items, 1, header.sizes[AM_SECTION], file) != header.sizes[AM_SECTION];
+        for (i = 0; i < opened; i++) {
+            failed |= outputs[i].size && fwrite(outputs[i].data, 1, outputs[i].size, file) != outputs[i].size;
+        }
+        failed |= fclose(file) != 0;
+
+        cache_path(cache, key->name, path);
+        if (failed || rename(temp_path, path) != 0) {
+            remove(temp_path);
+        }
+    }
+
+    for (i = 0; i < opened; i++) {
+        source_file_close(&outputs[i]);
+    }
+}
+
+/**
+ * Orders cache files from the least to the most recently used.
+ *
+ * @param a The first cache file.
+ * @param b The second cache file.
+ * @return A negative number, zero or a positive number, as for qsort.
+ */
+int compare_last_used(const void* a, const void* b) {
+    time_t first = ((const cache_file*)a)->last_used;
+    time_t second = ((const cache_file*)b)->last_used;
+
+    return first < second ? -1 : first > second;
+}
+
+/**
+ * @param name A file name.
+ * @param extension An extension.
+ * @return 1 if the name ends with the extension, 0 otherwise.
+ */
+int has_extension(const char* name, const char* extension) {
+    size_t length = strlen(name);
+
+    return length >= strlen(extension) && strcmp(name + length - strlen(extension), extension) == 0;
+}
+
+/**
+ * Lists the entries of the cache directory with their sizes and last use, and removes the stale
+ * temporary files.
+ *
+ * @param cache The cache.
+ * @param files Receives the cache_file items.
+ * @return The total size of the entries in bytes.
+ */
+size_t list_entries(const build_cache* cache, vector* files) {
+    char path[FILENAME_MAX];
+    struct dirent* dir_entry;
+    struct stat info;
+    cache_file* file;
+    size_t total = 0;
+    size_t length;
+    time_t now = time(NULL);
+    DIR* dir = opendir(cache->dir);
+
+    if (!dir) {
+        return 0;
+    }
+    while ((dir_entry = readdir(dir)) != NULL) {
+        length = strlen(dir_entry->d_name);
+        if (has_extension(dir_entry->d_name, CACHE_TEMP_EXTENSION) && length < 2 * CACHE_KEY_SIZE) {
+            cache_path(cache, dir_entry->d_name, path);
+            if (stat(path, &info) == 0 && S_ISREG(info.st_mode) && now - info.st_mtime > STALE_TEMP_SECONDS) {
+                remove(path);
+            }
+            continue;
+        }
+        if (length >= sizeof(file->name) || !has_extension(dir_entry->d_name, CACHE_ENTRY_EXTENSION)) {
+            continue;
+        }
+        cache_path(cache, dir_entry->d_name, path);
+        if (stat(path, &info) != 0 || !S_ISREG(info.st_mode)) {
+            continue;
+        }
+        file = (cache_file*)vector_push(files);
+        if (!file) {
+            break;
+        }
+        strcpy(file->name, dir_entry->d_name);
+        file->last_used = info.st_mtime;
+        file->size = info.st_size;
+        total += file->size;
+    }
+    closedir(dir);
+    return total;
+}
+
+void build_cache_close(build_cache* cache) {
+    char path[FILENAME_MAX];
+    vector files;
+    cache_file* items;
+    size_t total;
+    size_t i;
+
+    vector_init(&files, sizeof(cache_file));
+    total = list_entries(cache, &files);
+    if (total > cache->max_bytes) {
+        items = VECTOR_ITEMS(files, cache_file);
+        qsort(items, files.count, sizeof(cache_file), compare_last_used);
+        for (i = 0; i < files.count && total > cache->max_bytes; i++) {
+            cache_path(cache, items[i].name, path);
+            if (remove(path) == 0) {
+                total -= items[i].size;
+                cache->evicted++;
+            }
+        }
+    }
+    vector_free(&files);
+    pthread_mutex_destroy(&cache->lock);
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+#include "line_buffer.h"
+#include "diagnostics.h"
+
+/* The length of the file name of a cache entry */
+#define CACHE_KEY_SIZE 48
+
+/* The largest number of output files of a source */
+#define MAX_CACHED_OUTPUTS 3
+
+/* The outcome of processing a file, as recorded in the cache */
+typedef enum {
+    CACHED_MACRO_FAILED,     /* macro expansion failed, only the messages are kept */
+    CACHED_ASSEMBLY_FAILED,  /* the source has errors, the messages and the .am content are kept */
+    CACHED_ASSEMBLED         /* the messages, the .am content and the output files are kept */
+} cached_outcome;
+
+/* A directory of cached results, shared by the workers of a batch. Every entry is a single file
+ * named after a hash of the assembler version, the output files and the content of the .as file,
+ * and holds a copy of that content, which a lookup compares with the source before using the entry.
+ */
+typedef struct {
+    const char* outputs[MAX_CACHED_OUTPUTS];  /* the extensions of the output files of an assembled source */
+    int output_count;
+    char dir[FILENAME_MAX - 2 * CACHE_KEY_SIZE];  /* leaves room for the entry names */
+    size_t max_bytes;          /* the oldest entries are evicted when the directory grows past this size */
+    unsigned long hits;
+    unsigned long misses;
+    unsigned long evicted;
+    unsigned long next_temp;   /* numbers the temporary files of entries being written by this process */
+    pthread_mutex_t lock;
+} build_cache;
+
+/* Identifies the cache entry of a source */
+typedef struct {
+    char name[CACHE_KEY_SIZE];  /* the file name of the entry in the cache directory */
+} cache_key;
+
+/**
+ * Opens a cache directory, creating it if it does not exist.
+ *
+ * @param cache The cache to initialize.
+ * @param dir The cache directory.
+ * @param max_bytes The size limit of the directory.
+ * @param outputs The extensions of the output files of an assembled source, NULL terminated.
+ * @return SUCCESS on success, 1 if the directory could not be created.
+ */
+int build_cache_open(build_cache* cache, const char* dir, size_t max_bytes, const char* const* outputs);
+
+/**
+ * Evicts the least recently used entries until the directory fits its size limit, and releases the cache.
+ *
+ * @param cache The cache to close.
+ */
+void build_cache_close(build_cache* cache);
+
+/**
+ * Computes the cache key of a source.
+ *
+ * @param cache The cache.
+ * @param source The content of the .as file.
+ * @param size The size of the content in bytes.
+ * @param key Receives the key.
+ */
+void build_cache_key(const build_cache* cache, const char* source, size_t size, cache_key* key);
+
+/**
+ * Looks up a source in the cache. An entry is a hit only if it was stored for the same content.
+ * On a hit, the cached messages are appended to the diagnostics and the cached output files are
+ * written next to the .am file.
+ *
+ * @param cache The cache.
+ * @param key The key of the source.
+ * @param source The content of the .as file.
+ * @param size The size of the content in bytes.
+ * @param am_file The path of the .am file, used to name the output files.
+ * @param emit_am Whether to write the .am file as well.
+ * @param diag Receives the cached messages.
+ * @param outcome Receives the cached outcome.
+ * @return 1 on a hit, 0 on a miss.
+ */
+int build_cache_restore(build_cache* cache, const cache_key* key, const char* source, size_t size,
+                        const char* am_file, int emit_am, diagnostics* diag, cached_outcome* outcome);
+
+/**
+ * Records the result of processing a source. The output files of an assembled source are read back
+ * from the files just written. Failing to write an entry is not an error, the
+ * source is simply assembled again next time.
+ *
+ * @param cache The cache.
+ * @param key The key of the source.
+ * @param as_source The content of the .as file.
+ * @param as_size The size of the content in bytes.
+ * @param outcome The outcome of processing the source.
+ * @param messages The messages reported while processing the source.
+ * @param messages_length The length of the messages in bytes.
+ * @param source The expanded source (the content of the .am file).
+ * @param am_file The path of the .am file, used to find the output files.
+ */
+void build_cache_store(build_cache* cache, const cache_key* key, const char* as_source, size_t as_size,
+                       cached_outcome outcome, const char* messages, size_t messages_length,
+                       const line_buffer* source, const char* am_file);
@@ -11,25 +11,127 @@ const char* OPCODE_STRINGS[] = {
 
 /* Array of opcode rules defining the behavior and constraints of each opcode.
  Each entry specifies the opcode, its function, allowed operands, and addressing modes.
+ The entries are in opcode enum order, so the table is indexed directly by the opcode.
+ The addressing modes are sets of MODE_BIT, so checking an operand is a single mask, and the
+ first word template already holds the opcode, funct and A,R,E fields of the instruction.
 */
 const OpcodeRule OPCODE_TABLE[] = {
-    {MOV, 0, 0, 2, {0, 1, 3}, 3, {1, 3}, 2},    
-    {CMP, 1, 0, 2, {0, 1, 3}, 3, {0, 1, 3}, 3}, 
-    {ADD, 2, 1, 2, {0, 1, 3}, 3, {1, 3}, 2},       
-    {SUB, 2, 2, 2, {0, 1, 3}, 3, {1, 3}, 2},       
-    {LEA, 4, 0, 2, {1}, 1, {1, 3}, 2},          
-    {CLR, 5, 1, 1, {0}, 0, {1, 3}, 2},           
-    {NOT, 5, 2, 1, {0}, 0, {1, 3}, 2},           
-    {INC, 5, 3, 1, {0}, 0, {1, 3}, 2},           
-    {DEC, 5, 4, 1, {0}, 0, {1, 3}, 2},           
-    {JMP, 9, 1, 1, {0}, 0, {1, 2}, 2},           
-    {BNE, 9, 2, 1, {0}, 0, {1, 2}, 2},           
-    {JSR, 9, 3, 1, {0}, 0, {1, 2}, 2},           
-    {RED, 12, 0, 1, {0}, 0, {1, 3}, 2},           
-    {PRN, 13, 0, 1, {0}, 0, {0, 1, 3}, 3},        
-    {RTS, 14, 0, 0, {0}, 0, {0}, 0},               
-    {STOP, 15, 0, 0, {0}, 0, {0}, 0}               
+    {MOV, 0, 0, 2, MODE_BIT(0) | MODE_BIT(1) | MODE_BIT(3), MODE_BIT(1) | MODE_BIT(3), FIRST_WORD_TEMPLATE(0, 0)},
+    {CMP, 1, 0, 2, MODE_BIT(0) | MODE_BIT(1) | MODE_BIT(3), MODE_BIT(0) | MODE_BIT(1) | MODE_BIT(3), FIRST_WORD_TEMPLATE(1, 0)},
+    {ADD, 2, 1, 2, MODE_BIT(0) | MODE_BIT(1) | MODE_BIT(3), MODE_BIT(1) | MODE_BIT(3), FIRST_WORD_TEMPLATE(2, 1)},
+    {SUB, 2, 2, 2, MODE_BIT(0) | MODE_BIT(1) | MODE_BIT(3), MODE_BIT(1) | MODE_BIT(3), FIRST_WORD_TEMPLATE(2, 2)},
+    {LEA, 4, 0, 2, MODE_BIT(1), MODE_BIT(1) | MODE_BIT(3), FIRST_WORD_TEMPLATE(4, 0)},
+    {CLR, 5, 1, 1, 0, MODE_BIT(1) | MODE_BIT(3), FIRST_WORD_TEMPLATE(5, 1)},
+    {NOT, 5, 2, 1, 0, MODE_BIT(1) | MODE_BIT(3), FIRST_WORD_TEMPLATE(5, 2)},
+    {INC, 5, 3, 1, 0, MODE_BIT(1) | MODE_BIT(3), FIRST_WORD_TEMPLATE(5, 3)},
+    {DEC, 5, 4, 1, 0, MODE_BIT(1) | MODE_BIT(3), FIRST_WORD_TEMPLATE(5, 4)},
+    {JMP, 9, 1, 1, 0, MODE_BIT(1) | MODE_BIT(2), FIRST_WORD_TEMPLATE(9, 1)},
+    {BNE, 9, 2, 1, 0, MODE_BIT(1) | MODE_BIT(2), FIRST_WORD_TEMPLATE(9, 2)},
+    {JSR, 9, 3, 1, 0, MODE_BIT(1) | MODE_BIT(2), FIRST_WORD_TEMPLATE(9, 3)},
+    {RED, 12, 0, 1, 0, MODE_BIT(1) | MODE_BIT(3), FIRST_WORD_TEMPLATE(12, 0)},
+    {PRN, 13, 0, 1, 0, MODE_BIT(0) | MODE_BIT(1) | MODE_BIT(3), FIRST_WORD_TEMPLATE(13, 0)},
+    {RTS, 14, 0, 0, 0, 0, FIRST_WORD_TEMPLATE(14, 0)},
+    {STOP, 15, 0, 0, 0, 0, FIRST_WORD_TEMPLATE(15, 0)}
 };
 
+/* Perfect hash table of all keywords (mnemonics, directives and macro keywords).
+ The table was generated for KEYWORD_HASH below, which maps each keyword to a distinct slot,
+ so classifying a word takes one hash and at most one string comparison.
+*/
+const keyword KEYWORD_TABLE[KEYWORD_TABLE_SIZE] = {
+    /*  0 */ {"red", OPCODE_KEYWORD, RED},
+    /*  1 */ {NULL, NO_KEYWORD, 0},
+    /*  2 */ {NULL, NO_KEYWORD, 0},
+    /*  3 */ {"mcroend", MACRO_KEYWORD, 0},
+    /*  4 */ {NULL, NO_KEYWORD, 0},
+    /*  5 */ {NULL, NO_KEYWORD, 0},
+    /*  6 */ {NULL, NO_KEYWORD, 0},
+    /*  7 */ {NULL, NO_KEYWORD, 0},
+    /*  8 */ {NULL, NO_KEYWORD, 0},
+    /*  9 */ {"cmp", OPCODE_KEYWORD, CMP},
+    /* 10 */ {".string", DIRECTIVE_KEYWORD, STRING_DIRECTIVE},
+    /* 11 */ {NULL, NO_KEYWORD, 0},
+    /* 12 */ {NULL, NO_KEYWORD, 0},
+    /* 13 */ {"clr", OPCODE_KEYWORD, CLR},
+    /* 14 */ {NULL, NO_KEYWORD, 0},
+    /* 15 */ {NULL, NO_KEYWORD, 0},
+    /* 16 */ {"jmp", OPCODE_KEYWORD, JMP},
+    /* 17 */ {NULL, NO_KEYWORD, 0},
+    /* 18 */ {"prn", OPCODE_KEYWORD, PRN},
+    /* 19 */ {"mcro", MACRO_KEYWORD, 0},
+    /* 20 */ {"jsr", OPCODE_KEYWORD, JSR},
+    /* 21 */ {NULL, NO_KEYWORD, 0},
+    /* 22 */ {NULL, NO_KEYWORD, 0},
+    /* 23 */ {NULL, NO_KEYWORD, 0},
+    /* 24 */ {".extern", DIRECTIVE_KEYWORD, EXTERN_DIRECTIVE},
+    /* 25 */ {NULL, NO_KEYWORD, 0},
+    /* 26 */ {NULL, NO_KEYWORD, 0},
+    /* 27 */ {"stop", OPCODE_KEYWORD, STOP},
+    /* 28 */ {"not", OPCODE_KEYWORD, NOT},
+    /* 29 */ {NULL, NO_KEYWORD, 0},
+    /* 30 */ {"rts", OPCODE_KEYWORD, RTS},
+    /* 31 */ {"mov", OPCODE_KEYWORD, MOV},
+    /* 32 */ {NULL, NO_KEYWORD, 0},
+    /* 33 */ {NULL, NO_KEYWORD, 0},
+    /* 34 */ {NULL, NO_KEYWORD, 0},
+    /* 35 */ {NULL, NO_KEYWORD, 0},
+    /* 36 */ {NULL, NO_KEYWORD, 0},
+    /* 37 */ {NULL, NO_KEYWORD, 0},
+    /* 38 */ {NULL, NO_KEYWORD, 0},
+    /* 39 */ {NULL, NO_KEYWORD, 0},
+    /* 40 */ {NULL, NO_KEYWORD, 0},
+    /* 41 */ {NULL, NO_KEYWORD, 0},
+    /* 42 */ {NULL, NO_KEYWORD, 0},
+    /* 43 */ {NULL, NO_KEYWORD, 0},
+    /* 44 */ {".entry", DIRECTIVE_KEYWORD, ENTRY_DIRECTIVE},
+    /* 45 */ {NULL, NO_KEYWORD, 0},
+    /* 46 */ {NULL, NO_KEYWORD, 0},
+    /* 47 */ {"add", OPCODE_KEYWORD, ADD},
+    /* 48 */ {"dec", OPCODE_KEYWORD, DEC},
+    /* 49 */ {NULL, NO_KEYWORD, 0},
+    /* 50 */ {"bne", OPCODE_KEYWORD, BNE},
+    /* 51 */ {NULL, NO_KEYWORD, 0},
+    /* 52 */ {"lea", OPCODE_KEYWORD, LEA},
+    /* 53 */ {"inc", OPCODE_KEYWORD, INC},
+    /* 54 */ {NULL, NO_KEYWORD, 0},
+    /* 55 */ {NULL, NO_KEYWORD, 0},
+    /* 56 */ {NULL, NO_KEYWORD, 0},
+    /* 57 */ {NULL, NO_KEYWORD, 0},
+    /* 58 */ {".data", DIRECTIVE_KEYWORD, DATA_DIRECTIVE},
+    /* 59 */ {NULL, NO_KEYWORD, 0},
+    /* 60 */ {NULL, NO_KEYWORD, 0},
+    /* 61 */ {"sub", OPCODE_KEYWORD, SUB},
+    /* 62 */ {NULL, NO_KEYWORD, 0},
+    /* 63 */ {NULL, NO_KEYWORD, 0}
+};
+
+/* Character classes of all byte values, as the C locale classifies them.
+ Looking a character up is a single load, where the <ctype.h> functions consult the current locale.
+*/
+#define B CHAR_BLANK
+#define A CHAR_ALPHA
+#define D CHAR_DIGIT
+const unsigned char CHAR_CLASS[256] = {
+    /*   0 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, B, B, B, B, B, 0, 0,
+    /*  16 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    /*  32 */ B, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    /*  48 */ D, D, D, D, D, D, D, D, D, D, 0, 0, 0, 0, 0, 0,
+    /*  64 */ 0, A, A, A, A, A, A, A, A, A, A, A, A, A, A, A,
+    /*  80 */ A, A, A, A, A, A, A, A, A, A, A, 0, 0, 0, 0, 0,
+    /*  96 */ 0, A, A, A, A, A, A, A, A, A, A, A, A, A, A, A,
+    /* 112 */ A, A, A, A, A, A, A, A, A, A, A, 0, 0, 0, 0, 0,
+    /* 128 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    /* 144 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    /* 160 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    /* 176 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    /* 192 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    /* 208 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    /* 224 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    /* 240 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+};
+#undef B
+#undef A
+#undef D
+
 /* The size of the OPCODE_TABLE array, used for iteration, validation, and lookup operations. */
 const int OPCODE_TABLE_SIZE = sizeof(OPCODE_TABLE) / sizeof(OPCODE_TABLE[0]);
@@ -3,6 +3,18 @@
 #include "data_structs.h"
 
 
+/* The version of the assembler, part of the build cache keys */
+#define ASSEMBLER_VERSION "1.0"
+
+/* The version of what the assembler produces for a source: the encoding of the words, the messages
+ * and the layout of the output files. Bump it with every change to any of them, so the build cache
+ * does not restore the results of an older assembler.
+ */
+#define OUTPUT_VERSION "1"
+
+/* The address of the first instruction */
+#define CODE_BASE_ADDRESS 100
+
 enum ReturnCodes {
     SUCCESS = 0,
     NO_INPUT_FILES,
@@ -13,8 +25,25 @@ enum ReturnCodes {
     INVALID_DST_OPERAND_ADDRESSING_MODE
 };
 
+/* Size of the keyword perfect hash table and the hash of a keyword of a given length */
+#define KEYWORD_TABLE_SIZE 64
+#define KEYWORD_HASH(word, length) \
+    (((unsigned char)(word)[0] + 2 * (unsigned char)(word)[(length) - 1] + 2 * (length)) % KEYWORD_TABLE_SIZE)
+
+/* Character classes of CHAR_CLASS */
+#define CHAR_BLANK 0x1  /* space, tab, newline, vertical tab, form feed, carriage return */
+#define CHAR_ALPHA 0x2  /* letter */
+#define CHAR_DIGIT 0x4  /* decimal digit */
+#define IS_BLANK(c) (CHAR_CLASS[(unsigned char)(c)] & CHAR_BLANK)
+#define IS_ALPHA(c) (CHAR_CLASS[(unsigned char)(c)] & CHAR_ALPHA)
+#define IS_ALNUM(c) (CHAR_CLASS[(unsigned char)(c)] & (CHAR_ALPHA | CHAR_DIGIT))
+
 extern const char* OPCODE_STRINGS[16];
 
 extern const OpcodeRule OPCODE_TABLE[16];
 
 extern const int OPCODE_TABLE_SIZE;
+
+extern const keyword KEYWORD_TABLE[KEYWORD_TABLE_SIZE];
+
+extern const unsigned char CHAR_CLASS[256];
@@ -12,25 +12,48 @@ typedef enum {
     JMP, BNE, JSR, RED, PRN, RTS, STOP, INVALID
 } opcode;
 
-typedef struct {
-    unsigned int E: 1;  /* always 0 */
-    unsigned int R: 1;  /* always 0 */
-    unsigned int A: 1;  /* always 1 */
-    unsigned int funct: 5;
-    unsigned int dest_reg: 3;
-    unsigned int dest_address: 2;
-    unsigned int src_reg: 3;
-    unsigned int src_address: 2;
-    unsigned int opcode_value: 6;
-} first_word;
+typedef enum {
+    DATA_DIRECTIVE, STRING_DIRECTIVE, ENTRY_DIRECTIVE, EXTERN_DIRECTIVE, NOT_A_DIRECTIVE
+} directive;
 
+typedef enum {
+    NO_KEYWORD,
+    OPCODE_KEYWORD,     /* value is an opcode */
+    DIRECTIVE_KEYWORD,  /* value is a directive */
+    MACRO_KEYWORD       /* mcro / mcroend */
+} keyword_kind;
 
 typedef struct {
-    unsigned int E: 1;
-    unsigned int R: 1;
-    unsigned int A: 1;
-    unsigned int integer: 21;
-} operand;
+    const char* name;
+    keyword_kind kind;
+    int value;
+} keyword;
+
+/* A 24-bit machine word, held in the low bits. Every code word ends with the A,R,E field. */
+typedef unsigned int machine_word;
+
+#define ARE_EXTERNAL 0x1u      /* the word refers to an external label */
+#define ARE_RELOCATABLE 0x2u   /* the word holds an address in this file */
+#define ARE_ABSOLUTE 0x4u      /* the word does not depend on where the code is loaded */
+
+/* Fields of the first word of an instruction */
+#define FUNCT_SHIFT 3
+#define DEST_REG_SHIFT 8
+#define DEST_MODE_SHIFT 11
+#define SRC_REG_SHIFT 13
+#define SRC_MODE_SHIFT 16
+#define OPCODE_SHIFT 18
+
+/* The value of an operand word, above its A,R,E field */
+#define OPERAND_SHIFT 3
+#define OPERAND_MASK 0x1FFFFFu
+
+/* The first word of an instruction before its operands are filled in */
+#define FIRST_WORD_TEMPLATE(opcode_value, funct) \
+    (((machine_word)(opcode_value) << OPCODE_SHIFT) | ((machine_word)(funct) << FUNCT_SHIFT) | ARE_ABSOLUTE)
+
+/* The bit of an addressing mode in a set of allowed modes */
+#define MODE_BIT(mode) (1u << (mode))
 
 typedef struct {
     union {
@@ -39,21 +62,8 @@ typedef struct {
     } value;
 } data;
 
-typedef struct {
-    opcode opcode;
-    size_t num_of_operands;
-    char operands[MAX_OPERANDS][MAX_LABEL_LENGTH];
-} instruction;
-
-typedef struct {
-    size_t L;  /* 1/2/3 for code */
-    size_t IC; /* for external file */
-    int need_to_resolve;  /* to know for second round if needed to be resolved. */
-    first_word first_word_val;
-    operand* operand_code;
-} machine_code;
-
 typedef enum {
+    undefined_label = 0x0,  /* referenced but not (yet) defined */
     data_label = 0x1,
     entry_label = 0x2,
     extern_label = 0x4,
@@ -62,23 +72,40 @@ typedef enum {
 
 typedef struct {
     int address;
-    char *label_name;
+    const char *label_name;  /* interned in the string pool of the symbol table */
     /* int assembly_line; */
     label_options label_type;
 } label_element;
 
+/* A use of an external label */
 typedef struct {
     int address;
-    char *label_name;
+    size_t symbol_id;  /* the external label */
 } external_info;
 
+typedef enum {
+    operand_fixup,        /* an operand word referring to a label */
+    entry_fixup,          /* a `.entry` directive marking a label */
+    invalid_entry_line,   /* a malformed `.entry` directive, reported in the second cycle */
+    invalid_entry_label   /* a `.entry` directive naming a reserved word, reported in the second cycle */
+} fixup_type;
+
+/* Work left for the second cycle, recorded by the first cycle in source order */
+typedef struct {
+    fixup_type type;
+    size_t word_index;   /* index of the operand word in the code image */
+    int operand_index;   /* index of the operand word within its instruction */
+    size_t symbol_id;    /* the label referred to */
+    int address_mode;    /* addressing mode of the operand (direct or relative) */
+    int line_number;     /* the source line, for diagnostics */
+} fixup;
+
 typedef struct {
     opcode opcode;
     int opcode_value;
     int funct;
     int num_of_operands;
-    int valid_source_modes[3];  /* Allowed source operand addressing modes */
-    int num_source_modes;
-    int valid_dest_modes[3];    /* Allowed destination operand addressing modes */
-    int num_dest_modes;
+    unsigned int source_modes;  /* MODE_BIT set of the allowed source operand addressing modes */
+    unsigned int dest_modes;    /* MODE_BIT set of the allowed destination operand addressing modes */
+    machine_word first_word;    /* FIRST_WORD_TEMPLATE of the opcode */
 } OpcodeRule;
\ No newline at end of file
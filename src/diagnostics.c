@@ -0,0 +1,119 @@
+/* vsnprintf is not part of ANSI C, request it from the POSIX headers */
+#define _POSIX_C_SOURCE 200112L
+
+#include "diagnostics.h"
+
+#include <stdarg.h>
+#include <string.h>
+
+#define MESSAGE_BUF_SIZE 256
+#define ERROR_PREFIX "Error"
+#define WARNING_PREFIX "Warning"
+
+
+void diagnostics_init(diagnostics* diag) {
+    vector_init(&diag->text, sizeof(char));
+    vector_init(&diag->messages, sizeof(diagnostic_message));
+    diag->line_number = 0;
+}
+
+/**
+ * Appends a message to the text of the buffer and records it.
+ * 
+ * @param diag The diagnostics buffer.
+ * @param text The message.
+ * @param length The length of the message in bytes.
+ */
+void append_message(diagnostics* diag, const char* text, size_t length) {
+    diagnostic_message* message;
+    char* dest = (char*)vector_extend(&diag->text, length);
+
+    if (!dest) {
+        return;
+    }
+    memcpy(dest, text, length);
+
+    message = (diagnostic_message*)vector_push(&diag->messages);
+    if (!message) {
+        return;
+    }
+    message->severity = NOTE_MESSAGE;
+    if (length >= strlen(ERROR_PREFIX) && !strncmp(text, ERROR_PREFIX, strlen(ERROR_PREFIX))) {
+        message->severity = ERROR_MESSAGE;
+    } else if (length >= strlen(WARNING_PREFIX) && !strncmp(text, WARNING_PREFIX, strlen(WARNING_PREFIX))) {
+        message->severity = WARNING_MESSAGE;
+    }
+    message->line_number = diag->line_number;
+    message->offset = diag->text.count - length;
+    message->length = length;
+}
+
+void report(diagnostics* diag, const char* format, ...) {
+    char buffer[MESSAGE_BUF_SIZE];
+    char* message = buffer;
+    va_list args;
+    int length;
+
+    va_start(args, format);
+    length = vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    if (length < 0) {
+        return;
+    }
+
+    /* Messages quoting long source text do not fit the stack buffer */
+    if (length >= sizeof(buffer)) {
+        message = (char*)malloc(length + 1);
+        if (!message) {
+            return;
+        }
+        va_start(args, format);
+        vsnprintf(message, length + 1, format, args);
+        va_end(args);
+    }
+
+    append_message(diag, message, length);
+    if (message != buffer) {
+        free(message);
+    }
+}
+
+void report_text(diagnostics* diag, const char* text, size_t length) {
+    append_message(diag, text, length);
+}
+
+void report_all(diagnostics* diag, const diagnostics* other) {
+    int line_number = diag->line_number;
+    size_t i;
+
+    for (i = 0; i < diagnostics_count(other); i++) {
+        const diagnostic_message* message = diagnostics_at(other, i);
+        diag->line_number = message->line_number;
+        append_message(diag, diagnostics_text(other, message), message->length);
+    }
+    diag->line_number = line_number;
+}
+
+size_t diagnostics_count(const diagnostics* diag) {
+    return diag->messages.count;
+}
+
+const diagnostic_message* diagnostics_at(const diagnostics* diag, size_t index) {
+    return &VECTOR_ITEMS(diag->messages, diagnostic_message)[index];
+}
+
+const char* diagnostics_text(const diagnostics* diag, const diagnostic_message* message) {
+    return VECTOR_ITEMS(diag->text, char) + message->offset;
+}
+
+void diagnostics_flush(diagnostics* diag, FILE* stream) {
+    fwrite(diag->text.items, 1, diag->text.count, stream);
+    fflush(stream);
+    diag->text.count = 0;
+    diag->messages.count = 0;
+}
+
+void diagnostics_free(diagnostics* diag) {
+    vector_free(&diag->text);
+    vector_free(&diag->messages);
+}
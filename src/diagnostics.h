@@ -0,0 +1,99 @@
+#pragma once
+
+#include <stdio.h>
+
+#include "vector.h"
+
+
+/* The kind of a message, from the start of its text */
+typedef enum {
+    NOTE_MESSAGE,     /* progress and other messages */
+    WARNING_MESSAGE,  /* "Warning: ..." */
+    ERROR_MESSAGE     /* "Error: ..." */
+} message_severity;
+
+/* A single reported message */
+typedef struct {
+    message_severity severity;
+    int line_number;  /* the source line being processed when it was reported, 0 if none */
+    size_t offset;    /* the position of the message in the text of the buffer */
+    size_t length;    /* the length of the message, including its newline */
+} diagnostic_message;
+
+/* Buffered diagnostics (errors, warnings and progress messages) of a single file,
+ * so files assembled concurrently can print their output in input order.
+ * Every message is also recorded with its severity and source line, for callers of the library.
+ */
+typedef struct {
+    vector text;      /* char items, the formatted messages */
+    vector messages;  /* diagnostic_message items, in report order */
+    int line_number;  /* the source line being processed: of the .as source while expanding macros,
+                       * of the expanded source in the assembler cycles, 0 outside of a line */
+} diagnostics;
+
+/**
+ * Initializes an empty diagnostics buffer.
+ * 
+ * @param diag The diagnostics buffer to initialize.
+ */
+void diagnostics_init(diagnostics* diag);
+
+/**
+ * Appends a formatted message to the diagnostics buffer (printf-style).
+ * 
+ * @param diag The diagnostics buffer.
+ * @param format The printf format of the message.
+ */
+void report(diagnostics* diag, const char* format, ...);
+
+/**
+ * Appends already formatted messages to the diagnostics buffer, recorded as a single message.
+ * 
+ * @param diag The diagnostics buffer.
+ * @param text The messages.
+ * @param length The length of the messages in bytes.
+ */
+void report_text(diagnostics* diag, const char* text, size_t length);
+
+/**
+ * Appends the messages of another buffer, keeping their source lines.
+ * 
+ * @param diag The diagnostics buffer.
+ * @param other The buffer whose messages are appended.
+ */
+void report_all(diagnostics* diag, const diagnostics* other);
+
+/**
+ * @param diag The diagnostics buffer.
+ * @return The number of messages in the buffer.
+ */
+size_t diagnostics_count(const diagnostics* diag);
+
+/**
+ * @param diag The diagnostics buffer.
+ * @param index The index of the message, less than diagnostics_count().
+ * @return The message.
+ */
+const diagnostic_message* diagnostics_at(const diagnostics* diag, size_t index);
+
+/**
+ * @param diag The diagnostics buffer.
+ * @param message A message of the buffer.
+ * @return The text of the message (not null-terminated, see its length).
+ */
+const char* diagnostics_text(const diagnostics* diag, const diagnostic_message* message);
+
+/**
+ * Writes the buffered messages to a stream and empties the buffer.
+ * 
+ * @param diag The diagnostics buffer.
+ * @param stream The stream to write to.
+ */
+void diagnostics_flush(diagnostics* diag, FILE* stream);
+
+/**
+ * Releases the memory held by the diagnostics buffer.
+ * 
+ * @param diag The diagnostics buffer to free.
+ */
+void diagnostics_free(diagnostics* diag);
@@ -0,0 +1,178 @@
+/**
+ * This file implements the lexer of the assembler. Each source line is scanned once and turned into a
+ * `line_ir` record (label, directive or mnemonic, operands with their addressing modes), which the
+ * assembler cycles consume without looking at the text again.
+ */
+
+#include "lexer.h"
+
+#include <string.h>
+
+#include "utils.h"
+#include "consts.h"
+#include "line_scan.h"
+
+
+int get_addressing_mode(const char* operand) {
+    if (!operand || !*operand) return -1;
+    if (operand[0] == '#') return IMMEDIATE_ADDRESS_MODE;
+    if (operand[0] == '&') return REALTIVE_ADDRESS_MODE;
+    if (operand[0] == 'r' && operand[1] >= '0' && operand[1] <= '7' && operand[2] == '\0') return REGISTER_ADDRESS_MODE;
+    return DIRECT_ADDRESS_MODE;
+}
+
+/**
+ * @param str The string to skip.
+ * @return A pointer to the first non-whitespace character of the string.
+ */
+char* skip_whitespace(char* str) {
+    while (IS_BLANK(*str)) {
+        str++;
+    }
+    return str;
+}
+
+/**
+ * Sets the directive or opcode of a line from its first word.
+ *
+ * @param ir The line record.
+ * @param word The first word of the statement.
+ */
+void classify_word(line_ir* ir, const char* word) {
+    const keyword* entry = find_keyword(word);
+
+    if (entry == NULL) {
+        return;
+    }
+    if (entry->kind == DIRECTIVE_KEYWORD) {
+        ir->directive = (directive)entry->value;
+    } else if (entry->kind == OPCODE_KEYWORD) {
+        ir->opcode = (opcode)entry->value;
+    }
+}
+
+/**
+ * Appends an operand to the line record, removing its surrounding whitespace in place.
+ *
+ * @param ir The line record.
+ * @param text The operand text, null-terminated.
+ */
+void add_operand(line_ir* ir, char* text) {
+    char* end;
+
+    text = skip_whitespace(text);
+    end = text + strlen(text);
+    while (end > text && IS_BLANK(end[-1])) {
+        end--;
+    }
+    *end = '\0';
+
+    ir->operands[ir->operand_count].text = text;
+    ir->operands[ir->operand_count].address_mode = get_addressing_mode(text);
+    ir->operand_count++;
+}
+
+/**
+ * Splits the comma separated operands of a statement into the line record.
+ *
+ * @param ir The line record.
+ * @param rest The text after the directive or mnemonic.
+ */
+void split_operands(line_ir* ir, char* rest) {
+    char* comma;
+
+    rest = skip_whitespace(rest);
+    if (*rest == '\0') {
+        return;
+    }
+    while (ir->operand_count < MAX_LINE_OPERANDS) {
+        comma = strchr(rest, ',');
+        if (comma) {
+            *comma = '\0';
+        }
+        add_operand(ir, rest);
+        if (!comma) {
+            break;
+        }
+        rest = comma + 1;
+    }
+}
+
+lex_result lex_line(const char* line, size_t length, int line_number, line_ir* ir) {
+    line_scan scan;
+    char* word;
+    char* rest;
+    char delimiter;
+
+    ir->line_number = line_number;
+    ir->label = NULL;
+    ir->directive = NOT_A_DIRECTIVE;
+    ir->opcode = INVALID;
+    ir->operand_count = 0;
+
+    /* One sweep finds the blanks around the statement, its first colon and its comma errors */
+    scan_line(line, length, &scan);
+    line += scan.first;
+    length = scan.end - scan.first;
+    if (length >= LEXER_BUF_SIZE) {
+        length = LEXER_BUF_SIZE - 1;  /* longer lines are rejected before lexing */
+        scan_line(line, length, &scan);
+    }
+    memcpy(ir->source, line, length);
+    ir->source[length] = '\0';
+    memcpy(ir->tokens, ir->source, length + 1);
+
+    if (length == 0 || ir->source[0] == ';') {
+        return LINE_EMPTY;
+    }
+
+    /* Commas and colons inside a string literal are plain characters */
+    if (scan.consecutive_commas) {
+        return LINE_MULTIPLE_COMMAS;
+    }
+    if (!scan.open_string && ir->tokens[length - 1] == ',') {
+        return LINE_TRAILING_COMMA;
+    }
+
+    rest = ir->tokens;
+    if (scan.colon != SCAN_NONE) {
+        /* relative to the first character that is not blank, the start of the tokens */
+        rest = ir->tokens + (scan.colon - scan.first);
+        *rest++ = '\0';
+        ir->label = ir->tokens;
+    }
+
+    /* The directive or mnemonic ends at whitespace, or at the quote of `.string"..."` */
+    word = skip_whitespace(rest);
+    rest = word;
+    while (*rest && !IS_BLANK(*rest) && *rest != '"') {
+        rest++;
+    }
+    delimiter = *rest;
+    if (*rest) {
+        *rest++ = '\0';
+    }
+    classify_word(ir, word);
+
+    if (ir->directive != STRING_DIRECTIVE) {
+        split_operands(ir, rest);
+        return LINE_OK;
+    }
+
+    if (delimiter != '"') {
+        rest = skip_whitespace(rest);
+        if (*rest != '"') {
+            return LINE_OK;  /* no string, reported by the caller */
+        }
+        rest++;
+    }
+    ir->operands[0].text = rest;
+    ir->operands[0].address_mode = -1;
+    ir->operand_count = 1;
+    rest = strchr(rest, '"');
+    if (rest) {
+        *rest = '\0';
+    }
+
+    return LINE_OK;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <stdlib.h>
+
+#include "data_structs.h"
+
+#define LEXER_BUF_SIZE 100
+/* Every operand but the first takes at least a comma and a character */
+#define MAX_LINE_OPERANDS (LEXER_BUF_SIZE / 2)
+
+#define IMMEDIATE_ADDRESS_MODE 0
+#define DIRECT_ADDRESS_MODE 1
+#define REALTIVE_ADDRESS_MODE 2
+#define REGISTER_ADDRESS_MODE 3
+
+
+typedef enum {
+    LINE_OK,
+    LINE_EMPTY,              /* an empty line or a comment */
+    LINE_MULTIPLE_COMMAS,
+    LINE_TRAILING_COMMA
+} lex_result;
+
+typedef struct {
+    const char* text;  /* null-terminated, without surrounding whitespace */
+    int address_mode;  /* addressing mode of an instruction operand, -1 if the operand is empty */
+} operand_span;
+
+/* A lexed line: every later stage works on this record instead of re-scanning the text */
+typedef struct {
+    int line_number;
+    const char* label;       /* the text before ':', NULL if the line has no label */
+    directive directive;     /* NOT_A_DIRECTIVE for instructions */
+    opcode opcode;           /* INVALID for directives and unknown mnemonics */
+    size_t operand_count;
+    operand_span operands[MAX_LINE_OPERANDS];  /* for `.string`, the single operand is the quoted text */
+    char source[LEXER_BUF_SIZE];  /* the line without surrounding whitespace, for messages */
+    char tokens[LEXER_BUF_SIZE];  /* a copy of source, cut into the null-terminated spans above */
+} line_ir;
+
+
+/**
+ * Identifies the addressing mode of an operand.
+ *
+ * @param operand The operand string.
+ * @return The addressing mode of the operand, or -1 if the operand is empty.
+ */
+int get_addressing_mode(const char* operand);
+
+/**
+ * Lexes a line of assembly code in a single pass: finds its label, classifies the directive or mnemonic
+ * and splits the operands, computing their addressing modes.
+ *
+ * @param line The line to lex (not necessarily null-terminated).
+ * @param length The length of the line.
+ * @param line_number The source line number.
+ * @param ir The record to fill.
+ * @return LINE_OK if the line holds a statement, LINE_EMPTY for empty and comment lines,
+ *         or the comma error found in the line.
+ */
+lex_result lex_line(const char* line, size_t length, int line_number, line_ir* ir);
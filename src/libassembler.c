@@ -0,0 +1,78 @@
+/**
+ * The assembler library: the macro processor and both assembler cycles over a source held in memory,
+ * producing an object image held in memory. The command line assembler reads the sources and writes
+ * the output files around these calls.
+ */
+
+#include "libassembler.h"
+
+#include <string.h>
+
+#include "consts.h"
+
+
+void assembler_context_init(assembler_context* context) {
+    macro_table_init(&context->macros);
+    line_buffer_init(&context->source);
+}
+
+void assembler_context_free(assembler_context* context) {
+    /* The counters of the last source may be gone already */
+    macro_table_track(&context->macros, NULL);
+    line_buffer_track(&context->source, NULL);
+    macro_table_free(&context->macros);
+    line_buffer_free(&context->source);
+}
+
+int expand_source(assembler_context* context, const char* text, size_t size, diagnostics* diag,
+                  assembly_stats* stats) {
+    alloc_counters* counters = stats ? stats->allocations : NULL;
+    stats_timer timer;
+    int failed;
+
+    /* The tables kept from the previous source are counted from here as held by this one */
+    macro_table_track(&context->macros, subsystem_counters(counters, MACRO_ALLOCS));
+    line_buffer_track(&context->source, subsystem_counters(counters, SOURCE_ALLOCS));
+    line_buffer_clear(&context->source);
+    stats_start(&timer);
+    failed = macro_process_text(text, size, &context->macros, &context->source, diag, stats);
+    stats_stop(stats, MACRO_PHASE, &timer);
+    return failed;
+}
+
+assembly_result assemble_expanded(assembler_context* context, object_file* image, diagnostics* diag,
+                                  assembly_stats* stats) {
+    assembly_unit unit;
+    stats_timer timer;
+    int failed;
+
+    memset(image, 0, sizeof(*image));
+    assembly_init(&unit);
+    assembly_track(&unit, stats ? stats->allocations : NULL);
+    stats_start(&timer);
+    failed = first_cycle(&unit, &context->source, diag);
+    stats_stop(stats, FIRST_CYCLE_PHASE, &timer);
+    if (!failed) {
+        stats_start(&timer);
+        failed = second_cycle(&unit, diag);
+        if (!failed && assembly_image(&unit, image)) {
+            report(diag, "Error: Memory allocation failed.\n");
+            failed = 1;
+        }
+        stats_stop(stats, SECOND_CYCLE_PHASE, &timer);
+    }
+    if (stats) {
+        collect_assembly_stats(&unit, stats);
+    }
+    assembly_free(&unit);
+    return failed ? ASSEMBLY_FAILED : ASSEMBLED;
+}
+
+assembly_result assemble_source(assembler_context* context, const char* text, size_t size, object_file* image,
+                                diagnostics* diag, assembly_stats* stats) {
+    if (expand_source(context, text, size, diag, stats)) {
+        memset(image, 0, sizeof(*image));
+        return MACRO_FAILED;
+    }
+    return assemble_expanded(context, image, diag, stats);
+}
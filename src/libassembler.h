@@ -0,0 +1,77 @@
+#pragma once
+
+#include <stdlib.h>
+
+#include "assembler.h"
+#include "macro_processor.h"
+#include "line_buffer.h"
+#include "diagnostics.h"
+#include "object_file.h"
+#include "stats.h"
+
+/* The assembler library (libassembler.a): assembles a source held in memory into an object image
+ * held in memory, reporting structured diagnostics. It does not touch the filesystem and keeps no
+ * global state; the tables of a source live in an assembler_context, so every thread assembling
+ * sources at the same time uses its own context.
+ */
+
+/* Tables reused between the sources assembled with the same context */
+typedef struct {
+    macro_table macros;
+    line_buffer source;  /* the expanded source (content of the .am file) of the last source */
+} assembler_context;
+
+/**
+ * Initializes an assembler context.
+ *
+ * @param context The context to initialize.
+ */
+void assembler_context_init(assembler_context* context);
+
+/**
+ * Releases the memory held by an assembler context.
+ *
+ * @param context The context to free.
+ */
+void assembler_context_free(assembler_context* context);
+
+/**
+ * Expands the macros of a source into the expanded source of the context. From here on, the
+ * allocations of the context are counted in the statistics of this source.
+ *
+ * @param context The assembler context.
+ * @param text The source.
+ * @param size The size of the source in bytes.
+ * @param diag Receives the messages of the source.
+ * @param stats Receives the statistics of the source, NULL if statistics are not collected.
+ * @return 0 on success, 1 if errors were found while expanding the macros.
+ */
+int expand_source(assembler_context* context, const char* text, size_t size, diagnostics* diag,
+                  assembly_stats* stats);
+
+/**
+ * Assembles the expanded source of the context into an object image: the code words followed by the
+ * data words, the entry and external labels and the addresses of the relocatable words.
+ *
+ * @param context The assembler context, holding an expanded source.
+ * @param image Receives the image if the source was assembled; empty otherwise. Released with object_file_free.
+ * @param diag Receives the messages of the source.
+ * @param stats Receives the statistics of the source, NULL if statistics are not collected.
+ * @return ASSEMBLED or ASSEMBLY_FAILED.
+ */
+assembly_result assemble_expanded(assembler_context* context, object_file* image, diagnostics* diag,
+                                  assembly_stats* stats);
+
+/**
+ * Expands the macros of a source and assembles it into an object image.
+ *
+ * @param context The assembler context.
+ * @param text The source.
+ * @param size The size of the source in bytes.
+ * @param image Receives the image if the source was assembled; empty otherwise. Released with object_file_free.
+ * @param diag Receives the messages of the source.
+ * @param stats Receives the statistics of the source, NULL if statistics are not collected.
+ * @return ASSEMBLED, MACRO_FAILED or ASSEMBLY_FAILED.
+ */
+assembly_result assemble_source(assembler_context* context, const char* text, size_t size, object_file* image,
+                                diagnostics* diag, assembly_stats* stats);
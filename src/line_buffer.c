@@ -0,0 +1,75 @@
+#include "line_buffer.h"
+
+#include <string.h>
+
+#include "consts.h"
+
+
+void line_buffer_init(line_buffer* buffer) {
+    vector_init(&buffer->text, sizeof(char));
+    buffer->line_count = 0;
+}
+
+int line_buffer_append_line(line_buffer* buffer, const char* line, size_t length) {
+    char* dest = (char*)vector_extend(&buffer->text, length + 1);
+
+    if (!dest) {
+        return MEMORY_ALLOCATION_FAILED;
+    }
+    memcpy(dest, line, length);
+    dest[length] = '\n';
+    buffer->line_count++;
+    return SUCCESS;
+}
+
+int line_buffer_append_lines(line_buffer* buffer, const char* text, size_t length) {
+    char* dest = (char*)vector_extend(&buffer->text, length);
+    const char* newline = text;
+    const char* end = text + length;
+
+    if (!dest) {
+        return MEMORY_ALLOCATION_FAILED;
+    }
+    memcpy(dest, text, length);
+
+    /* Every line of the block ends with a newline */
+    while ((newline = (const char*)memchr(newline, '\n', end - newline)) != NULL) {
+        buffer->line_count++;
+        newline++;
+    }
+    return SUCCESS;
+}
+
+size_t line_buffer_count(const line_buffer* buffer) {
+    return buffer->line_count;
+}
+
+int line_buffer_write_file(const line_buffer* buffer, const char* filename) {
+    FILE* file = fopen(filename, "w");
+    int result = SUCCESS;
+
+    if (!file) {
+        return 1;
+    }
+    if (fwrite(buffer->text.items, 1, buffer->text.count, file) != buffer->text.count) {
+        result = 1;
+    }
+    if (fclose(file) != 0) {
+        result = 1;
+    }
+    return result;
+}
+
+void line_buffer_clear(line_buffer* buffer) {
+    buffer->text.count = 0;
+    buffer->line_count = 0;
+}
+
+void line_buffer_track(line_buffer* buffer, alloc_counters* counters) {
+    vector_track(&buffer->text, counters);
+}
+
+void line_buffer_free(line_buffer* buffer) {
+    vector_free(&buffer->text);
+    buffer->line_count = 0;
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "vector.h"
+
+
+/* In-memory source file: the text of all lines, each terminated by '\n' exactly as it would
+ * be written to a file. The lines are read back with a `line_reader`.
+ */
+typedef struct {
+    vector text;        /* char items */
+    size_t line_count;
+} line_buffer;
+
+/**
+ * Initializes an empty line buffer.
+ * 
+ * @param buffer The line buffer to initialize.
+ */
+void line_buffer_init(line_buffer* buffer);
+
+/**
+ * Appends a single line to the buffer, adding its newline terminator.
+ * 
+ * @param buffer The line buffer.
+ * @param line The line to append (without a newline).
+ * @param length The length of the line in bytes.
+ * @return SUCCESS on success, MEMORY_ALLOCATION_FAILED on failure.
+ */
+int line_buffer_append_line(line_buffer* buffer, const char* line, size_t length);
+
+/**
+ * Appends a block of complete lines (each terminated by '\n') to the buffer.
+ * 
+ * @param buffer The line buffer.
+ * @param text The lines to append.
+ * @param length The length of the text in bytes.
+ * @return SUCCESS on success, MEMORY_ALLOCATION_FAILED on failure.
+ */
+int line_buffer_append_lines(line_buffer* buffer, const char* text, size_t length);
+
+/**
+ * @param buffer The line buffer.
+ * @return The number of lines in the buffer.
+ */
+size_t line_buffer_count(const line_buffer* buffer);
+
+/**
+ * Writes the content of the buffer to a file.
+ * 
+ * @param buffer The line buffer.
+ * @param filename The name of the file to write.
+ * @return SUCCESS on success, 1 if the file could not be written.
+ */
+int line_buffer_write_file(const line_buffer* buffer, const char* filename);
+
+/**
+ * Removes all lines from the buffer, keeping its memory for reuse.
+ * 
+ * @param buffer The line buffer to clear.
+ */
+void line_buffer_clear(line_buffer* buffer);
+
+/**
+ * Counts the allocations of the buffer in the given counters from now on. The memory the buffer
+ * already holds is counted as held there.
+ * 
+ * @param buffer The line buffer.
+ * @param counters The counters, NULL to stop counting.
+ */
+void line_buffer_track(line_buffer* buffer, alloc_counters* counters);
+
+/**
+ * Releases the memory held by the buffer and leaves it empty.
+ * 
+ * @param buffer The line buffer to free.
+ */
+void line_buffer_free(line_buffer* buffer);
@@ -0,0 +1,241 @@
+/**
+ * Line scanner: finds the blanks, quotes, commas and colons of a line in a single sweep.
+ * Each chunk of 16 characters is first classified into bit masks, one bit per character, and the
+ * sweep then visits only the quotes and commas, testing the characters between them with a mask.
+ */
+
+#include "line_scan.h"
+
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "consts.h"
+
+#define CHUNK_SIZE 16
+
+
+/* The characters of a chunk of a line, bit i stands for the i-th character */
+typedef struct {
+    unsigned long blank;
+    unsigned long quote;
+    unsigned long comma;
+    unsigned long colon;
+} chunk_masks;
+
+/**
+ * Classifies the characters of a chunk.
+ *
+ * @param text The chunk.
+ * @param count The number of characters in the chunk, at most CHUNK_SIZE.
+ * @param masks Receives the masks, without bits past the count.
+ */
+typedef void (*chunk_classifier)(const char* text, size_t count, chunk_masks* masks);
+
+/**
+ * @param from The first bit.
+ * @param to One past the last bit, at most CHUNK_SIZE.
+ * @return The mask of the bits in [from, to).
+ */
+unsigned long bit_range(size_t from, size_t to) {
+    return ((1UL << to) - 1) & ~((1UL << from) - 1);
+}
+
+/**
+ * @param mask A non-zero chunk mask.
+ * @return The index of the lowest bit set.
+ */
+size_t lowest_bit(unsigned long mask) {
+    size_t bit = 0;
+
+    if (!(mask & 0xFF)) {
+        mask >>= 8;
+        bit += 8;
+    }
+    if (!(mask & 0xF)) {
+        mask >>= 4;
+        bit += 4;
+    }
+    if (!(mask & 0x3)) {
+        mask >>= 2;
+        bit += 2;
+    }
+    return bit + !(mask & 0x1);
+}
+
+/**
+ * @param mask A non-zero chunk mask.
+ * @return The index of the highest bit set.
+ */
+size_t highest_bit(unsigned long mask) {
+    size_t bit = 0;
+
+    if (mask & 0xFF00) {
+        mask >>= 8;
+        bit += 8;
+    }
+    if (mask & 0xF0) {
+        mask >>= 4;
+        bit += 4;
+    }
+    if (mask & 0xC) {
+        mask >>= 2;
+        bit += 2;
+    }
+    return bit + ((mask & 0x2) != 0);
+}
+
+/**
+ * Classifies the characters of a chunk one at a time, with the CHAR_CLASS table.
+ */
+void classify_chunk_scalar(const char* text, size_t count, chunk_masks* masks) {
+    unsigned long bit = 1;
+    size_t i;
+
+    memset(masks, 0, sizeof(*masks));
+    for (i = 0; i < count; i++, bit <<= 1) {
+        if (IS_BLANK(text[i])) {
+            masks->blank |= bit;
+        } else if (text[i] == '"') {
+            masks->quote |= bit;
+        } else if (text[i] == ',') {
+            masks->comma |= bit;
+        } else if (text[i] == ':') {
+            masks->colon |= bit;
+        }
+    }
+}
+
+#ifdef __SSE2__
+/**
+ * Classifies the 16 characters of a chunk at once with SSE2. A partial chunk is copied into a
+ * zero padded buffer first, so nothing past the line is read (a zero byte is in no class).
+ */
+void classify_chunk_sse2(const char* text, size_t count, chunk_masks* masks) {
+    char padded[CHUNK_SIZE];
+    __m128i chunk;
+    __m128i controls;
+
+    if (count < CHUNK_SIZE) {
+        memset(padded, 0, sizeof(padded));
+        memcpy(padded, text, count);
+        text = padded;
+    }
+    chunk = _mm_loadu_si128((const __m128i*)text);
+
+    /* '\t' to '\r' are the characters c with (c - 9) <= 4 as unsigned bytes */
+    controls = _mm_subs_epu8(_mm_sub_epi8(chunk, _mm_set1_epi8(9)), _mm_set1_epi8(4));
+    controls = _mm_cmpeq_epi8(controls, _mm_setzero_si128());
+    masks->blank = (unsigned long)_mm_movemask_epi8(_mm_or_si128(controls, _mm_cmpeq_epi8(chunk, _mm_set1_epi8(' '))));
+    masks->quote = (unsigned long)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('"')));
+    masks->comma = (unsigned long)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, _mm_set1_epi8(',')));
+    masks->colon = (unsigned long)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, _mm_set1_epi8(':')));
+}
+#endif
+
+/**
+ * Takes in the non-blank characters other than quotes and commas found between two of them.
+ *
+ * @param masks The masks of the chunk.
+ * @param plain The bits of the characters.
+ * @param base The position of the chunk in the line.
+ * @param scan The scan of the line.
+ * @param after_comma Whether the last character that was not blank was a comma outside a string.
+ */
+void scan_plain(const chunk_masks* masks, unsigned long plain, size_t base, line_scan* scan, int* after_comma) {
+    unsigned long colons = masks->colon & plain;
+
+    if (scan->open_string || !plain) {
+        return;
+    }
+    *after_comma = 0;
+    if (colons && scan->colon == SCAN_NONE) {
+        scan->colon = base + lowest_bit(colons);
+    }
+}
+
+/**
+ * Scans a classified chunk.
+ *
+ * @param masks The masks of the chunk.
+ * @param count The number of characters in the chunk.
+ * @param base The position of the chunk in the line.
+ * @param scan The scan of the line.
+ * @param after_comma Whether the last character that was not blank was a comma outside a string.
+ */
+void scan_chunk(const chunk_masks* masks, size_t count, size_t base, line_scan* scan, int* after_comma) {
+    unsigned long non_blank = ~masks->blank & bit_range(0, count);
+    unsigned long plain = non_blank & ~(masks->quote | masks->comma);
+    unsigned long events = masks->quote | masks->comma;
+    size_t position = 0;
+    size_t bit;
+
+    if (non_blank) {
+        if (scan->first == SCAN_NONE) {
+            scan->first = base + lowest_bit(non_blank);
+        }
+        scan->end = base + highest_bit(non_blank) + 1;
+    }
+
+    while (events) {
+        bit = lowest_bit(events);
+        scan_plain(masks, plain & bit_range(position, bit), base, scan, after_comma);
+        if (masks->quote & (1UL << bit)) {
+            scan->open_string = !scan->open_string;
+            *after_comma = 0;
+        } else if (!scan->open_string) {
+            if (*after_comma) {
+                scan->consecutive_commas = 1;
+            }
+            *after_comma = 1;
+        }
+        position = bit + 1;
+        events &= events - 1;
+    }
+    scan_plain(masks, plain & bit_range(position, CHUNK_SIZE), base, scan, after_comma);
+}
+
+/**
+ * Scans a line chunk by chunk.
+ *
+ * @param line The line.
+ * @param length The length of the line.
+ * @param scan Receives the positions found.
+ * @param classify Classifies the characters of a chunk.
+ */
+void scan_chunks(const char* line, size_t length, line_scan* scan, chunk_classifier classify) {
+    chunk_masks masks;
+    int after_comma = 0;
+    size_t count;
+    size_t base;
+
+    scan->first = SCAN_NONE;
+    scan->end = length;
+    scan->colon = SCAN_NONE;
+    scan->consecutive_commas = 0;
+    scan->open_string = 0;
+
+    for (base = 0; base < length; base += CHUNK_SIZE) {
+        count = length - base < CHUNK_SIZE ? length - base : CHUNK_SIZE;
+        classify(line + base, count, &masks);
+        scan_chunk(&masks, count, base, scan, &after_comma);
+    }
+
+    if (scan->first == SCAN_NONE) {
+        scan->first = length;  /* a blank line */
+    }
+}
+
+void scan_line(const char* line, size_t length, line_scan* scan) {
+#ifdef __SSE2__
+    scan_chunks(line, length, scan, classify_chunk_sse2);
+#else
+    scan_chunks(line, length, scan, classify_chunk_scalar);
+#endif
+}
+
+void scan_line_scalar(const char* line, size_t length, line_scan* scan) {
+    scan_chunks(line, length, scan, classify_chunk_scalar);
+}
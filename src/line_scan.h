@@ -0,0 +1,36 @@
+#pragma once
+
+#include <stdlib.h>
+
+/* The position of a character that does not occur in a line */
+#define SCAN_NONE ((size_t)-1)
+
+/* What a single sweep over a line finds. Positions are indexes into the line. Colons and commas
+ * inside a string literal (between a pair of '"') are plain characters and are not reported.
+ */
+typedef struct {
+    size_t first;            /* the first non-blank character, the length of the line if it is blank */
+    size_t end;              /* one past the last non-blank character, equal to first if the line is blank */
+    size_t colon;            /* the first ':' outside a string literal */
+    int consecutive_commas;  /* two commas outside a string literal with only blanks between them */
+    int open_string;         /* the line ends inside a string literal */
+} line_scan;
+
+/**
+ * Scans a line in one sweep. The characters are classified 16 at a time with SSE2 when the compiler
+ * targets it, and with the CHAR_CLASS table otherwise.
+ *
+ * @param line The line (not necessarily null-terminated, nothing past its length is read).
+ * @param length The length of the line.
+ * @param scan Receives the positions found.
+ */
+void scan_line(const char* line, size_t length, line_scan* scan);
+
+/**
+ * Scans a line like scan_line, classifying the characters one at a time with the CHAR_CLASS table.
+ *
+ * @param line The line.
+ * @param length The length of the line.
+ * @param scan Receives the positions found.
+ */
+void scan_line_scalar(const char* line, size_t length, line_scan* scan);
@@ -1,7 +1,7 @@
 /*
  * Macro Processor
- * Processes files with macro definitions (as) into target files (am).
- * This program reads an input file, identifies macro definitions, and expands macro invocations in the output file.
+ * Processes sources with macro definitions (as) into expanded sources (am), kept in memory.
+ * This program reads an input file, identifies macro definitions, and expands macro invocations in the output buffer.
  * Non-fatal errors (e.g., file operation failures) are gracefully handled, which might cause additional errors to be encountered.
  *
  */
@@ -11,68 +11,181 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <ctype.h>
 
 #include "utils.h"
+#include "consts.h"
+#include "vector.h"
+#include "source_file.h"
 
-/* Assumptions regarding the length of line and amount of macros in file, their length and their name length */
-#define MAX_LINE_LENGTH 81
-#define MAX_MACROS 1000
-#define MAX_MACRO_LINES 1000
-#define MAX_MACRO_NAME_LENGTH 50
+#define INITIAL_SLOT_COUNT 64
+#define MACRO_START "mcro "
+#define MACRO_END "mcroend"
 
-/* Macro table structure */
+/* Macro structure: the name and the body are spans in the macro table arena */
 typedef struct {
-    char name[MAX_MACRO_NAME_LENGTH];
-    char lines[MAX_MACRO_LINES][MAX_LINE_LENGTH];
-    int line_count;
+    size_t name_offset;  /* offset of the null-terminated name */
+    size_t body_offset;  /* offset of the body, each line terminated by '\n' */
+    size_t body_length;  /* length of the body in bytes */
 } Macro;
 
-/* Global variables */
-Macro macro_table[MAX_MACROS];
-int macro_count = 0;
+void macro_table_init(macro_table* macros) {
+    vector_init(&macros->entries, sizeof(Macro));
+    vector_init(&macros->arena, sizeof(char));
+    macros->slots = NULL;
+    macros->slot_count = 0;
+    macros->generation = 1;
+    macros->counters = NULL;
+}
+
+void macro_table_track(macro_table* macros, alloc_counters* counters) {
+    macros->counters = counters;
+    count_held(counters, macros->slot_count * sizeof(MacroSlot));
+    vector_track(&macros->entries, counters);
+    vector_track(&macros->arena, counters);
+}
+
+void macro_table_free(macro_table* macros) {
+    vector_free(&macros->entries);
+    vector_free(&macros->arena);
+    counted_free(macros->counters, macros->slots, macros->slot_count * sizeof(MacroSlot));
+    macro_table_init(macros);
+}
+
+/**
+ * Initializes the macro table by discarding all macros of the previous file.
+ * 
+ * @param macros The macro table.
+ */
+void initialize_macro_table(macro_table* macros) {
+    macros->entries.count = 0;
+    macros->arena.count = 0;
+    macros->generation++;
+}
+
+/**
+ * @param macros The macro table.
+ * @param macro_index The index of the macro in the table.
+ * @return The name of the macro.
+ */
+const char* get_macro_name(const macro_table* macros, size_t macro_index) {
+    Macro* macro = &VECTOR_ITEMS(macros->entries, Macro)[macro_index];
+    return VECTOR_ITEMS(macros->arena, char) + macro->name_offset;
+}
+
+/**
+ * Finds the slot holding a macro name, or the empty slot where it should be inserted.
+ * 
+ * @param macros The macro table.
+ * @param name The macro name to look for (not necessarily null-terminated).
+ * @param length The length of the name.
+ * @return The index of the matching or empty slot.
+ */
+size_t find_macro_slot(const macro_table* macros, const char* name, size_t length) {
+    size_t mask = macros->slot_count - 1;
+    size_t slot = hash_bytes(name, length) & mask;
+    const char* macro_name;
+
+    while (macros->slots[slot].generation == macros->generation) {
+        macro_name = get_macro_name(macros, macros->slots[slot].macro_index);
+        if (strncmp(macro_name, name, length) == 0 && macro_name[length] == '\0') {
+            break;
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    return slot;
+}
 
 /**
- * Initializes the macro table by clearing all entries.
+ * Grows the hash index to the given number of slots and rehashes the defined macros.
+ * 
+ * @param macros The macro table.
+ * @param slot_count The new number of slots (power of two).
+ * @return 0 on success, 1 on memory allocation failure.
  */
-void initialize_macro_table() {
-    memset(macro_table, 0, sizeof(macro_table));
-    macro_count = 0;
+int rehash_macro_table(macro_table* macros, size_t slot_count) {
+    MacroSlot* new_slots = (MacroSlot*)counted_calloc(macros->counters, slot_count, sizeof(MacroSlot));
+    size_t i, slot;
+
+    if (!new_slots) {
+        return 1;
+    }
+    counted_free(macros->counters, macros->slots, macros->slot_count * sizeof(MacroSlot));
+    macros->slots = new_slots;
+    macros->slot_count = slot_count;
+    macros->generation = 1;  /* calloc leaves every slot at generation 0 (empty) */
+
+    for (i = 0; i < macros->entries.count; i++) {
+        slot = find_macro_slot(macros, get_macro_name(macros, i), strlen(get_macro_name(macros, i)));
+        macros->slots[slot].macro_index = i;
+        macros->slots[slot].generation = macros->generation;
+    }
+
+    return 0;
 }
 
 /**
  * Finds a macro by its name.
  * 
- * @param name The name of the macro to find.
+ * @param macros The macro table.
+ * @param name The name of the macro to find (not necessarily null-terminated).
+ * @param length The length of the name.
  * @return The index of the macro in the table, or -1 if not found.
  */
-int find_macro(const char* name) {
-    int i;
-    
-    for (i = 0; i < macro_count; i++) {
-        if (strcmp(macro_table[i].name, name) == 0) {
-            return i;
-        }
+int find_macro(const macro_table* macros, const char* name, size_t length) {
+    size_t slot;
+
+    if (macros->entries.count == 0) {
+        return -1;
     }
-    
-    return -1;
+
+    slot = find_macro_slot(macros, name, length);
+    if (macros->slots[slot].generation != macros->generation) {
+        return -1;
+    }
+    return (int)macros->slots[slot].macro_index;
 }
 
 /**
- * Strips newline characters ('\n' or '\r') from the end of a string.
+ * Cuts a line at its first carriage return and removes its leading and trailing whitespace.
  * 
- * @param str The string to process. The operation is performed in-place.
+ * @param line The line to trim; only the view is changed, not the text.
  */
-void strip_newline(char* str) {
-    char* p = strchr(str, '\n');
-    if (p != NULL) {
-        *p = '\0';
+void trim_line(line_view* line) {
+    const char* carriage_return = (const char*)memchr(line->text, '\r', line->length);
+
+    if (carriage_return != NULL) {
+        line->length = carriage_return - line->text;
     }
-    
-    p = strchr(str, '\r');
-    if (p != NULL) {
-        *p = '\0';
+    while (line->length > 0 && IS_BLANK(line->text[0])) {
+        line->text++;
+        line->length--;
+    }
+    while (line->length > 0 && IS_BLANK(line->text[line->length - 1])) {
+        line->length--;
+    }
+}
+
+/**
+ * Finds the next word of a line, delimited by spaces and tabs.
+ * 
+ * @param cursor The position to search from, advanced past the word.
+ * @param end The end of the line.
+ * @param length Receives the length of the word, 0 if there are no more words.
+ * @return The start of the word.
+ */
+const char* next_word(const char** cursor, const char* end, size_t* length) {
+    const char* start = *cursor;
+
+    while (start < end && (*start == ' ' || *start == '\t')) {
+        start++;
+    }
+    *cursor = start;
+    while (*cursor < end && **cursor != ' ' && **cursor != '\t') {
+        (*cursor)++;
     }
+    *length = *cursor - start;
+    return start;
 }
 
 /**
@@ -81,7 +194,7 @@ void strip_newline(char* str) {
  * @param name The macro name to validate.
  * @return 1 if the name is valid, 0 otherwise.
  */
-int is_valid_macro_name(const char* name) {
+int is_valid_macro_name(const macro_table* macros, const char* name) {
     if (name == NULL || strlen(name) == 0) {
         return 0;
     }
@@ -90,7 +203,7 @@ int is_valid_macro_name(const char* name) {
         return 0;
     }
     
-    if (find_macro(name) >= 0) {
+    if (find_macro(macros, name, strlen(name)) >= 0) {
         return 0;
     }
     
@@ -98,131 +211,143 @@ int is_valid_macro_name(const char* name) {
 }
 
 /**
- * Trims leading and trailing whitespace from a string.
+ * Appends text to the macro table arena.
  * 
- * @param str The string to trim. The operation is performed in-place.
+ * @param macros The macro table.
+ * @param text The text to append.
+ * @param length The length of the text in bytes.
+ * @param terminator The character appended after the text.
+ * @return 0 on success, 1 on memory allocation failure.
  */
-void trim_whitespace(char* str) {
-    char* start = str;
-    char* end;
-    
-    /* Find the first non-whitespace character */
-    while (isspace((unsigned char)*start)) {
-        start++;
-    }
-    
-    /* If the string is all whitespace, return an empty string */
-    if (*start == '\0') {
-        *str = '\0';
-        return;
-    }
-    
-    /* Find the last non-whitespace character */
-    end = start + strlen(start) - 1;
-    while (end > start && isspace((unsigned char)*end)) {
-        end--;
-    }
-    
-    /* Null-terminate the string after the last non-whitespace character */
-    *(end + 1) = '\0';
-    
-    /* If the string didn't start at the beginning, move it there */
-    if (start != str) {
-        memmove(str, start, strlen(start) + 1);
+int append_to_arena(macro_table* macros, const char* text, size_t length, char terminator) {
+    char* dest = (char*)vector_extend(&macros->arena, length + 1);
+    if (!dest) {
+        return 1;
     }
+    memcpy(dest, text, length);
+    dest[length] = terminator;
+    return 0;
 }
 
 /**
- * Adds a new macro to the macro table.
+ * Adds a new macro to the macro table. Its name must already be the last text in the arena.
  * 
- * @param name The name of the macro to add.
+ * @param macros The macro table.
+ * @param name_offset The offset of the null-terminated name in the arena.
+ * @return 0 on success, 1 on memory allocation failure.
  */
-void add_macro(const char* name) {
-    if (macro_count >= MAX_MACROS) {
-        printf("Error: Maximum number of macros reached\n");
-        return;
+int add_macro(macro_table* macros, size_t name_offset) {
+    Macro* macro;
+    size_t slot;
+    const char* name;
+
+    /* Keep the load factor of the hash index at or below 1/2 */
+    if ((macros->entries.count + 1) * 2 > macros->slot_count) {
+        if (rehash_macro_table(macros, macros->slot_count ? macros->slot_count * 2 : INITIAL_SLOT_COUNT)) {
+            return 1;
+        }
     }
-    
-    strcpy(macro_table[macro_count].name, name);
-    macro_table[macro_count].line_count = 0;
-    macro_count++;
+
+    macro = (Macro*)vector_push(&macros->entries);
+    if (!macro) {
+        return 1;
+    }
+    macro->name_offset = name_offset;
+    macro->body_offset = macros->arena.count;
+    macro->body_length = 0;
+
+    name = VECTOR_ITEMS(macros->arena, char) + name_offset;
+    slot = find_macro_slot(macros, name, strlen(name));
+    macros->slots[slot].macro_index = macros->entries.count - 1;
+    macros->slots[slot].generation = macros->generation;
+    return 0;
 }
 
 /**
- * Adds a line to a macro's definition.
+ * Adds a line to a macro's definition. Lines of a macro are stored contiguously,
+ * since macro definitions cannot be nested.
  * 
+ * @param macros The macro table.
  * @param macro_index The index of the macro in the table.
  * @param line The line to add to the macro.
+ * @return 0 on success, 1 on memory allocation failure.
  */
-void add_line_to_macro(int macro_index, const char* line) {
-    if (macro_index < 0 || macro_index >= macro_count) {
-        return;
+int add_line_to_macro(macro_table* macros, int macro_index, const line_view* line) {
+    Macro* macro;
+
+    if (macro_index < 0 || macro_index >= macros->entries.count) {
+        return 0;
     }
-    
-    if (macro_table[macro_index].line_count >= MAX_MACRO_LINES) {
-        printf("Error: Maximum number of lines in macro reached\n");
-        return;
+
+    if (append_to_arena(macros, line->text, line->length, '\n')) {
+        return 1;
     }
-    
-    strcpy(macro_table[macro_index].lines[macro_table[macro_index].line_count], line);
-    macro_table[macro_index].line_count++;
+    macro = &VECTOR_ITEMS(macros->entries, Macro)[macro_index];
+    macro->body_length = macros->arena.count - macro->body_offset;
+    return 0;
+}
+
+/**
+ * Appends a line to the expanded source, recording a memory allocation failure.
+ * 
+ * @param output The expanded source.
+ * @param line The line to append.
+ * @param diag The diagnostics of the file.
+ * @return 0 on success, 1 on memory allocation failure.
+ */
+int write_line(line_buffer* output, const line_view* line, diagnostics* diag) {
+    if (line_buffer_append_line(output, line->text, line->length)) {
+        report(diag, "Error: Memory allocation failed\n");
+        return 1;
+    }
+    return 0;
 }
 
-int macro_process_file(const char* input_as_file) {
-    FILE* in_file;
-    FILE* out_file;
-    char line[MAX_LINE_LENGTH];
-    char output_am_file[FILENAME_MAX];
-    char macro_name[MAX_MACRO_NAME_LENGTH];
+int macro_process_text(const char* text, size_t size, macro_table* macros, line_buffer* output, diagnostics* diag,
+                       assembly_stats* stats) {
+    line_reader reader;
+    line_view line;
+    const char* cursor;
+    const char* end;
+    const char* name;
+    size_t name_length;
+    size_t name_offset;
+    size_t extra_length;
+    char* macro_name;
     int in_macro_def = 0;
     int current_macro_index = -1;
-    char* token;
+    int macro_index;
     int is_error_encountered = 0;
+    unsigned long expansions = 0;
 
-    initialize_macro_table();
-    
-    /* Check if the file exists */
-    in_file = fopen(input_as_file, "r");
-    if (in_file == NULL) {
-        printf("File not found: %s\n", input_as_file);
-        return 1;
-    }
-    
-    /* Create output file name with .am extension */
-    copy_filename_with_different_extension(input_as_file, output_am_file, ".am");
+    initialize_macro_table(macros);
     
-    out_file = fopen(output_am_file, "w");
-    if (out_file == NULL) {
-        printf("Could not create output file: %s\n", output_am_file);
-        fclose(in_file);
-        return 1;
-    }
-    
-    /* Process the file line by line */
-    while (fgets(line, MAX_LINE_LENGTH, in_file) != NULL) {
-        strip_newline(line);
-        trim_whitespace(line);
+    /* Process the text line by line */
+    line_reader_init(&reader, text, size);
+    while (line_reader_next(&reader, &line)) {
+        diag->line_number = line.line_number;
+        trim_line(&line);
         
         /* Skip empty lines and keep them in output if not in macro definition */
-        if (strlen(line) == 0 || (line[0] == ' ' && strlen(line) == 0)) {
+        if (line.length == 0) {
             if (!in_macro_def) {
-                fprintf(out_file, "%s\n", line);
+                is_error_encountered |= write_line(output, &line, diag);
             }
             continue;
         }
         
         /* Skip comment lines but keep them in output if not in macro definition */
-        if (line[0] == ';') {
+        if (line.text[0] == ';') {
             if (!in_macro_def) {
-                fprintf(out_file, "%s\n", line);
+                is_error_encountered |= write_line(output, &line, diag);
             }
             continue;
         }
         
         /* Check if this is the start of a macro definition */
-        if (strncmp(line, "mcro ", 5) == 0) {
+        if (line.length >= strlen(MACRO_START) && strncmp(line.text, MACRO_START, strlen(MACRO_START)) == 0) {
             if (in_macro_def) {
-                printf("Error: Nested macro definitions not allowed\n");
+                report(diag, "Error: Nested macro definitions not allowed\n");
                 is_error_encountered = 1;
                 continue;
             }
@@ -230,55 +355,64 @@ int macro_process_file(const char* input_as_file) {
             in_macro_def = 1;
             
             /* Extract macro name */
-            token = strtok(line + 5, " \t");
-            if (token == NULL) {
-                printf("Error: Invalid macro definition (no name)\n");
+            cursor = line.text + strlen(MACRO_START);
+            end = line.text + line.length;
+            name = next_word(&cursor, end, &name_length);
+            if (name_length == 0) {
+                report(diag, "Error: Invalid macro definition (no name)\n");
                 is_error_encountered = 1;
                 continue;
             }
             
-            strcpy(macro_name, token);
-            
             /* Check if there are additional parameters */
-            token = strtok(NULL, " \t");
-            if (token != NULL) {
-                printf("Error: Additional parameters in macro definition line\n");
+            next_word(&cursor, end, &extra_length);
+            if (extra_length != 0) {
+                report(diag, "Error: Additional parameters in macro definition line\n");
                 is_error_encountered = 1;
                 continue;
             }
             
+            /* The name is stored in the arena, and taken back out if it is not valid */
+            name_offset = macros->arena.count;
+            if (append_to_arena(macros, name, name_length, '\0')) {
+                report(diag, "Error: Memory allocation failed\n");
+                is_error_encountered = 1;
+                in_macro_def = 0;
+                continue;
+            }
+            macro_name = VECTOR_ITEMS(macros->arena, char) + name_offset;
+
             /* Check if macro name is valid */
-            if (!is_valid_macro_name(macro_name)) {
-                printf("Error: Invalid macro name: %s\n", macro_name);
+            if (!is_valid_macro_name(macros, macro_name)) {
+                report(diag, "Error: Invalid macro name: %s\n", macro_name);
                 is_error_encountered = 1;
                 in_macro_def = 0;
+                macros->arena.count = name_offset;
                 continue;
             }
             
             /* Add macro to the table */
-            add_macro(macro_name);
-            current_macro_index = macro_count - 1;
+            if (add_macro(macros, name_offset)) {
+                report(diag, "Error: Memory allocation failed\n");
+                is_error_encountered = 1;
+                in_macro_def = 0;
+                continue;
+            }
+            current_macro_index = macros->entries.count - 1;
             
             /* Do not write macro definition to output file */
             continue;
         }
         
         /* Check if this is the end of a macro definition */
-        if (strcmp(line, "mcroend") == 0) {
+        if (line.length == strlen(MACRO_END) && strncmp(line.text, MACRO_END, line.length) == 0) {
             if (!in_macro_def) {
-                printf("Error: 'mcroend' without matching 'mcro'\n");
+                report(diag, "Error: 'mcroend' without matching 'mcro'\n");
                 is_error_encountered = 1;
-                fprintf(out_file, "%s\n", line);
+                is_error_encountered |= write_line(output, &line, diag);
                 continue;
             }
             
-            /* Check if there are additional parameters */
-            token = strtok(line + 7, " \t");
-            if (token != NULL) {
-                printf("Error: Additional parameters in macro end line\n");
-                is_error_encountered = 1;
-            }
-            
             in_macro_def = 0;
             current_macro_index = -1;
             
@@ -288,37 +422,56 @@ int macro_process_file(const char* input_as_file) {
         
         if (in_macro_def) {
             /* Add line to the current macro */
-            add_line_to_macro(current_macro_index, line);
+            if (add_line_to_macro(macros, current_macro_index, &line)) {
+                report(diag, "Error: Memory allocation failed\n");
+                is_error_encountered = 1;
+            }
         } else {
             /* Check if this line is a macro invocation */
-            int macro_index = find_macro(line);
+            macro_index = find_macro(macros, line.text, line.length);
             if (macro_index >= 0) {
                 /* Replace macro invocation with its content */
-                int i;
-                for (i = 0; i < macro_table[macro_index].line_count; i++) {
-                    fprintf(out_file, "%s\n", macro_table[macro_index].lines[i]);
+                Macro* macro = &VECTOR_ITEMS(macros->entries, Macro)[macro_index];
+                expansions++;
+                if (line_buffer_append_lines(output, VECTOR_ITEMS(macros->arena, char) + macro->body_offset, macro->body_length)) {
+                    report(diag, "Error: Memory allocation failed\n");
+                    is_error_encountered = 1;
                 }
             } else {
                 /* Write the line to the output file as is */
-                fprintf(out_file, "%s\n", line);
+                is_error_encountered |= write_line(output, &line, diag);
             }
         }
     }
     
     /* Check if we ended in a macro definition */
+    diag->line_number = 0;
     if (in_macro_def) {
-        printf("Warning: File ended in macro definition\n");
+        report(diag, "Warning: File ended in macro definition\n");
         is_error_encountered = 1;
     }
-    
-    fclose(in_file);
-    fclose(out_file);
 
-    if (is_error_encountered) {
-        if (remove(output_am_file) != 0) {
-            printf("Warning: Could not remove output file after error\n");
-        }
+    if (stats) {
+        stats->lines_read += reader.line_number;
+        stats->macros_defined += macros->entries.count;
+        stats->macros_expanded += expansions;
     }
     
     return is_error_encountered;
 }
+
+int macro_process_file(const char* input_as_file, macro_table* macros, line_buffer* output, diagnostics* diag,
+                       assembly_stats* stats) {
+    source_file input;
+    int result;
+
+    /* Check if the file exists */
+    if (source_file_open(&input, input_as_file)) {
+        report(diag, "File not found: %s\n", input_as_file);
+        return 1;
+    }
+
+    result = macro_process_text(input.data, input.size, macros, output, diag, stats);
+    source_file_close(&input);
+    return result;
+}
@@ -1,9 +1,75 @@
 #pragma once
 
+#include "vector.h"
+#include "line_buffer.h"
+#include "diagnostics.h"
+#include "stats.h"
+
+/* Hash index slot, valid only if its generation matches the table's generation */
+typedef struct {
+    size_t macro_index;
+    unsigned long generation;
+} MacroSlot;
+
+/* Macro table structure. Each file being processed at the same time needs its own table.
+ * Memory is allocated lazily on the first definition and kept between files; a reset only
+ * bumps the generation so it does not depend on the table size.
+ */
+typedef struct {
+    vector entries;           /* macro items, in definition order */
+    vector arena;             /* char items holding macro names and bodies */
+    MacroSlot* slots;         /* open-addressing hash index on the macro names */
+    size_t slot_count;        /* number of slots, always a power of two */
+    unsigned long generation;
+    alloc_counters* counters; /* where the allocations are counted, NULL if they are not */
+} macro_table;
+
+/**
+ * Initializes an empty macro table.
+ * 
+ * @param macros The macro table to initialize.
+ */
+void macro_table_init(macro_table* macros);
+
+/**
+ * Counts the allocations of a macro table in the given counters from now on. The memory the table
+ * already holds (e.g., kept from the previous file) is counted as held there.
+ * 
+ * @param macros The macro table.
+ * @param counters The counters, NULL to stop counting.
+ */
+void macro_table_track(macro_table* macros, alloc_counters* counters);
+
+/**
+ * Releases the memory held by a macro table.
+ * 
+ * @param macros The macro table to free.
+ */
+void macro_table_free(macro_table* macros);
+
+/**
+ * Processes a source held in memory, expanding macros and appending the result to an in-memory buffer.
+ * 
+ * @param text The source with macros.
+ * @param size The size of the source in bytes.
+ * @param macros The macro table used for the source (reset before processing).
+ * @param output The buffer receiving the expanded source (the content of the .am file).
+ * @param diag The diagnostics of the source.
+ * @param stats Receives the line and macro counts of the source, NULL if statistics are not collected.
+ * @return 0 on success, non-zero on error.
+ */
+int macro_process_text(const char* text, size_t size, macro_table* macros, line_buffer* output, diagnostics* diag,
+                       assembly_stats* stats);
+
 /**
- * Processes a single file, expanding macros and writing the result to an output file.
+ * Processes a single file, expanding macros and appending the result to an in-memory buffer.
  * 
  * @param input_as_file The path to the input file with macros.
+ * @param macros The macro table used for the file (reset before processing).
+ * @param output The buffer receiving the expanded source (the content of the .am file).
+ * @param diag The diagnostics of the file.
+ * @param stats Receives the line and macro counts of the file, NULL if statistics are not collected.
  * @return 0 on success, non-zero on error (e.g., file operation failure).
  */
-int macro_process_file(const char* input_file);
+int macro_process_file(const char* input_as_file, macro_table* macros, line_buffer* output, diagnostics* diag,
+                       assembly_stats* stats);
@@ -1,36 +1,174 @@
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
-#include "utils.h"
 #include "consts.h"
-#include "assembler.h"
-#include "macro_processor.h"
+#include "batch.h"
+#include "server.h"
+#include "server_protocol.h"
+#include "stream.h"
 
 #define MINIMUM_ARGS 2
+#define EMIT_AM_FLAG "--emit-am"
+#define JOBS_FLAG "-j"
+#define STATS_FLAG "--stats"
+#define JSON_STATS_FLAG "--stats=json"
+#define BINARY_FLAG "--binary"
+#define CACHE_DIR_FLAG "--cache-dir"
+#define CACHE_SIZE_FLAG "--cache-size"
+#define SERVER_FLAG "--server"
+#define STREAM_FLAG "--stream"
 
 
-int main(int argc, char* argv[]) {
-    int i, result;
-    char as_file[FILENAME_MAX];
-    char am_file[FILENAME_MAX];
-    
-    if (argc < MINIMUM_ARGS) {
-        printf("Usage: %s <file1> [file2] [file3] ...\n", argv[0]);
-        return NO_INPUT_FILES;
+/**
+ * Prints the usage of the assembler.
+ *
+ * @param program_name The name the assembler was invoked with.
+ */
+void print_usage(const char* program_name) {
+    printf("Usage: %s [%s] [%s] [%s N] [%s | %s] [%s DIR [%s MB]] <file1> [file2] [file3] ...\n", program_name,
+           EMIT_AM_FLAG, BINARY_FLAG, JOBS_FLAG, STATS_FLAG, JSON_STATS_FLAG, CACHE_DIR_FLAG, CACHE_SIZE_FLAG);
+    printf("       %s %s   (serve requests of tools/assembler_client on $%s, $%s/%s by default)\n", program_name,
+           SERVER_FLAG, ASSEMBLER_SOCKET_VARIABLE, RUNTIME_DIRECTORY_VARIABLE, SERVER_SOCKET_NAME);
+    printf("       %s %s [%s] [%s] [%s N] [%s | %s]   (assemble the standard input into a result stream on the standard output)\n",
+           program_name, STREAM_FLAG, EMIT_AM_FLAG, BINARY_FLAG, JOBS_FLAG, STATS_FLAG, JSON_STATS_FLAG);
+}
+
+/**
+ * Parses the number of jobs given to the -j option.
+ *
+ * @param value The option value.
+ * @return The number of jobs, or 0 if the value is not a positive number.
+ */
+int parse_jobs(const char* value) {
+    char* end;
+    long jobs;
+
+    if (value == NULL) {
+        return 0;
+    }
+    jobs = strtol(value, &end, 10);
+    if (end == value || *end != '\0' || jobs < 1 || jobs > 1024) {
+        return 0;
+    }
+    return (int)jobs;
+}
+
+/**
+ * Parses the size given to the --cache-size option.
+ *
+ * @param value The option value.
+ * @return The size in megabytes, or 0 if the value is not a positive number.
+ */
+unsigned long parse_size(const char* value) {
+    char* end;
+    unsigned long size;
+
+    if (value == NULL || *value == '-') {
+        return 0;
+    }
+    size = strtoul(value, &end, 10);
+    if (end == value || *end != '\0' || size > 1024UL * 1024) {
+        return 0;
+    }
+    return size;
+}
+
+/**
+ * Assembles the files of a command line.
+ *
+ * @param argc The number of arguments.
+ * @param argv The arguments, the program name first.
+ * @param tables The tables kept between runs by the server, NULL for a single run.
+ * @return The exit status.
+ */
+int run_assembler(int argc, char* argv[], batch_tables* tables) {
+    int i;
+    int file_count = 0;
+    int stream = 0;
+    char** files;
+    assembler_options options;
+
+    options.emit_am = 0;
+    options.jobs = 1;
+    options.format = TEXT_OBJECT;
+    options.stats = NO_STATS;
+    options.cache_dir = NULL;
+    options.cache_size = DEFAULT_CACHE_SIZE_MB;
+
+    files = (char**)malloc(argc * sizeof(char*));
+    if (!files) {
+        printf("Error: Memory allocation failed.\n");
+        return MEMORY_ALLOCATION_FAILED;
     }
-    
+
+    /* Options may appear anywhere in the arguments */
     for (i = 1; i < argc; i++) {
-        /* macro process files*/
-        copy_filename_with_different_extension(argv[i], as_file, ".as");
-        printf("### Starting processing on file %s ###\n", as_file);
-        result = macro_process_file(as_file);
-        /* assemble files */
-        if (result) {
-            continue;
+        if (!strcmp(argv[i], EMIT_AM_FLAG)) {
+            options.emit_am = 1;
+        } else if (!strcmp(argv[i], STREAM_FLAG)) {
+            stream = 1;
+        } else if (!strcmp(argv[i], BINARY_FLAG)) {
+            options.format = BINARY_OBJECT;
+        } else if (!strcmp(argv[i], STATS_FLAG)) {
+            options.stats = TEXT_STATS;
+        } else if (!strcmp(argv[i], JSON_STATS_FLAG)) {
+            options.stats = JSON_STATS;
+        } else if (!strcmp(argv[i], CACHE_DIR_FLAG)) {
+            options.cache_dir = argv[++i];
+            if (!options.cache_dir) {
+                printf("Error: %s expects a directory.\n", CACHE_DIR_FLAG);
+                free(files);
+                return NO_INPUT_FILES;
+            }
+        } else if (!strcmp(argv[i], CACHE_SIZE_FLAG)) {
+            options.cache_size = parse_size(argv[++i]);
+            if (!options.cache_size) {
+                printf("Error: %s expects a positive size in megabytes.\n", CACHE_SIZE_FLAG);
+                free(files);
+                return NO_INPUT_FILES;
+            }
+        } else if (!strncmp(argv[i], JOBS_FLAG, strlen(JOBS_FLAG))) {
+            /* both "-j N" and "-jN" are accepted */
+            options.jobs = parse_jobs(argv[i][strlen(JOBS_FLAG)] ? argv[i] + strlen(JOBS_FLAG) : argv[++i]);
+            if (!options.jobs) {
+                printf("Error: %s expects a positive number of jobs.\n", JOBS_FLAG);
+                free(files);
+                return NO_INPUT_FILES;
+            }
+        } else {
+            files[file_count++] = argv[i];
+        }
+    }
+
+    if (stream) {
+        free(files);
+        if (file_count > 0 || options.cache_dir) {
+            printf("Error: %s reads a single source from the standard input, without files or a cache.\n", STREAM_FLAG);
+            return NO_INPUT_FILES;
+        }
+        if (tables) {
+            printf("Error: %s is not available through the assembler server.\n", STREAM_FLAG);
+            return NO_INPUT_FILES;
         }
-        copy_filename_with_different_extension(argv[i], am_file, ".am");
-        assemble(am_file);
-        printf("### Finished processing on file %s ###\n", as_file);
+        return assemble_stream(&options);
+    }
+
+    if (argc < MINIMUM_ARGS || file_count == 0) {
+        print_usage(argv[0]);
+        free(files);
+        return NO_INPUT_FILES;
     }
 
+    assemble_files(files, file_count, &options, tables);
+
+    free(files);
     return SUCCESS;
-}
\ No newline at end of file
+}
+
+int main(int argc, char* argv[]) {
+    if (argc == 2 && !strcmp(argv[1], SERVER_FLAG)) {
+        return run_server(server_socket_path(), run_assembler);
+    }
+    return run_assembler(argc, argv, NULL);
+}
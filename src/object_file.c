@@ -0,0 +1,376 @@
+/**
+ * Object file formats: the lines of the text .obj/.ent/.ext files, and the reader and writer of the
+ * binary object format, which converts a binary object back to the text files byte for byte.
+ */
+
+#include "object_file.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "consts.h"
+#include "utils.h"
+
+
+void object_append_u32(output_buffer* output, unsigned long value) {
+    char bytes[4];
+
+    bytes[0] = (char)(value & 0xFF);
+    bytes[1] = (char)((value >> 8) & 0xFF);
+    bytes[2] = (char)((value >> 16) & 0xFF);
+    bytes[3] = (char)((value >> 24) & 0xFF);
+    output_append(output, bytes, sizeof(bytes));
+}
+
+void object_append_word(output_buffer* output, unsigned long value) {
+    char bytes[BINARY_WORD_SIZE];
+
+    bytes[0] = (char)(value & 0xFF);
+    bytes[1] = (char)((value >> 8) & 0xFF);
+    bytes[2] = (char)((value >> 16) & 0xFF);
+    output_append(output, bytes, sizeof(bytes));
+}
+
+void append_obj_line(output_buffer* output, unsigned long address, unsigned int value) {
+    output_append_decimal(output, address, 7, '0');
+    output_append_char(output, ' ');
+    output_append_hex(output, value, 6);
+    output_append_char(output, '\n');
+}
+
+void append_label_line(output_buffer* output, const char* label_name, unsigned long address) {
+    output_append_string(output, label_name);
+    output_append_char(output, ' ');
+    output_append_decimal(output, address, 7, '0');
+    output_append_char(output, '\n');
+}
+
+/**
+ * @param bytes The bytes to read.
+ * @return The unsigned 32-bit little-endian number at the start of the bytes.
+ */
+unsigned long read_u32(const unsigned char* bytes) {
+    return (unsigned long)bytes[0] | ((unsigned long)bytes[1] << 8) |
+           ((unsigned long)bytes[2] << 16) | ((unsigned long)bytes[3] << 24);
+}
+
+/**
+ * @param bytes The bytes to read.
+ * @return The 24-bit little-endian word at the start of the bytes.
+ */
+unsigned long read_word(const unsigned char* bytes) {
+    return (unsigned long)bytes[0] | ((unsigned long)bytes[1] << 8) | ((unsigned long)bytes[2] << 16);
+}
+
+/**
+ * Reads a section of labels, checking that every name is inside the string table.
+ *
+ * @param bytes The start of the section.
+ * @param count The number of labels.
+ * @param strings The string table.
+ * @param strings_size The size of the string table.
+ * @param symbols Receives the labels.
+ * @return SUCCESS on success, 1 if a name is outside the string table.
+ */
+int read_symbols(const unsigned char* bytes, unsigned long count, const char* strings, unsigned long strings_size,
+                 object_symbol* symbols) {
+    unsigned long i;
+    unsigned long name_offset;
+
+    for (i = 0; i < count; i++, bytes += BINARY_SYMBOL_SIZE) {
+        name_offset = read_u32(bytes);
+        if (name_offset >= strings_size) {
+            return 1;
+        }
+        symbols[i].name = strings + name_offset;
+        symbols[i].address = read_u32(bytes + 4);
+    }
+    return SUCCESS;
+}
+
+/**
+ * @param count The number of elements of an array.
+ * @param element_size The size of an element.
+ * @return The size of the array, with at least one element so an empty array is not mistaken for a failure.
+ */
+size_t array_bytes(unsigned long count, size_t element_size) {
+    return (count ? count : 1) * element_size;
+}
+
+/**
+ * Allocates an array, with at least one element.
+ *
+ * @param object The object file the array belongs to.
+ * @param count The number of elements.
+ * @param element_size The size of an element.
+ * @return The array, or NULL on memory allocation failure.
+ */
+void* allocate_array(object_file* object, unsigned long count, size_t element_size) {
+    return counted_malloc(object->counters, array_bytes(count, element_size));
+}
+
+int object_file_allocate(object_file* object) {
+    object->words = (unsigned long*)allocate_array(object, object->word_count, sizeof(unsigned long));
+    object->entries = (object_symbol*)allocate_array(object, object->entry_count, sizeof(object_symbol));
+    object->externals = (object_symbol*)allocate_array(object, object->extern_count, sizeof(object_symbol));
+    object->relocations = (unsigned long*)allocate_array(object, object->relocation_count, sizeof(unsigned long));
+    if (!object->words || !object->entries || !object->externals || !object->relocations) {
+        return MEMORY_ALLOCATION_FAILED;
+    }
+    return SUCCESS;
+}
+
+/**
+ * Decodes the sections of a binary object file whose header was read.
+ *
+ * @param object The object file, with its header fields set.
+ * @param bytes The content of the file.
+ * @param strings_size The size of the string table.
+ * @return SUCCESS on success, 1 if the file is not a valid binary object file.
+ */
+int read_sections(object_file* object, const unsigned char* bytes, unsigned long strings_size) {
+    const unsigned char* words = bytes + BINARY_HEADER_SIZE;
+    const unsigned char* entries = words + object->word_count * BINARY_WORD_SIZE;
+    const unsigned char* externals = entries + object->entry_count * BINARY_SYMBOL_SIZE;
+    const unsigned char* relocations = externals + object->extern_count * BINARY_SYMBOL_SIZE;
+    const char* strings = (const char*)(relocations + object->relocation_count * 4);
+    unsigned long code_count = object->ICF - object->base_address;
+    unsigned long i;
+
+    if (strings_size && strings[strings_size - 1] != '\0') {
+        return 1;
+    }
+    if (object_file_allocate(object)) {
+        return 1;
+    }
+
+    for (i = 0; i < object->word_count; i++) {
+        object->words[i] = read_word(words + i * BINARY_WORD_SIZE);
+        /* data words are sign extended, as the assembler holds them */
+        if (i >= code_count && (object->words[i] & WORD_SIGN_BIT)) {
+            object->words[i] |= ~WORD_MASK;
+        }
+    }
+    for (i = 0; i < object->relocation_count; i++) {
+        object->relocations[i] = read_u32(relocations + i * 4);
+    }
+    if (read_symbols(entries, object->entry_count, strings, strings_size, object->entries) ||
+        read_symbols(externals, object->extern_count, strings, strings_size, object->externals)) {
+        return 1;
+    }
+    return SUCCESS;
+}
+
+/**
+ * Takes the bytes of a section out of the bytes left in the file.
+ *
+ * @param remaining The number of bytes left, reduced by the size of the section.
+ * @param count The number of items in the section.
+ * @param item_size The size of an item.
+ * @return 1 if the section fits in the file, 0 otherwise.
+ */
+int take_section(unsigned long* remaining, unsigned long count, unsigned long item_size) {
+    if (count > *remaining / item_size) {
+        return 0;
+    }
+    *remaining -= count * item_size;
+    return 1;
+}
+
+int object_file_read(object_file* object, const char* filename) {
+    const unsigned char* bytes;
+    unsigned long strings_size;
+    unsigned long remaining;
+
+    memset(object, 0, sizeof(*object));
+    if (source_file_open(&object->file, filename)) {
+        return 1;
+    }
+
+    bytes = (const unsigned char*)object->file.data;
+    if (object->file.size < BINARY_HEADER_SIZE || memcmp(bytes, BINARY_OBJECT_MAGIC, 4) != 0 ||
+        read_u32(bytes + 4) != BINARY_OBJECT_VERSION) {
+        object_file_free(object);
+        return 1;
+    }
+    object->base_address = read_u32(bytes + 8);
+    object->ICF = read_u32(bytes + 12);
+    object->DCF = read_u32(bytes + 16);
+    object->entry_count = read_u32(bytes + 20);
+    object->extern_count = read_u32(bytes + 24);
+    object->relocation_count = read_u32(bytes + 28);
+    strings_size = read_u32(bytes + 32);
+    object->word_count = object->ICF - object->base_address + object->DCF;
+
+    /* The sections described by the header must fill the rest of the file exactly */
+    remaining = object->file.size - BINARY_HEADER_SIZE;
+    if (object->ICF < object->base_address || object->word_count < object->DCF ||
+        !take_section(&remaining, object->word_count, BINARY_WORD_SIZE) ||
+        !take_section(&remaining, object->entry_count, BINARY_SYMBOL_SIZE) ||
+        !take_section(&remaining, object->extern_count, BINARY_SYMBOL_SIZE) ||
+        !take_section(&remaining, object->relocation_count, 4) ||
+        remaining != strings_size || read_sections(object, bytes, strings_size)) {
+        object_file_free(object);
+        return 1;
+    }
+    return SUCCESS;
+}
+
+void object_file_free(object_file* object) {
+    counted_free(object->counters, object->words, array_bytes(object->word_count, sizeof(unsigned long)));
+    counted_free(object->counters, object->entries, array_bytes(object->entry_count, sizeof(object_symbol)));
+    counted_free(object->counters, object->externals, array_bytes(object->extern_count, sizeof(object_symbol)));
+    counted_free(object->counters, object->relocations,
+                 array_bytes(object->relocation_count, sizeof(unsigned long)));
+    if (object->file.data && !object->file.mapped) {
+        /* the string table of an object built in memory, allocated with at least one byte */
+        count_frees(object->counters, 1, object->file.size ? object->file.size : 1);
+    }
+    object->words = NULL;
+    object->entries = NULL;
+    object->externals = NULL;
+    object->relocations = NULL;
+    source_file_close(&object->file);
+}
+
+/**
+ * Appends a section of labels, numbering their names in the order they follow in the string table.
+ *
+ * @param output The output buffer.
+ * @param symbols The labels.
+ * @param count The number of labels.
+ * @param name_offset The offset of the first name in the string table, advanced past the names.
+ */
+void append_symbols(output_buffer* output, const object_symbol* symbols, unsigned long count,
+                    unsigned long* name_offset) {
+    unsigned long i;
+
+    for (i = 0; i < count; i++) {
+        object_append_u32(output, *name_offset);
+        object_append_u32(output, symbols[i].address);
+        *name_offset += strlen(symbols[i].name) + 1;
+    }
+}
+
+/**
+ * @param object The object file.
+ * @return The size of the string table of its binary object file.
+ */
+unsigned long binary_strings_size(const object_file* object) {
+    unsigned long strings_size = 0;
+    unsigned long i;
+
+    for (i = 0; i < object->entry_count; i++) {
+        strings_size += strlen(object->entries[i].name) + 1;
+    }
+    for (i = 0; i < object->extern_count; i++) {
+        strings_size += strlen(object->externals[i].name) + 1;
+    }
+    return strings_size;
+}
+
+unsigned long object_binary_size(const object_file* object) {
+    return BINARY_HEADER_SIZE + object->word_count * BINARY_WORD_SIZE +
+           (object->entry_count + object->extern_count) * BINARY_SYMBOL_SIZE + object->relocation_count * 4 +
+           binary_strings_size(object);
+}
+
+void object_append_binary(output_buffer* output, const object_file* object) {
+    unsigned long strings_size = binary_strings_size(object);
+    unsigned long i;
+
+    output_append(output, BINARY_OBJECT_MAGIC, 4);
+    object_append_u32(output, BINARY_OBJECT_VERSION);
+    object_append_u32(output, object->base_address);
+    object_append_u32(output, object->ICF);
+    object_append_u32(output, object->DCF);
+    object_append_u32(output, object->entry_count);
+    object_append_u32(output, object->extern_count);
+    object_append_u32(output, object->relocation_count);
+    object_append_u32(output, strings_size);
+
+    for (i = 0; i < object->word_count; i++) {
+        object_append_word(output, object->words[i]);
+    }
+    strings_size = 0;
+    append_symbols(output, object->entries, object->entry_count, &strings_size);
+    append_symbols(output, object->externals, object->extern_count, &strings_size);
+    for (i = 0; i < object->relocation_count; i++) {
+        object_append_u32(output, object->relocations[i]);
+    }
+    for (i = 0; i < object->entry_count; i++) {
+        output_append(output, object->entries[i].name, strlen(object->entries[i].name) + 1);
+    }
+    for (i = 0; i < object->extern_count; i++) {
+        output_append(output, object->externals[i].name, strlen(object->externals[i].name) + 1);
+    }
+}
+
+int object_file_write(const object_file* object, const char* filename) {
+    output_buffer output;
+    int result;
+
+    output_buffer_init_counted(&output, object_binary_size(object), object->counters);
+    object_append_binary(&output, object);
+    result = output_buffer_write_file(&output, filename);
+    output_buffer_free(&output);
+    return result;
+}
+
+/**
+ * Writes an output buffer to the file with the given extension.
+ *
+ * @param filename The name of the binary object file.
+ * @param extension The extension of the text file.
+ * @param output The content of the file, freed after writing.
+ * @return SUCCESS on success, 1 if the file could not be written.
+ */
+int write_text_file(const char* filename, const char* extension, output_buffer* output) {
+    char output_filename[FILENAME_MAX];
+    int result;
+
+    copy_filename_with_different_extension(filename, output_filename, extension);
+    result = output_buffer_write_file(output, output_filename);
+    output_buffer_free(output);
+    return result;
+}
+
+void object_append_obj_text(output_buffer* output, const object_file* object) {
+    unsigned long i;
+
+    output_append_decimal(output, object->ICF - object->base_address, 7, ' ');
+    output_append_char(output, ' ');
+    output_append_decimal(output, object->DCF, 0, ' ');
+    output_append_char(output, '\n');
+    for (i = 0; i < object->word_count; i++) {
+        /* data words are printed sign extended, as "%06X" prints an int */
+        append_obj_line(output, object->base_address + i, (unsigned int)object->words[i]);
+    }
+}
+
+void object_append_labels_text(output_buffer* output, const object_symbol* symbols, unsigned long count) {
+    unsigned long i;
+
+    for (i = 0; i < count; i++) {
+        append_label_line(output, symbols[i].name, symbols[i].address);
+    }
+}
+
+int object_file_write_text(const object_file* object, const char* filename) {
+    output_buffer output;
+    int result = SUCCESS;
+
+    output_buffer_init_counted(&output, (object->word_count + 1) * OBJ_LINE_SIZE, object->counters);
+    object_append_obj_text(&output, object);
+    result |= write_text_file(filename, ".obj", &output);
+
+    output_buffer_init_counted(&output, 0, object->counters);
+    object_append_labels_text(&output, object->entries, object->entry_count);
+    result |= write_text_file(filename, ".ent", &output);
+
+    output_buffer_init_counted(&output, 0, object->counters);
+    object_append_labels_text(&output, object->externals, object->extern_count);
+    result |= write_text_file(filename, ".ext", &output);
+
+    return result;
+}
@@ -0,0 +1,169 @@
+#pragma once
+
+#include <stdlib.h>
+
+#include "output_buffer.h"
+#include "source_file.h"
+
+/* The format of the assembled program */
+typedef enum {
+    TEXT_OBJECT,   /* .obj, .ent and .ext text files */
+    BINARY_OBJECT  /* a single binary object file */
+} object_format;
+
+#define BINARY_OBJECT_EXTENSION ".bin"
+#define OBJ_LINE_SIZE 15  /* "%07d %06X\n" */
+
+/* Layout of a binary object file, all numbers little-endian:
+ *   header      BINARY_HEADER_SIZE bytes, 9 unsigned 32-bit fields:
+ *               magic "AOBJ", version, base address, ICF, DCF,
+ *               entry count, extern count, relocation count, string table size
+ *   code        (ICF - base address) words of BINARY_WORD_SIZE bytes
+ *   data        DCF words of BINARY_WORD_SIZE bytes
+ *   entries     per entry label: name offset, address (32-bit each)
+ *   externs     per use of an external label: name offset, address (32-bit each)
+ *   relocations per relocatable code word: its address (32-bit)
+ *   strings     the null-terminated label names
+ * Entries are in symbol table order and externs in order of use, as in the .ent and .ext files.
+ */
+#define BINARY_OBJECT_MAGIC "AOBJ"
+#define BINARY_OBJECT_VERSION 1
+#define BINARY_HEADER_SIZE 36
+#define BINARY_WORD_SIZE 3
+#define BINARY_SYMBOL_SIZE 8
+
+#define WORD_MASK 0xFFFFFFUL
+#define WORD_SIGN_BIT 0x800000UL
+#define RELOCATABLE_BIT 0x2UL  /* the R bit of the A,R,E field */
+
+/* A label of a binary object file */
+typedef struct {
+    const char* name;  /* points into the string table */
+    unsigned long address;
+} object_symbol;
+
+/* An object file in memory: read from a binary object file, or built by the assembler.
+ * The label names point into the string table held in `file`.
+ */
+typedef struct {
+    source_file file;             /* the content of the file, or the string table of an object built in memory */
+    unsigned long base_address;
+    unsigned long ICF;
+    unsigned long DCF;
+    unsigned long word_count;     /* code words followed by data words, the data words sign extended */
+    unsigned long* words;
+    unsigned long entry_count;
+    object_symbol* entries;
+    unsigned long extern_count;
+    object_symbol* externals;
+    unsigned long relocation_count;
+    unsigned long* relocations;   /* addresses of the relocatable code words */
+    alloc_counters* counters;     /* where the arrays and the output buffers are counted, NULL if they are not */
+} object_file;
+
+/**
+ * Appends an unsigned 32-bit little-endian number.
+ *
+ * @param output The output buffer.
+ * @param value The number to append.
+ */
+void object_append_u32(output_buffer* output, unsigned long value);
+
+/**
+ * Appends a 24-bit word as BINARY_WORD_SIZE little-endian bytes.
+ *
+ * @param output The output buffer.
+ * @param value The word to append.
+ */
+void object_append_word(output_buffer* output, unsigned long value);
+
+/**
+ * Appends a line of the text object file: a zero padded address and the word in hexadecimal.
+ *
+ * @param output The output buffer.
+ * @param address The address of the word.
+ * @param value The value of the word.
+ */
+void append_obj_line(output_buffer* output, unsigned long address, unsigned int value);
+
+/**
+ * Appends a line of the entries or externals file: a label name and a zero padded address.
+ *
+ * @param output The output buffer.
+ * @param label_name The label name.
+ * @param address The address.
+ */
+void append_label_line(output_buffer* output, const char* label_name, unsigned long address);
+
+/**
+ * Reads and validates a binary object file.
+ *
+ * @param object The object file to fill.
+ * @param filename The name of the binary object file.
+ * @return SUCCESS on success, 1 if the file could not be read or is not a valid binary object file.
+ */
+int object_file_read(object_file* object, const char* filename);
+
+/**
+ * Allocates the words, labels and relocations of an object file from their counts.
+ *
+ * @param object The object file, with its counts and counters set.
+ * @return SUCCESS on success, MEMORY_ALLOCATION_FAILED on failure (the object is then freed with object_file_free).
+ */
+int object_file_allocate(object_file* object);
+
+/**
+ * Releases an object file held in memory.
+ *
+ * @param object The object file to free.
+ */
+void object_file_free(object_file* object);
+
+/**
+ * Writes an object file held in memory as a binary object file.
+ *
+ * @param object The object file; its words, labels and relocations are written, its `file` is not used.
+ * @param filename The name of the binary object file.
+ * @return SUCCESS on success, 1 if the file could not be written.
+ */
+int object_file_write(const object_file* object, const char* filename);
+
+/**
+ * @param object An object file held in memory.
+ * @return The size of its binary object file in bytes.
+ */
+unsigned long object_binary_size(const object_file* object);
+
+/**
+ * Appends the content of the binary object file of an object file.
+ *
+ * @param output The output buffer.
+ * @param object The object file; its words, labels and relocations are written, its `file` is not used.
+ */
+void object_append_binary(output_buffer* output, const object_file* object);
+
+/**
+ * Appends the content of the .obj text file of an object file: the code and data sizes, then a line per word.
+ *
+ * @param output The output buffer.
+ * @param object The object file.
+ */
+void object_append_obj_text(output_buffer* output, const object_file* object);
+
+/**
+ * Appends the content of the .ent or .ext text file of an object file: a line per label.
+ *
+ * @param output The output buffer.
+ * @param symbols The entry or external labels.
+ * @param count The number of labels.
+ */
+void object_append_labels_text(output_buffer* output, const object_symbol* symbols, unsigned long count);
+
+/**
+ * Writes a binary object file as the .obj, .ent and .ext text files the assembler writes for the same source.
+ *
+ * @param object The object file.
+ * @param filename The name of the binary object file, used to name the text files.
+ * @return SUCCESS on success, 1 if a file could not be written.
+ */
+int object_file_write_text(const object_file* object, const char* filename);
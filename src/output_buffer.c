@@ -0,0 +1,127 @@
+/**
+ * Output buffer implementation.
+ * Decimal numbers are converted two digits at a time and hexadecimal numbers one digit at a time,
+ * using lookup tables, straight into the buffer.
+ */
+
+#include "output_buffer.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "consts.h"
+
+#define MAX_NUMBER_DIGITS 24
+
+/* "00" "01" ... "99" */
+static const char DECIMAL_PAIRS[] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+static const char HEX_DIGITS[] = "0123456789ABCDEF";
+
+
+int output_buffer_init(output_buffer* output, size_t size_hint) {
+    return output_buffer_init_counted(output, size_hint, NULL);
+}
+
+int output_buffer_init_counted(output_buffer* output, size_t size_hint, alloc_counters* counters) {
+    vector_init(&output->text, sizeof(char));
+    vector_track(&output->text, counters);
+    output->failed = 0;
+    return vector_reserve(&output->text, size_hint);
+}
+
+/**
+ * Appends characters to the buffer, remembering a memory allocation failure for the final write.
+ * 
+ * @param output The output buffer.
+ * @param chars The characters to append.
+ * @param length The number of characters.
+ */
+void output_append(output_buffer* output, const char* chars, size_t length) {
+    char* dest = (char*)vector_extend(&output->text, length);
+    if (!dest) {
+        output->failed = 1;
+        return;
+    }
+    memcpy(dest, chars, length);
+}
+
+void output_append_string(output_buffer* output, const char* str) {
+    output_append(output, str, strlen(str));
+}
+
+void output_append_char(output_buffer* output, char c) {
+    output_append(output, &c, 1);
+}
+
+void output_append_decimal(output_buffer* output, unsigned long value, int width, char pad) {
+    char digits[MAX_NUMBER_DIGITS];
+    char* start = digits + sizeof(digits);
+    const char* pair;
+
+    /* Convert from the end, two digits at a time */
+    while (value >= 100) {
+        pair = DECIMAL_PAIRS + (value % 100) * 2;
+        value /= 100;
+        *--start = pair[1];
+        *--start = pair[0];
+    }
+    if (value >= 10) {
+        pair = DECIMAL_PAIRS + value * 2;
+        *--start = pair[1];
+        *--start = pair[0];
+    } else {
+        *--start = (char)('0' + value);
+    }
+
+    while (start > digits && (digits + sizeof(digits)) - start < width) {
+        *--start = pad;
+    }
+    output_append(output, start, (digits + sizeof(digits)) - start);
+}
+
+void output_append_hex(output_buffer* output, unsigned int value, int digits) {
+    char hex[MAX_NUMBER_DIGITS];
+    char* start = hex + sizeof(hex);
+
+    /* Convert from the end, one digit at a time; stop at the minimum width once the value is exhausted */
+    do {
+        *--start = HEX_DIGITS[value & 0xF];
+        value >>= 4;
+    } while (value != 0 || (hex + sizeof(hex)) - start < digits);
+
+    output_append(output, start, (hex + sizeof(hex)) - start);
+}
+
+int output_buffer_write_file(const output_buffer* output, const char* filename) {
+    FILE* file;
+    int result;
+
+    if (output->failed) {
+        return 1;
+    }
+
+    file = fopen(filename, "w");
+    if (!file) {
+        return 1;
+    }
+    result = output_buffer_write_stream(output, file);
+    if (fclose(file) != 0) {
+        result = 1;
+    }
+    return result;
+}
+
+int output_buffer_write_stream(const output_buffer* output, FILE* stream) {
+    if (output->failed || fwrite(output->text.items, 1, output->text.count, stream) != output->text.count) {
+        return 1;
+    }
+    return SUCCESS;
+}
+
+void output_buffer_free(output_buffer* output) {
+    vector_free(&output->text);
+}
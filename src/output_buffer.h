@@ -0,0 +1,103 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "vector.h"
+
+
+/* Output file content built in memory and written with a single call. Numbers are formatted
+ * with digit lookup tables instead of going through printf.
+ */
+typedef struct {
+    vector text;  /* char items */
+    int failed;   /* set if appending ran out of memory */
+} output_buffer;
+
+/**
+ * Initializes an empty output buffer with room for the expected file size.
+ * 
+ * @param output The output buffer to initialize.
+ * @param size_hint The expected size of the file in bytes.
+ * @return SUCCESS on success, MEMORY_ALLOCATION_FAILED on failure.
+ */
+int output_buffer_init(output_buffer* output, size_t size_hint);
+
+/**
+ * Initializes an empty output buffer like output_buffer_init, counting its allocations.
+ * 
+ * @param output The output buffer to initialize.
+ * @param size_hint The expected size of the file in bytes.
+ * @param counters Receives the allocations of the buffer, NULL if they are not counted.
+ * @return SUCCESS on success, MEMORY_ALLOCATION_FAILED on failure.
+ */
+int output_buffer_init_counted(output_buffer* output, size_t size_hint, alloc_counters* counters);
+
+/**
+ * Appends characters, or raw bytes.
+ * 
+ * @param output The output buffer.
+ * @param chars The characters to append.
+ * @param length The number of characters.
+ */
+void output_append(output_buffer* output, const char* chars, size_t length);
+
+/**
+ * Appends a string.
+ * 
+ * @param output The output buffer.
+ * @param str The string to append.
+ */
+void output_append_string(output_buffer* output, const char* str);
+
+/**
+ * Appends a single character.
+ * 
+ * @param output The output buffer.
+ * @param c The character to append.
+ */
+void output_append_char(output_buffer* output, char c);
+
+/**
+ * Appends a decimal number, right aligned to a minimum width (like "%07lu" or "%7lu").
+ * 
+ * @param output The output buffer.
+ * @param value The number to append.
+ * @param width The minimum number of characters.
+ * @param pad The padding character ('0' or ' ').
+ */
+void output_append_decimal(output_buffer* output, unsigned long value, int width, char pad);
+
+/**
+ * Appends a number in upper case hexadecimal, zero padded to a minimum number of digits (like "%06X").
+ * 
+ * @param output The output buffer.
+ * @param value The number to append.
+ * @param digits The minimum number of digits.
+ */
+void output_append_hex(output_buffer* output, unsigned int value, int digits);
+
+/**
+ * Writes the content of the buffer to a file with a single write.
+ * 
+ * @param output The output buffer.
+ * @param filename The name of the file to write.
+ * @return SUCCESS on success, 1 if the file could not be written or memory allocation failed earlier.
+ */
+int output_buffer_write_file(const output_buffer* output, const char* filename);
+
+/**
+ * Writes the content of the buffer to an open stream with a single write.
+ * 
+ * @param output The output buffer.
+ * @param stream The stream to write to (not flushed).
+ * @return SUCCESS on success, 1 if the stream could not be written or memory allocation failed earlier.
+ */
+int output_buffer_write_stream(const output_buffer* output, FILE* stream);
+
+/**
+ * Releases the memory held by the output buffer.
+ * 
+ * @param output The output buffer to free.
+ */
+void output_buffer_free(output_buffer* output);
@@ -0,0 +1,279 @@
+/**
+ * Resident assembler server: saves the start up cost of a process per invocation when a build runs
+ * the assembler many times. A request carries the arguments and the working directory of its
+ * client along with the client's standard output and standard error (see server_protocol.h).
+ */
+
+/* Sockets and working directories are not part of ANSI C, request them from the POSIX headers;
+ * the credentials of a client (SO_PEERCRED) are a GNU extension */
+#define _POSIX_C_SOURCE 200112L
+#define _GNU_SOURCE
+
+#include "server.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "consts.h"
+#include "server_protocol.h"
+
+
+/**
+ * Splits the body of a request into its working directory and its arguments.
+ *
+ * @param body The body, null-terminated strings.
+ * @param size The size of the body in bytes.
+ * @param argv Receives the arguments, at most one per byte of the body.
+ * @return The number of arguments, or -1 if the body holds no working directory.
+ */
+int split_request(char* body, unsigned long size, char* argv[]) {
+    unsigned long position = strlen(body) + 1;
+    int argc = 0;
+
+    if (position > size) {
+        return -1;
+    }
+    while (position < size) {
+        argv[argc++] = body + position;
+        position += strlen(body + position) + 1;
+    }
+    return argc;
+}
+
+/**
+ * Runs a request with the standard output and standard error of the process pointing to the client's.
+ *
+ * @param argc The number of arguments.
+ * @param argv The arguments.
+ * @param directory The working directory of the client.
+ * @param descriptors The standard output and standard error of the client.
+ * @param handler Runs the command line.
+ * @param tables The tables kept between requests.
+ * @return The exit status of the request.
+ */
+int run_request(int argc, char* argv[], const char* directory, const int descriptors[2], request_handler handler,
+                batch_tables* tables) {
+    int saved_output, saved_errors;
+    int status = 1;
+
+    fflush(stdout);
+    fflush(stderr);
+    saved_output = dup(STDOUT_FILENO);
+    saved_errors = dup(STDERR_FILENO);
+    if (saved_output < 0 || saved_errors < 0 || dup2(descriptors[0], STDOUT_FILENO) < 0 ||
+        dup2(descriptors[1], STDERR_FILENO) < 0) {
+        printf("Error: Could not attach to the output of a client.\n");
+    } else if (chdir(directory)) {
+        printf("Error: Could not enter the directory %s.\n", directory);
+    } else {
+        status = handler(argc, argv, tables);
+    }
+    fflush(stdout);
+    fflush(stderr);
+
+    if (saved_output >= 0) {
+        dup2(saved_output, STDOUT_FILENO);
+        close(saved_output);
+    }
+    if (saved_errors >= 0) {
+        dup2(saved_errors, STDERR_FILENO);
+        close(saved_errors);
+    }
+    return status;
+}
+
+/**
+ * Serves a single connection.
+ *
+ * @param connection The connected socket.
+ * @param home The working directory of the server, restored after the request.
+ * @param handler Runs the command line of the request.
+ * @param tables The tables kept between requests.
+ * @return 1 if the client asked the server to shut down, 0 otherwise.
+ */
+int serve_connection(int connection, const char* home, request_handler handler, batch_tables* tables) {
+    int descriptors[2];
+    char* body;
+    char** argv;
+    unsigned long size;
+    int argc;
+    int status = 1;
+    int stop = 0;
+
+    if (receive_request(connection, REQUEST_TIMEOUT_SECONDS, descriptors, &body, &size)) {
+        return 0;
+    }
+
+    argv = (char**)malloc((size + 1) * sizeof(char*));
+    argc = argv ? split_request(body, size, argv) : -1;
+    if (argc == 2 && !strcmp(argv[1], SHUTDOWN_REQUEST)) {
+        stop = 1;
+        status = SUCCESS;
+    } else if (argc >= 1) {
+        argv[argc] = NULL;
+        status = run_request(argc, argv, body, descriptors, handler, tables);
+        if (chdir(home)) {
+            printf("Error: Could not return to the directory %s.\n", home);
+        }
+    }
+    send_status(connection, status);
+
+    close(descriptors[0]);
+    close(descriptors[1]);
+    free(argv);
+    free(body);
+    return stop;
+}
+
+/**
+ * @param connection A connected socket.
+ * @return 1 if the client runs as the user of the server, 0 otherwise or if its user cannot be told.
+ */
+int client_is_owner(int connection) {
+#ifdef SO_PEERCRED
+    struct ucred credentials;
+    socklen_t length = sizeof(credentials);
+
+    return getsockopt(connection, SOL_SOCKET, SO_PEERCRED, &credentials, &length) == 0 &&
+           credentials.uid == geteuid();
+#else
+    uid_t uid;
+    gid_t gid;
+
+    return getpeereid(connection, &uid, &gid) == 0 && uid == geteuid();
+#endif
+}
+
+/**
+ * Creates the private socket directory of the user, or checks that it is still private.
+ *
+ * @param directory The directory.
+ * @return SUCCESS on success, 1 if the directory could not be created or is not private.
+ */
+int make_private_directory(const char* directory) {
+    struct stat info;
+
+    if (mkdir(directory, 0700) != 0 && errno != EEXIST) {
+        printf("Error: Could not create the directory %s.\n", directory);
+        return 1;
+    }
+    if (lstat(directory, &info) != 0 || !S_ISDIR(info.st_mode) || info.st_uid != geteuid() ||
+        (info.st_mode & 077) != 0) {
+        printf("Error: %s is not a directory of this user only.\n", directory);
+        return 1;
+    }
+    return SUCCESS;
+}
+
+/**
+ * Creates the listening socket, replacing a socket left behind by a server that is no longer running.
+ *
+ * @param socket_path The path of the socket.
+ * @return The socket, or -1 on failure.
+ */
+int open_listener(const char* socket_path) {
+    struct sockaddr_un address;
+    struct stat info;
+    int listener;
+    int probe;
+
+    if (strlen(socket_path) >= sizeof(address.sun_path)) {
+        printf("Error: The socket path %s is too long.\n", socket_path);
+        return -1;
+    }
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, socket_path);
+
+    if (stat(socket_path, &info) == 0) {
+        if (!S_ISSOCK(info.st_mode)) {
+            printf("Error: %s exists and is not a socket.\n", socket_path);
+            return -1;
+        }
+        probe = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (probe >= 0 && connect(probe, (struct sockaddr*)&address, sizeof(address)) == 0) {
+            printf("Error: A server is already listening on %s.\n", socket_path);
+            close(probe);
+            return -1;
+        }
+        if (probe >= 0) {
+            close(probe);
+        }
+        unlink(socket_path);
+    }
+
+    listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0 || bind(listener, (struct sockaddr*)&address, sizeof(address)) ||
+        listen(listener, SOMAXCONN)) {
+        printf("Error: Could not listen on %s.\n", socket_path);
+        if (listener >= 0) {
+            close(listener);
+        }
+        return -1;
+    }
+    return listener;
+}
+
+int run_server(const char* socket_path, request_handler handler) {
+    char home[FILENAME_MAX];
+    char private_directory[FILENAME_MAX];
+    size_t length;
+    batch_tables tables;
+    int listener;
+    int connection;
+    int stop = 0;
+
+    if (!getcwd(home, sizeof(home))) {
+        printf("Error: Could not read the working directory.\n");
+        return 1;
+    }
+    /* The default socket outside the runtime directory lives in a directory only the user can enter */
+    private_socket_directory(private_directory);
+    length = strlen(private_directory);
+    if (!strncmp(socket_path, private_directory, length) && socket_path[length] == '/' &&
+        make_private_directory(private_directory)) {
+        return 1;
+    }
+    listener = open_listener(socket_path);
+    if (listener < 0) {
+        return 1;
+    }
+
+    /* A client going away in the middle of its output must not stop the server */
+    signal(SIGPIPE, SIG_IGN);
+    batch_tables_init(&tables);
+    printf("Assembler server listening on %s\n", socket_path);
+    fflush(stdout);
+
+    while (!stop) {
+        connection = accept(listener, NULL, NULL);
+        if (connection < 0 && errno == EINTR) {
+            continue;
+        }
+        if (connection < 0) {
+            printf("Error: Could not accept a connection on %s.\n", socket_path);
+            break;
+        }
+        /* A request runs with the rights of the server, in a directory of the client's choice */
+        if (client_is_owner(connection)) {
+            stop = serve_connection(connection, home, handler, &tables);
+        } else {
+            printf("Error: Refused a client of another user.\n");
+            fflush(stdout);
+        }
+        close(connection);
+    }
+
+    batch_tables_free(&tables);
+    close(listener);
+    unlink(socket_path);
+    printf("Assembler server stopped\n");
+    return stop ? SUCCESS : 1;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "batch.h"
+
+/**
+ * Runs the assembler on a command line.
+ *
+ * @param argc The number of arguments.
+ * @param argv The arguments, the program name first.
+ * @param tables The tables kept between runs, NULL if there are none.
+ * @return The exit status of the run.
+ */
+typedef int (*request_handler)(int argc, char* argv[], batch_tables* tables);
+
+/**
+ * Runs the resident assembler server: accepts requests on a Unix domain socket until a client asks it
+ * to shut down, and runs each of them with the given handler. Requests run one at a time, in the
+ * working directory of their client and with their output written to the client's standard output
+ * and standard error, so they print exactly what the command line assembler prints. The tables of
+ * the assembler stay allocated between requests.
+ *
+ * @param socket_path The path of the socket.
+ * @param handler Runs the command line of a request.
+ * @return SUCCESS when the server was shut down, 1 if it could not be started or stopped on an error.
+ */
+int run_server(const char* socket_path, request_handler handler);
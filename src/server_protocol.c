@@ -0,0 +1,291 @@
+/**
+ * The wire format of the assembler server, shared by the server and its client.
+ */
+
+/* Sockets and descriptor passing are not part of ANSI C, request them from the POSIX headers */
+#define _POSIX_C_SOURCE 200112L
+
+#include "server_protocol.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include "consts.h"
+
+/* Received descriptors are closed on exec where the system can mark them as they arrive (Linux) */
+#ifndef MSG_CMSG_CLOEXEC
+#define MSG_CMSG_CLOEXEC 0
+#endif
+
+
+void private_socket_directory(char* directory) {
+    sprintf(directory, "%s%lu", PRIVATE_SOCKET_DIRECTORY, (unsigned long)geteuid());
+}
+
+const char* server_socket_path(void) {
+    static char default_path[FILENAME_MAX];
+    const char* path = getenv(ASSEMBLER_SOCKET_VARIABLE);
+    const char* runtime_directory = getenv(RUNTIME_DIRECTORY_VARIABLE);
+
+    if (path && *path) {
+        return path;
+    }
+    if (runtime_directory && *runtime_directory &&
+        strlen(runtime_directory) + strlen(SERVER_SOCKET_NAME) + 2 <= sizeof(default_path)) {
+        sprintf(default_path, "%s/%s", runtime_directory, SERVER_SOCKET_NAME);
+    } else {
+        private_socket_directory(default_path);
+        strcat(default_path, "/" SERVER_SOCKET_NAME);
+    }
+    return default_path;
+}
+
+int send_all(int fd, const void* data, size_t size) {
+    const char* bytes = (const char*)data;
+    ssize_t written;
+
+    while (size > 0) {
+        written = write(fd, bytes, size);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            return 1;
+        }
+        bytes += written;
+        size -= (size_t)written;
+    }
+    return SUCCESS;
+}
+
+int receive_all(int fd, void* data, size_t size) {
+    char* bytes = (char*)data;
+    ssize_t count;
+
+    while (size > 0) {
+        count = read(fd, bytes, size);
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count <= 0) {
+            return 1;
+        }
+        bytes += count;
+        size -= (size_t)count;
+    }
+    return SUCCESS;
+}
+
+/**
+ * Waits until a socket has bytes to read (or is closed).
+ *
+ * @param fd The socket.
+ * @param deadline The time, as returned by time(), after which to give up.
+ * @return SUCCESS when the socket can be read, 1 if the deadline passed or polling failed.
+ */
+int wait_readable(int fd, time_t deadline) {
+    struct pollfd watched;
+    time_t now;
+    int ready;
+
+    do {
+        now = time(NULL);
+        if (now >= deadline) {
+            return 1;
+        }
+        watched.fd = fd;
+        watched.events = POLLIN;
+        watched.revents = 0;
+        ready = poll(&watched, 1, (int)(deadline - now) * 1000);
+    } while (ready < 0 && errno == EINTR);
+    return ready > 0 ? SUCCESS : 1;
+}
+
+/**
+ * Reads a whole block of bytes from a socket before a deadline.
+ *
+ * @param fd The socket.
+ * @param data Receives the bytes.
+ * @param size The number of bytes.
+ * @param deadline The time, as returned by time(), after which to give up.
+ * @return SUCCESS on success, 1 if the connection failed, was closed first or the deadline passed.
+ */
+int receive_before(int fd, void* data, size_t size, time_t deadline) {
+    char* bytes = (char*)data;
+    ssize_t count;
+
+    while (size > 0) {
+        if (wait_readable(fd, deadline)) {
+            return 1;
+        }
+        count = read(fd, bytes, size);
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count <= 0) {
+            return 1;
+        }
+        bytes += count;
+        size -= (size_t)count;
+    }
+    return SUCCESS;
+}
+
+/**
+ * @param bytes Receives the number as 4 little-endian bytes.
+ * @param value The number.
+ */
+void encode_u32(unsigned char* bytes, unsigned long value) {
+    bytes[0] = (unsigned char)(value & 0xFF);
+    bytes[1] = (unsigned char)((value >> 8) & 0xFF);
+    bytes[2] = (unsigned char)((value >> 16) & 0xFF);
+    bytes[3] = (unsigned char)((value >> 24) & 0xFF);
+}
+
+/**
+ * @param bytes 4 little-endian bytes.
+ * @return The number.
+ */
+unsigned long decode_u32(const unsigned char* bytes) {
+    return (unsigned long)bytes[0] | ((unsigned long)bytes[1] << 8) |
+           ((unsigned long)bytes[2] << 16) | ((unsigned long)bytes[3] << 24);
+}
+
+int send_request(int fd, int output, int errors, const char* body, unsigned long size) {
+    unsigned char header[SERVER_HEADER_SIZE];
+    int descriptors[2];
+    union {
+        struct cmsghdr align;
+        char buffer[CMSG_SPACE(sizeof(descriptors))];
+    } control;
+    struct msghdr message;
+    struct cmsghdr* attached;
+    struct iovec part;
+    ssize_t written;
+
+    encode_u32(header, size);
+    part.iov_base = header;
+    part.iov_len = sizeof(header);
+    descriptors[0] = output;
+    descriptors[1] = errors;
+
+    memset(&message, 0, sizeof(message));
+    memset(&control, 0, sizeof(control));
+    message.msg_iov = &part;
+    message.msg_iovlen = 1;
+    message.msg_control = control.buffer;
+    message.msg_controllen = sizeof(control.buffer);
+    attached = CMSG_FIRSTHDR(&message);
+    attached->cmsg_level = SOL_SOCKET;
+    attached->cmsg_type = SCM_RIGHTS;
+    attached->cmsg_len = CMSG_LEN(sizeof(descriptors));
+    memcpy(CMSG_DATA(attached), descriptors, sizeof(descriptors));
+
+    do {
+        written = sendmsg(fd, &message, 0);
+    } while (written < 0 && errno == EINTR);
+    if (written != sizeof(header)) {
+        return 1;
+    }
+    return send_all(fd, body, size);
+}
+
+/**
+ * Closes every descriptor attached to a received message, so a malformed request does not leave
+ * them open in the server.
+ *
+ * @param message The message.
+ */
+void close_attached(struct msghdr* message) {
+    struct cmsghdr* attached;
+    size_t count;
+    size_t i;
+    int descriptor;
+
+    for (attached = CMSG_FIRSTHDR(message); attached; attached = CMSG_NXTHDR(message, attached)) {
+        if (attached->cmsg_level != SOL_SOCKET || attached->cmsg_type != SCM_RIGHTS) {
+            continue;
+        }
+        count = (attached->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+        for (i = 0; i < count; i++) {
+            memcpy(&descriptor, CMSG_DATA(attached) + i * sizeof(int), sizeof(int));
+            close(descriptor);
+        }
+    }
+}
+
+int receive_request(int fd, int timeout, int descriptors[2], char** body, unsigned long* size) {
+    unsigned char header[SERVER_HEADER_SIZE];
+    union {
+        struct cmsghdr align;
+        char buffer[CMSG_SPACE(2 * sizeof(int))];
+    } control;
+    struct msghdr message;
+    struct cmsghdr* attached;
+    struct iovec part;
+    time_t deadline = time(NULL) + timeout;
+    ssize_t count = -1;
+
+    part.iov_base = header;
+    part.iov_len = sizeof(header);
+    memset(&message, 0, sizeof(message));
+    message.msg_iov = &part;
+    message.msg_iovlen = 1;
+    message.msg_control = control.buffer;
+    message.msg_controllen = sizeof(control.buffer);
+
+    if (wait_readable(fd, deadline) == SUCCESS) {
+        do {
+            count = recvmsg(fd, &message, MSG_CMSG_CLOEXEC);
+        } while (count < 0 && errno == EINTR);
+    }
+    attached = count > 0 ? CMSG_FIRSTHDR(&message) : NULL;
+    if (!attached || attached->cmsg_level != SOL_SOCKET || attached->cmsg_type != SCM_RIGHTS ||
+        attached->cmsg_len != CMSG_LEN(2 * sizeof(int))) {
+        if (count > 0) {
+            close_attached(&message);
+        }
+        return 1;
+    }
+    memcpy(descriptors, CMSG_DATA(attached), 2 * sizeof(int));
+
+    /* The header may arrive in more than one part, the descriptors come with the first one */
+    *size = 0;
+    *body = NULL;
+    if (count == sizeof(header) || receive_before(fd, header + count, sizeof(header) - count, deadline) == SUCCESS) {
+        *size = decode_u32(header);
+        *body = *size <= MAX_REQUEST_SIZE ? (char*)malloc(*size + 1) : NULL;
+    }
+    if (!*body || receive_before(fd, *body, *size, deadline)) {
+        free(*body);
+        close(descriptors[0]);
+        close(descriptors[1]);
+        return 1;
+    }
+    (*body)[*size] = '\0';
+    return SUCCESS;
+}
+
+int send_status(int fd, int status) {
+    unsigned char bytes[SERVER_HEADER_SIZE];
+
+    encode_u32(bytes, (unsigned long)status);
+    return send_all(fd, bytes, sizeof(bytes));
+}
+
+int receive_status(int fd, int* status) {
+    unsigned char bytes[SERVER_HEADER_SIZE];
+
+    if (receive_all(fd, bytes, sizeof(bytes))) {
+        return 1;
+    }
+    *status = (int)decode_u32(bytes);
+    return SUCCESS;
+}
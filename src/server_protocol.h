@@ -0,0 +1,102 @@
+#pragma once
+
+#include <stdlib.h>
+
+/* The socket of the assembler server: $ASSEMBLER_SOCKET if set, else SERVER_SOCKET_NAME in the runtime
+ * directory of the user ($XDG_RUNTIME_DIR), else in PRIVATE_SOCKET_DIRECTORY followed by the user id,
+ * which the server creates with mode 0700. Either way, the server only serves clients of its own user.
+ */
+#define ASSEMBLER_SOCKET_VARIABLE "ASSEMBLER_SOCKET"
+#define RUNTIME_DIRECTORY_VARIABLE "XDG_RUNTIME_DIR"
+#define PRIVATE_SOCKET_DIRECTORY "/tmp/assembler-"
+#define SERVER_SOCKET_NAME "assembler.sock"
+
+/* The only argument of a request stopping the server */
+#define SHUTDOWN_REQUEST "--shutdown"
+
+/* A request of the assembler server, sent by a client over a Unix domain socket:
+ *   header  the size of the body (unsigned 32-bit, little-endian), sent with the standard output
+ *           and standard error of the client attached (SCM_RIGHTS)
+ *   body    the working directory of the client, then its arguments, each null-terminated
+ * The server writes the output of the request directly to the attached descriptors, then replies
+ * with the exit status of the request (unsigned 32-bit, little-endian).
+ */
+#define SERVER_HEADER_SIZE 4
+#define MAX_REQUEST_SIZE (1024UL * 1024)
+
+/* The seconds a client has to send its whole request. The server serves one client at a time, so a
+ * client that connects and stays silent is dropped rather than waited for.
+ */
+#define REQUEST_TIMEOUT_SECONDS 10
+
+/**
+ * @return The path of the socket of the assembler server.
+ */
+const char* server_socket_path(void);
+
+/**
+ * @param directory Receives the private socket directory of the user (FILENAME_MAX bytes).
+ */
+void private_socket_directory(char* directory);
+
+/**
+ * Writes a whole block of bytes to a socket.
+ *
+ * @param fd The socket.
+ * @param data The bytes to write.
+ * @param size The number of bytes.
+ * @return SUCCESS on success, 1 if the connection failed.
+ */
+int send_all(int fd, const void* data, size_t size);
+
+/**
+ * Reads a whole block of bytes from a socket.
+ *
+ * @param fd The socket.
+ * @param data Receives the bytes.
+ * @param size The number of bytes.
+ * @return SUCCESS on success, 1 if the connection failed or was closed first.
+ */
+int receive_all(int fd, void* data, size_t size);
+
+/**
+ * Sends a request to the assembler server.
+ *
+ * @param fd The connected socket.
+ * @param output The descriptor receiving the standard output of the request.
+ * @param errors The descriptor receiving the standard error of the request.
+ * @param body The body of the request.
+ * @param size The size of the body in bytes.
+ * @return SUCCESS on success, 1 if the connection failed.
+ */
+int send_request(int fd, int output, int errors, const char* body, unsigned long size);
+
+/**
+ * Receives a request of a client, giving up if the whole request has not arrived in time.
+ *
+ * @param fd The connected socket.
+ * @param timeout The seconds the client has to send the request.
+ * @param descriptors Receives the standard output and standard error of the client, closed by the caller.
+ * @param body Receives the body of the request, null-terminated and freed by the caller.
+ * @param size Receives the size of the body in bytes.
+ * @return SUCCESS on success, 1 if the request is not valid or late (no descriptors are then left open).
+ */
+int receive_request(int fd, int timeout, int descriptors[2], char** body, unsigned long* size);
+
+/**
+ * Sends the exit status of a request.
+ *
+ * @param fd The connected socket.
+ * @param status The exit status.
+ * @return SUCCESS on success, 1 if the connection failed.
+ */
+int send_status(int fd, int status);
+
+/**
+ * Receives the exit status of a request.
+ *
+ * @param fd The connected socket.
+ * @param status Receives the exit status.
+ * @return SUCCESS on success, 1 if the connection failed.
+ */
+int receive_status(int fd, int* status);
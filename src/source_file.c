@@ -0,0 +1,142 @@
+/**
+ * Input layer: source files are mapped into memory (or read whole when they cannot be mapped)
+ * and their lines are handed out as views into that memory, so no line is ever copied
+ * just to be read.
+ */
+
+/* mmap and the file descriptor calls are not part of ANSI C, request them from the POSIX headers */
+#define _POSIX_C_SOURCE 200112L
+
+#include "source_file.h"
+
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "consts.h"
+#include "vector.h"
+
+#define READ_CHUNK_SIZE 65536
+
+
+/**
+ * Reads the whole content of a file descriptor, for files that cannot be mapped.
+ *
+ * @param file The source file to fill.
+ * @param fd The file descriptor to read.
+ * @return SUCCESS on success, 1 on a read or memory allocation failure.
+ */
+int read_whole_file(source_file* file, int fd) {
+    vector content;
+    char* chunk;
+    ssize_t bytes_read;
+
+    vector_init(&content, sizeof(char));
+    for (;;) {
+        chunk = (char*)vector_extend(&content, READ_CHUNK_SIZE);
+        if (!chunk) {
+            vector_free(&content);
+            return 1;
+        }
+        bytes_read = read(fd, chunk, READ_CHUNK_SIZE);
+        if (bytes_read < 0) {
+            vector_free(&content);
+            return 1;
+        }
+        content.count -= READ_CHUNK_SIZE - bytes_read;
+        if (bytes_read == 0) {
+            break;
+        }
+    }
+
+    file->data = (char*)content.items;
+    file->size = content.count;
+    file->mapped = 0;
+    return SUCCESS;
+}
+
+/**
+ * Makes the whole content of an open file descriptor available in memory: a regular file is mapped,
+ * anything else (or a file that cannot be mapped) is read whole.
+ *
+ * @param file The source file to fill.
+ * @param fd The file descriptor.
+ * @return SUCCESS on success, 1 on a read or memory allocation failure.
+ */
+int load_descriptor(source_file* file, int fd) {
+    struct stat info;
+    void* mapping;
+
+    file->data = NULL;
+    file->size = 0;
+    file->mapped = 0;
+
+    if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+        mapping = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping != MAP_FAILED) {
+            file->data = (char*)mapping;
+            file->size = (size_t)info.st_size;
+            file->mapped = 1;
+            return SUCCESS;
+        }
+    }
+    return read_whole_file(file, fd);
+}
+
+int source_file_open(source_file* file, const char* filename) {
+    int fd;
+    int result;
+
+    file->data = NULL;
+    file->size = 0;
+    file->mapped = 0;
+
+    fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        return 1;
+    }
+    result = load_descriptor(file, fd);
+    close(fd);
+    return result;
+}
+
+int source_file_open_stdin(source_file* file) {
+    return load_descriptor(file, STDIN_FILENO);
+}
+
+void source_file_close(source_file* file) {
+    if (file->mapped) {
+        munmap(file->data, file->size);
+    } else {
+        free(file->data);
+    }
+    file->data = NULL;
+    file->size = 0;
+    file->mapped = 0;
+}
+
+void line_reader_init(line_reader* reader, const char* text, size_t size) {
+    reader->text = text;
+    reader->size = size;
+    reader->position = 0;
+    reader->line_number = 0;
+}
+
+int line_reader_next(line_reader* reader, line_view* line) {
+    const char* start = reader->text + reader->position;
+    size_t remaining = reader->size - reader->position;
+    const char* newline;
+
+    if (remaining == 0) {
+        return 0;
+    }
+
+    newline = (const char*)memchr(start, '\n', remaining);
+    line->text = start;
+    line->length = newline ? (size_t)(newline - start) : remaining;
+    line->line_number = ++reader->line_number;
+    reader->position += line->length + (newline != NULL);
+    return 1;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <stdlib.h>
+
+
+/* The content of a source file, mapped into memory or (for pipes and other special files) read whole */
+typedef struct {
+    char* data;
+    size_t size;
+    int mapped;  /* whether data is a memory mapping */
+} source_file;
+
+/* A line of text, pointing into the text it was read from (not null-terminated) */
+typedef struct {
+    const char* text;
+    size_t length;  /* without the newline */
+    int line_number;
+} line_view;
+
+/* Hands out the lines of a block of text one by one */
+typedef struct {
+    const char* text;
+    size_t size;
+    size_t position;
+    int line_number;
+} line_reader;
+
+/**
+ * Opens a source file and makes its whole content available in memory.
+ *
+ * @param file The source file to fill.
+ * @param filename The name of the file to open.
+ * @return SUCCESS on success, 1 if the file could not be opened or read.
+ */
+int source_file_open(source_file* file, const char* filename);
+
+/**
+ * Makes the whole content of the standard input available in memory, reading it to its end.
+ *
+ * @param file The source file to fill.
+ * @return SUCCESS on success, 1 if the standard input could not be read.
+ */
+int source_file_open_stdin(source_file* file);
+
+/**
+ * Releases the content of a source file.
+ *
+ * @param file The source file to close.
+ */
+void source_file_close(source_file* file);
+
+/**
+ * Initializes a reader over a block of text.
+ *
+ * @param reader The reader to initialize.
+ * @param text The text to read, lines separated by '\n'.
+ * @param size The size of the text in bytes.
+ */
+void line_reader_init(line_reader* reader, const char* text, size_t size);
+
+/**
+ * Reads the next line of the text, without copying it.
+ *
+ * @param reader The reader.
+ * @param line Receives the line.
+ * @return 1 if a line was read, 0 at the end of the text.
+ */
+int line_reader_next(line_reader* reader, line_view* line);
@@ -0,0 +1,296 @@
+/**
+ * Split assembly: the first and second cycles of a large source, chunk by chunk. Every chunk is
+ * assembled into tables of its own, so the chunks share no mutable state until they are merged;
+ * the merge is the only step that goes over the chunks one after the other.
+ */
+
+#include "split_assembly.h"
+
+#include <string.h>
+
+#include "consts.h"
+
+
+size_t split_count(const line_buffer* source, size_t max_chunks) {
+    size_t count = line_buffer_count(source) / SPLIT_MIN_LINES;
+
+    if (count > max_chunks) {
+        count = max_chunks;
+    }
+    return count ? count : 1;
+}
+
+/**
+ * @param text The text.
+ * @param size The size of the text in bytes.
+ * @return The number of newlines in the text.
+ */
+size_t count_newlines(const char* text, size_t size) {
+    const char* end = text + size;
+    size_t count = 0;
+
+    while ((text = (const char*)memchr(text, '\n', end - text)) != NULL) {
+        text++;
+        count++;
+    }
+    return count;
+}
+
+void split_source(const line_buffer* source, source_chunk* chunks, size_t count) {
+    const char* text = VECTOR_ITEMS(source->text, char);
+    size_t size = source->text.count;
+    size_t start = 0;
+    size_t end;
+    const char* newline;
+    int line_number = 1;
+    size_t i;
+
+    for (i = 0; i < count; i++) {
+        source_chunk* chunk = &chunks[i];
+
+        /* Cut after the first newline past an equal share of the bytes */
+        end = i + 1 < count ? size / count * (i + 1) : size;
+        if (end < start) {
+            end = start;
+        }
+        if (end < size) {
+            newline = (const char*)memchr(text + end, '\n', size - end);
+            end = newline ? (size_t)(newline - text) + 1 : size;
+        }
+
+        chunk->text = text + start;
+        chunk->size = end - start;
+        chunk->first_line = line_number;
+        chunk->line_count = count_newlines(chunk->text, chunk->size);
+        line_number += (int)chunk->line_count;
+        if (end == size && end > start && text[end - 1] != '\n') {
+            chunk->line_count++;  /* the last line has no newline */
+        }
+        assembly_init(&chunk->unit);
+        diagnostics_init(&chunk->diag);
+        vector_init(&chunk->externals, sizeof(external_info));
+        chunk->failed = 0;
+        chunk->merged = NULL;
+        chunk->symbol_ids = NULL;
+        chunk->code_base = 0;
+        chunk->data_base = 0;
+        chunk->fixup_base = 0;
+        memset(chunk->counters, 0, sizeof(chunk->counters));
+        start = end;
+    }
+}
+
+void split_track(source_chunk* chunks, size_t count) {
+    size_t i;
+
+    for (i = 0; i < count; i++) {
+        assembly_track(&chunks[i].unit, chunks[i].counters);
+        vector_track(&chunks[i].externals, &chunks[i].counters[EXTERNAL_ALLOCS]);
+    }
+}
+
+void first_cycle_chunk(source_chunk* chunk) {
+    if (assembly_reserve(&chunk->unit, chunk->line_count)) {
+        report(&chunk->diag, "Error: Memory allocation failed.\n");
+        chunk->failed = 1;
+        return;
+    }
+    chunk->failed = first_cycle_lines(&chunk->unit, chunk->text, chunk->size, chunk->first_line, &chunk->diag);
+}
+
+/**
+ * Merges the labels of a chunk into the merged symbol table, after the labels of the previous chunks.
+ * The symbol id of every label of the chunk is mapped to its merged symbol id.
+ *
+ * @param unit The merged tables.
+ * @param chunk The chunk.
+ * @param conflict Set if a label checked or defined by the chunk was defined by a previous chunk.
+ * @return SUCCESS on success, MEMORY_ALLOCATION_FAILED on failure.
+ */
+int merge_chunk_labels(assembly_unit* unit, source_chunk* chunk, int* conflict) {
+    const symbol_table* labels = &chunk->unit.symbols;
+    const size_t* checks = VECTOR_ITEMS(chunk->unit.label_checks, size_t);
+    size_t id_count = symbol_table_id_count(labels);
+    label_element* label;
+    int address;
+    size_t i;
+
+    chunk->symbol_ids = (size_t*)counted_malloc(subsystem_counters(chunk->unit.counters, SYMBOL_ALLOCS),
+                                                (id_count ? id_count : 1) * sizeof(size_t));
+    if (!chunk->symbol_ids) {
+        return MEMORY_ALLOCATION_FAILED;
+    }
+    for (i = 0; i < id_count; i++) {
+        if (symbol_table_reference(&unit->symbols, symbol_table_get(labels, i)->label_name, &chunk->symbol_ids[i])) {
+            return MEMORY_ALLOCATION_FAILED;
+        }
+    }
+
+    /* The checks see only the previous chunks: the chunk's own labels were checked by its first cycle */
+    for (i = 0; i < chunk->unit.label_checks.count; i++) {
+        if (symbol_table_get(&unit->symbols, chunk->symbol_ids[checks[i]])->label_type != undefined_label) {
+            *conflict = 1;
+        }
+    }
+
+    for (i = 0; i < symbol_table_count(labels); i++) {
+        label = symbol_table_at(labels, i);
+        if (label->label_type != extern_label && symbol_table_lookup(&unit->symbols, label->label_name)) {
+            *conflict = 1;  /* an `.extern` of a defined label is ignored, a label defined again is an error */
+        }
+        address = label->address + (int)(label->label_type == data_label ? chunk->data_base : chunk->code_base);
+        if (symbol_table_insert(&unit->symbols, label->label_name, address, label->label_type)) {
+            return MEMORY_ALLOCATION_FAILED;
+        }
+    }
+    return SUCCESS;
+}
+
+merge_result merge_chunks(assembly_unit* unit, source_chunk* chunks, size_t count, diagnostics* diag) {
+    size_t code_count = 0, data_count = 0, fixup_count = 0, line_count = 0;
+    int failed = 0;
+    int conflict = 0;
+    size_t i;
+
+    /* Each chunk goes after the previous ones */
+    for (i = 0; i < count; i++) {
+        chunks[i].merged = unit;
+        chunks[i].code_base = code_count;
+        chunks[i].data_base = data_count;
+        chunks[i].fixup_base = fixup_count;
+        code_count += chunks[i].unit.code.count;
+        data_count += chunks[i].unit.data.count;
+        fixup_count += chunks[i].unit.fixups.count;
+        line_count += chunks[i].line_count;
+        failed |= chunks[i].failed;
+    }
+
+    if (symbol_table_reserve(&unit->symbols, line_count)) {
+        report(diag, "Error: Memory allocation failed.\n");
+        return CHUNKS_FAILED;
+    }
+    for (i = 0; i < count; i++) {
+        if (merge_chunk_labels(unit, &chunks[i], &conflict)) {
+            report(diag, "Error: Memory allocation failed.\n");
+            return CHUNKS_FAILED;
+        }
+    }
+    if (conflict) {
+        return CHUNKS_CONFLICT;
+    }
+    if (failed) {
+        return CHUNKS_FAILED;
+    }
+
+    /* The chunks copy their code, data and fixups in place during their second cycle */
+    if (vector_reserve(&unit->code, code_count) || vector_reserve(&unit->data, data_count) ||
+        vector_reserve(&unit->fixups, fixup_count)) {
+        report(diag, "Error: Memory allocation failed.\n");
+        return CHUNKS_FAILED;
+    }
+    unit->code.count = code_count;
+    unit->data.count = data_count;
+    unit->fixups.count = fixup_count;
+    close_first_cycle(unit);
+    return CHUNKS_MERGED;
+}
+
+void report_chunks(const source_chunk* chunks, size_t count, diagnostics* diag) {
+    size_t i;
+
+    for (i = 0; i < count; i++) {
+        report_all(diag, &chunks[i].diag);
+    }
+}
+
+void second_cycle_chunk(source_chunk* chunk) {
+    assembly_unit* unit = chunk->merged;
+    const fixup* fixups = VECTOR_ITEMS(chunk->unit.fixups, fixup);
+    fixup* merged = VECTOR_ITEMS(unit->fixups, fixup) + chunk->fixup_base;
+    size_t i;
+
+    if (chunk->unit.code.count) {
+        memcpy(VECTOR_ITEMS(unit->code, machine_word) + chunk->code_base, chunk->unit.code.items,
+               chunk->unit.code.count * sizeof(machine_word));
+    }
+    if (chunk->unit.data.count) {
+        memcpy(VECTOR_ITEMS(unit->data, data) + chunk->data_base, chunk->unit.data.items,
+               chunk->unit.data.count * sizeof(data));
+    }
+    for (i = 0; i < chunk->unit.fixups.count; i++) {
+        merged[i] = fixups[i];
+        if (fixups[i].type == operand_fixup) {
+            merged[i].word_index += chunk->code_base;
+        }
+        if (fixups[i].type != invalid_entry_line) {
+            merged[i].symbol_id = chunk->symbol_ids[fixups[i].symbol_id];
+        }
+    }
+
+    chunk->failed = resolve_fixups(unit, chunk->fixup_base, chunk->fixup_base + chunk->unit.fixups.count, 0,
+                                   &chunk->externals, &chunk->diag);
+}
+
+/**
+ * @param unit The merged tables.
+ * @return 1 if an entry fixup names an external label.
+ */
+int has_external_entry(const assembly_unit* unit) {
+    const fixup* fixups = VECTOR_ITEMS(unit->fixups, fixup);
+    size_t i;
+
+    for (i = 0; i < unit->fixups.count; i++) {
+        if (fixups[i].type == entry_fixup &&
+            (symbol_table_get(&unit->symbols, fixups[i].symbol_id)->label_type & extern_label)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int close_chunks(assembly_unit* unit, source_chunk* chunks, size_t count, diagnostics* diag) {
+    size_t extern_count = 0;
+    int failed = 0;
+    size_t i;
+
+    if (has_external_entry(unit)) {
+        return second_cycle(unit, diag);
+    }
+
+    mark_entry_labels(unit);
+    for (i = 0; i < count; i++) {
+        extern_count += chunks[i].externals.count;
+    }
+    if (vector_reserve(&unit->externals, extern_count)) {
+        report(diag, "Error: Memory allocation failed.\n");
+        return 1;
+    }
+    for (i = 0; i < count; i++) {
+        failed |= chunks[i].failed;
+        if (chunks[i].externals.count) {
+            memcpy(VECTOR_ITEMS(unit->externals, external_info) + unit->externals.count, chunks[i].externals.items,
+                   chunks[i].externals.count * sizeof(external_info));
+            unit->externals.count += chunks[i].externals.count;
+        }
+    }
+    report_chunks(chunks, count, diag);
+    return failed;
+}
+
+void chunks_free(source_chunk* chunks, size_t count, alloc_counters* counters) {
+    size_t id_count;
+    size_t i;
+    int j;
+
+    for (i = 0; i < count; i++) {
+        id_count = symbol_table_id_count(&chunks[i].unit.symbols);
+        counted_free(subsystem_counters(chunks[i].unit.counters, SYMBOL_ALLOCS), chunks[i].symbol_ids,
+                     (id_count ? id_count : 1) * sizeof(size_t));
+        assembly_free(&chunks[i].unit);
+        diagnostics_free(&chunks[i].diag);
+        vector_free(&chunks[i].externals);
+        for (j = 0; counters && j < SUBSYSTEM_COUNT; j++) {
+            alloc_counters_join(&counters[j], &chunks[i].counters[j]);
+        }
+    }
+}
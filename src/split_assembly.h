@@ -0,0 +1,136 @@
+#pragma once
+
+#include <stdlib.h>
+
+#include "assembler.h"
+#include "line_buffer.h"
+#include "diagnostics.h"
+
+/* Splitting a large expanded source into chunks of whole lines that are assembled at the same time.
+ * The library only provides the steps; the caller runs the steps of the chunks on its own threads:
+ *   1. first_cycle_chunk on every chunk: the first cycle of the chunk's lines into tables of its own,
+ *      with addresses counted from the start of the chunk and symbol ids of its own.
+ *   2. merge_chunks: the code and data of each chunk are placed after those of the previous chunks
+ *      (a prefix sum of their sizes) and the labels are merged into one symbol table, in source order.
+ *   3. second_cycle_chunk on every chunk: copies the chunk's code, data and fixups into the merged
+ *      tables and resolves its fixups, which only write the chunk's own code words.
+ *   4. close_chunks: marks the entries and collects the externals and the messages in source order.
+ * If the chunks have errors, merge_chunks says so and report_chunks collects their messages instead.
+ * The result, messages included, is the same as assembling the whole source with first_cycle and
+ * second_cycle. A label defined again in a later chunk is only found while merging; the first cycle
+ * of the whole source is then run again, so the messages are reported exactly as in a single pass.
+ */
+
+/* The fewest lines worth splitting off into a chunk of their own (`make test_split` builds with a few lines) */
+#ifndef SPLIT_MIN_LINES
+#define SPLIT_MIN_LINES 65536
+#endif
+
+/* A run of whole lines of the source */
+typedef struct {
+    const char* text;        /* the lines */
+    size_t size;             /* the size of the lines in bytes */
+    int first_line;          /* the line number of the first line */
+    size_t line_count;       /* the number of lines */
+    assembly_unit unit;      /* the tables of the chunk, with chunk-local addresses and symbol ids */
+    diagnostics diag;        /* the messages of the chunk */
+    int failed;              /* errors were found in the chunk */
+    assembly_unit* merged;   /* the merged tables, set by merge_chunks */
+    size_t* symbol_ids;      /* the merged symbol id of each symbol id of the chunk */
+    size_t code_base;        /* the index of the first code word of the chunk in the merged code */
+    size_t data_base;        /* the index of the first data word of the chunk in the merged data */
+    size_t fixup_base;       /* the index of the first fixup of the chunk in the merged fixups */
+    vector externals;        /* external_info items, the uses of external labels by the chunk's code */
+    alloc_counters counters[SUBSYSTEM_COUNT];  /* the allocations of the chunk, see split_track */
+} source_chunk;
+
+/* The outcome of merging the chunks */
+typedef enum {
+    CHUNKS_MERGED,    /* the merged tables are ready for the second cycle */
+    CHUNKS_FAILED,    /* errors were found in the chunks, see report_chunks, or memory ran out */
+    CHUNKS_CONFLICT   /* a label of a chunk was defined by an earlier chunk: run the first cycle again */
+} merge_result;
+
+/**
+ * @param source The expanded source.
+ * @param max_chunks The most chunks wanted (e.g., the number of threads).
+ * @return The number of chunks to split the source into, 1 if it is not worth splitting.
+ */
+size_t split_count(const line_buffer* source, size_t max_chunks);
+
+/**
+ * Splits the source into chunks of about the same size, at line boundaries.
+ *
+ * @param source The expanded source.
+ * @param chunks Receives the chunks, released with chunks_free.
+ * @param count The number of chunks, from split_count.
+ */
+void split_source(const line_buffer* source, source_chunk* chunks, size_t count);
+
+/**
+ * Counts the allocations of every chunk in counters of its own, since the chunks are processed on
+ * threads of their own. chunks_free adds them to the given counters.
+ *
+ * @param chunks The chunks.
+ * @param count The number of chunks.
+ */
+void split_track(source_chunk* chunks, size_t count);
+
+/**
+ * Performs the first cycle of a chunk. Chunks can be processed at the same time.
+ *
+ * @param chunk The chunk.
+ */
+void first_cycle_chunk(source_chunk* chunk);
+
+/**
+ * Merges the tables of the chunks after their first cycle, and ends the first cycle of the merged tables.
+ *
+ * @param unit The merged tables, empty.
+ * @param chunks The chunks, in source order.
+ * @param count The number of chunks.
+ * @param diag The diagnostics of the source, for running out of memory.
+ * @return CHUNKS_MERGED, CHUNKS_FAILED or CHUNKS_CONFLICT.
+ */
+merge_result merge_chunks(assembly_unit* unit, source_chunk* chunks, size_t count, diagnostics* diag);
+
+/**
+ * Appends the messages of the chunks to the messages of the source, in source order.
+ *
+ * @param chunks The chunks, in source order.
+ * @param count The number of chunks.
+ * @param diag The diagnostics of the source.
+ */
+void report_chunks(const source_chunk* chunks, size_t count, diagnostics* diag);
+
+/**
+ * Copies the code, data and fixups of a merged chunk into the merged tables and resolves its fixups.
+ * Chunks can be processed at the same time.
+ *
+ * @param chunk The chunk.
+ */
+void second_cycle_chunk(source_chunk* chunk);
+
+/**
+ * Ends the second cycle of the merged tables: marks the entries and collects the externals of the
+ * chunks, in source order. The messages of the chunks are appended to the messages of the source.
+ * When an entry names an external label, the second cycle is run again over the whole source instead,
+ * since a single pass sees such a label as an external only before the `.entry` line.
+ *
+ * @param unit The merged tables.
+ * @param chunks The chunks, in source order.
+ * @param count The number of chunks.
+ * @param diag The diagnostics of the source.
+ * @return 0 on success, 1 if errors were encountered.
+ */
+int close_chunks(assembly_unit* unit, source_chunk* chunks, size_t count, diagnostics* diag);
+
+/**
+ * Releases the memory held by the chunks.
+ *
+ * @param chunks The chunks.
+ * @param count The number of chunks.
+ * @param counters Receives the allocations of the chunks counted since split_track (as if all the
+ *                 chunks reached their peak at the same time), NULL if they were not counted.
+ */
+void chunks_free(source_chunk* chunks, size_t count, alloc_counters* counters);
@@ -0,0 +1,130 @@
+/**
+ * Split assembly driver: runs the steps of the chunks of a large source (see split_assembly.h) on
+ * worker threads, one thread per chunk, and the merge between them on the calling thread.
+ */
+
+/* pthreads are not part of ANSI C, request them from the POSIX headers */
+#define _POSIX_C_SOURCE 200112L
+
+#include "split_driver.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "split_assembly.h"
+
+
+/* A step of a chunk, run on a thread of its own */
+typedef struct {
+    source_chunk* chunk;
+    void (*step)(source_chunk* chunk);
+} chunk_task;
+
+/**
+ * Worker thread: runs the step of a chunk.
+ *
+ * @param arg The task.
+ * @return NULL.
+ */
+void* chunk_worker(void* arg) {
+    chunk_task* task = (chunk_task*)arg;
+
+    task->step(task->chunk);
+    return NULL;
+}
+
+/**
+ * Runs a step on every chunk at the same time, and waits for all of them. The first chunk is
+ * processed on the calling thread; a chunk whose thread cannot be started is processed there too.
+ *
+ * @param chunks The chunks.
+ * @param count The number of chunks.
+ * @param step The step.
+ */
+void run_chunks(source_chunk* chunks, size_t count, void (*step)(source_chunk* chunk)) {
+    chunk_task* tasks = (chunk_task*)malloc(count * sizeof(chunk_task));
+    pthread_t* workers = (pthread_t*)malloc(count * sizeof(pthread_t));
+    int* started = (int*)calloc(count, sizeof(int));
+    size_t i;
+
+    if (tasks && workers && started) {
+        for (i = 1; i < count; i++) {
+            tasks[i].chunk = &chunks[i];
+            tasks[i].step = step;
+            started[i] = pthread_create(&workers[i], NULL, chunk_worker, &tasks[i]) == 0;
+        }
+    }
+    for (i = 0; i < count; i++) {
+        if (!started || !started[i]) {
+            step(&chunks[i]);
+        }
+    }
+    for (i = 1; started && i < count; i++) {
+        if (started[i]) {
+            pthread_join(workers[i], NULL);
+        }
+    }
+    free(tasks);
+    free(workers);
+    free(started);
+}
+
+assembly_result assemble_expanded_split(assembler_context* context, object_file* image, diagnostics* diag,
+                                        assembly_stats* stats, int threads) {
+    size_t count = split_count(&context->source, threads > 1 ? (size_t)threads : 1);
+    source_chunk* chunks;
+    assembly_unit unit;
+    stats_timer timer;
+    int failed = 1;
+
+    chunks = count > 1 ? (source_chunk*)malloc(count * sizeof(source_chunk)) : NULL;
+    if (!chunks) {
+        return assemble_expanded(context, image, diag, stats);
+    }
+
+    memset(image, 0, sizeof(*image));
+    assembly_init(&unit);
+    assembly_track(&unit, stats ? stats->allocations : NULL);
+    split_source(&context->source, chunks, count);
+    if (stats) {
+        split_track(chunks, count);
+    }
+
+    stats_start(&timer);
+    run_chunks(chunks, count, first_cycle_chunk);
+    switch (merge_chunks(&unit, chunks, count, diag)) {
+        case CHUNKS_MERGED:
+            failed = 0;
+            break;
+        case CHUNKS_FAILED:
+            report_chunks(chunks, count, diag);
+            break;
+        case CHUNKS_CONFLICT:
+            /* Report the labels defined again (and whatever follows from them) as a single pass does */
+            assembly_free(&unit);
+            assembly_init(&unit);
+            assembly_track(&unit, stats ? stats->allocations : NULL);
+            first_cycle(&unit, &context->source, diag);
+            break;
+    }
+    stats_stop(stats, FIRST_CYCLE_PHASE, &timer);
+
+    if (!failed) {
+        stats_start(&timer);
+        run_chunks(chunks, count, second_cycle_chunk);
+        failed = close_chunks(&unit, chunks, count, diag);
+        if (!failed && assembly_image(&unit, image)) {
+            report(diag, "Error: Memory allocation failed.\n");
+            failed = 1;
+        }
+        stats_stop(stats, SECOND_CYCLE_PHASE, &timer);
+    }
+    if (stats) {
+        collect_assembly_stats(&unit, stats);
+    }
+    chunks_free(chunks, count, stats ? stats->allocations : NULL);
+    free(chunks);
+    assembly_free(&unit);
+    return failed ? ASSEMBLY_FAILED : ASSEMBLED;
+}
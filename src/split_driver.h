@@ -0,0 +1,18 @@
+#pragma once
+
+#include "libassembler.h"
+
+/**
+ * Assembles the expanded source of the context like assemble_expanded, splitting a large source
+ * (see split_assembly.h) into chunks whose cycles run on up to the given number of threads.
+ * The result and the messages are the same as those of assemble_expanded.
+ *
+ * @param context The assembler context, holding an expanded source.
+ * @param image Receives the image if the source was assembled; empty otherwise. Released with object_file_free.
+ * @param diag Receives the messages of the source.
+ * @param stats Receives the statistics of the source, NULL if statistics are not collected.
+ * @param threads The most threads to use; with 1, or a source too small to split, the source is not split.
+ * @return ASSEMBLED or ASSEMBLY_FAILED.
+ */
+assembly_result assemble_expanded_split(assembler_context* context, object_file* image, diagnostics* diag,
+                                        assembly_stats* stats, int threads);
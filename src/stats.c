@@ -0,0 +1,195 @@
+/**
+ * Assembly statistics: per phase wall and CPU times, counters and table sizes, printed as text
+ * or as JSON lines for the files of a batch and for the batch as a whole.
+ */
+
+/* clock_gettime is not part of ANSI C, request it from the POSIX headers */
+#define _POSIX_C_SOURCE 200112L
+
+#include "stats.h"
+
+#include <string.h>
+#include <time.h>
+
+const char* STATS_PHASE_NAMES[PHASE_COUNT] = {
+    "macro", "first_cycle", "second_cycle", "write_obj", "write_ent", "write_ext"
+};
+
+const char* STATS_SUBSYSTEM_NAMES[SUBSYSTEM_COUNT] = {
+    "macros", "source", "symbols", "data", "code", "externals", "output"
+};
+
+
+/**
+ * @param clock The clock to read.
+ * @return The time of the clock in seconds.
+ */
+double read_clock(clockid_t clock) {
+    struct timespec time;
+
+    if (clock_gettime(clock, &time) != 0) {
+        return 0;
+    }
+    return time.tv_sec + time.tv_nsec / 1e9;
+}
+
+void stats_init(assembly_stats* stats) {
+    memset(stats, 0, sizeof(*stats));
+}
+
+double stats_wall_time(void) {
+    return read_clock(CLOCK_MONOTONIC);
+}
+
+void stats_start(stats_timer* timer) {
+    timer->wall = read_clock(CLOCK_MONOTONIC);
+    timer->cpu = read_clock(CLOCK_THREAD_CPUTIME_ID);
+}
+
+void stats_stop(assembly_stats* stats, stats_phase phase, const stats_timer* timer) {
+    if (stats == NULL) {
+        return;
+    }
+    stats->wall_seconds[phase] += read_clock(CLOCK_MONOTONIC) - timer->wall;
+    stats->cpu_seconds[phase] += read_clock(CLOCK_THREAD_CPUTIME_ID) - timer->cpu;
+}
+
+/**
+ * @param current The current value.
+ * @param value Another value.
+ * @return The larger of the two values.
+ */
+size_t max_bytes(size_t current, size_t value) {
+    return value > current ? value : current;
+}
+
+void stats_add(assembly_stats* total, const assembly_stats* file) {
+    int i;
+
+    total->files += file->files;
+    total->elapsed_seconds += file->elapsed_seconds;
+    for (i = 0; i < PHASE_COUNT; i++) {
+        total->wall_seconds[i] += file->wall_seconds[i];
+        total->cpu_seconds[i] += file->cpu_seconds[i];
+    }
+    total->lines_read += file->lines_read;
+    total->macros_defined += file->macros_defined;
+    total->macros_expanded += file->macros_expanded;
+    total->labels += file->labels;
+    total->data_words += file->data_words;
+    total->code_words += file->code_words;
+    total->unresolved_operands += file->unresolved_operands;
+    total->externals += file->externals;
+    total->label_table_bytes = max_bytes(total->label_table_bytes, file->label_table_bytes);
+    total->data_table_bytes = max_bytes(total->data_table_bytes, file->data_table_bytes);
+    total->code_table_bytes = max_bytes(total->code_table_bytes, file->code_table_bytes);
+    total->externals_table_bytes = max_bytes(total->externals_table_bytes, file->externals_table_bytes);
+    for (i = 0; i < SUBSYSTEM_COUNT; i++) {
+        alloc_counters_add(&total->allocations[i], &file->allocations[i]);
+    }
+}
+
+/**
+ * Prints a string as a JSON string literal.
+ *
+ * @param out The stream to print to.
+ * @param str The string to print.
+ */
+void print_json_string(FILE* out, const char* str) {
+    fputc('"', out);
+    for (; *str; str++) {
+        if (*str == '"' || *str == '\\') {
+            fprintf(out, "\\%c", *str);
+        } else if ((unsigned char)*str < 0x20) {
+            fprintf(out, "\\u%04x", (unsigned char)*str);
+        } else {
+            fputc(*str, out);
+        }
+    }
+    fputc('"', out);
+}
+
+/**
+ * Prints statistics as a single line JSON object.
+ *
+ * @param out The stream to print to.
+ * @param name The name of the file, or NULL for the totals of a batch.
+ * @param stats The statistics to print.
+ */
+void print_json_stats(FILE* out, const char* name, const assembly_stats* stats) {
+    int i;
+
+    fprintf(out, "{");
+    if (name) {
+        fprintf(out, "\"file\":");
+        print_json_string(out, name);
+    } else {
+        fprintf(out, "\"batch\":true,\"files\":%lu", stats->files);
+    }
+    fprintf(out, ",\"elapsed_ms\":%.3f,\"phases\":{", stats->elapsed_seconds * 1000);
+    for (i = 0; i < PHASE_COUNT; i++) {
+        fprintf(out, "%s\"%s\":{\"wall_ms\":%.3f,\"cpu_ms\":%.3f}", i ? "," : "", STATS_PHASE_NAMES[i],
+                stats->wall_seconds[i] * 1000, stats->cpu_seconds[i] * 1000);
+    }
+    fprintf(out, "},\"lines_read\":%lu,\"macros_defined\":%lu,\"macros_expanded\":%lu,\"labels\":%lu,"
+            "\"data_words\":%lu,\"code_words\":%lu,\"unresolved_operands\":%lu,\"externals\":%lu,",
+            stats->lines_read, stats->macros_defined, stats->macros_expanded, stats->labels,
+            stats->data_words, stats->code_words, stats->unresolved_operands, stats->externals);
+    fprintf(out, "\"peak_bytes\":{\"labels\":%lu,\"data\":%lu,\"code\":%lu,\"externals\":%lu},",
+            (unsigned long)stats->label_table_bytes, (unsigned long)stats->data_table_bytes,
+            (unsigned long)stats->code_table_bytes, (unsigned long)stats->externals_table_bytes);
+    fprintf(out, "\"allocations\":{");
+    for (i = 0; i < SUBSYSTEM_COUNT; i++) {
+        const alloc_counters* counters = &stats->allocations[i];
+        fprintf(out, "%s\"%s\":{\"calls\":%lu,\"reallocs\":%lu,\"frees\":%lu,\"bytes\":%lu,"
+                "\"peak_bytes\":%lu,\"live_bytes\":%lu}", i ? "," : "", STATS_SUBSYSTEM_NAMES[i],
+                counters->calls, counters->reallocs, counters->frees, (unsigned long)counters->bytes,
+                (unsigned long)counters->peak_bytes, (unsigned long)counters->live_bytes);
+    }
+    fprintf(out, "}}\n");
+}
+
+/**
+ * Prints statistics as a readable table.
+ *
+ * @param out The stream to print to.
+ * @param name The name of the file, or NULL for the totals of a batch.
+ * @param stats The statistics to print.
+ */
+void print_text_stats(FILE* out, const char* name, const assembly_stats* stats) {
+    int i;
+
+    if (name) {
+        fprintf(out, "Stats for file %s:\n", name);
+    } else {
+        fprintf(out, "Stats for the batch (%lu files):\n", stats->files);
+    }
+    fprintf(out, "  %-14s %12s %12s\n", "phase", "wall ms", "cpu ms");
+    for (i = 0; i < PHASE_COUNT; i++) {
+        fprintf(out, "  %-14s %12.3f %12.3f\n", STATS_PHASE_NAMES[i], stats->wall_seconds[i] * 1000, stats->cpu_seconds[i] * 1000);
+    }
+    fprintf(out, "  %-14s %12.3f\n", "elapsed", stats->elapsed_seconds * 1000);
+    fprintf(out, "  lines read %lu, macros defined %lu, macros expanded %lu, labels %lu\n",
+            stats->lines_read, stats->macros_defined, stats->macros_expanded, stats->labels);
+    fprintf(out, "  data words %lu, code words %lu, unresolved operands %lu, externals %lu\n",
+            stats->data_words, stats->code_words, stats->unresolved_operands, stats->externals);
+    fprintf(out, "  peak table bytes: labels %lu, data %lu, code %lu, externals %lu\n",
+            (unsigned long)stats->label_table_bytes, (unsigned long)stats->data_table_bytes,
+            (unsigned long)stats->code_table_bytes, (unsigned long)stats->externals_table_bytes);
+    fprintf(out, "  %-14s %10s %10s %10s %12s %12s %12s\n", "allocations", "calls", "reallocs", "frees",
+            "bytes", "peak bytes", "live bytes");
+    for (i = 0; i < SUBSYSTEM_COUNT; i++) {
+        const alloc_counters* counters = &stats->allocations[i];
+        fprintf(out, "  %-14s %10lu %10lu %10lu %12lu %12lu %12lu\n", STATS_SUBSYSTEM_NAMES[i],
+                counters->calls, counters->reallocs, counters->frees, (unsigned long)counters->bytes,
+                (unsigned long)counters->peak_bytes, (unsigned long)counters->live_bytes);
+    }
+}
+
+void stats_print(FILE* out, const char* name, const assembly_stats* stats, stats_format format) {
+    if (format == JSON_STATS) {
+        print_json_stats(out, name, stats);
+    } else if (format == TEXT_STATS) {
+        print_text_stats(out, name, stats);
+    }
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "alloc_counters.h"
+
+
+/* How the statistics are printed: as text with the output of each file, or as JSON lines on stderr */
+typedef enum {
+    NO_STATS,
+    TEXT_STATS,
+    JSON_STATS
+} stats_format;
+
+/* The timed phases of assembling a file */
+typedef enum {
+    MACRO_PHASE,
+    FIRST_CYCLE_PHASE,
+    SECOND_CYCLE_PHASE,
+    OBJ_WRITER_PHASE,
+    ENT_WRITER_PHASE,
+    EXT_WRITER_PHASE,
+    PHASE_COUNT
+} stats_phase;
+
+/* Statistics of a single file, or the totals of a batch */
+typedef struct {
+    unsigned long files;
+    double elapsed_seconds;             /* wall time of the whole file (or batch) */
+    double wall_seconds[PHASE_COUNT];
+    double cpu_seconds[PHASE_COUNT];    /* CPU time of the thread doing the work */
+    unsigned long lines_read;
+    unsigned long macros_defined;
+    unsigned long macros_expanded;
+    unsigned long labels;
+    unsigned long data_words;
+    unsigned long code_words;
+    unsigned long unresolved_operands;  /* label operands left for the second cycle */
+    unsigned long externals;            /* uses of external labels */
+    size_t label_table_bytes;           /* the tables only grow, so their final size is their peak */
+    size_t data_table_bytes;
+    size_t code_table_bytes;
+    size_t externals_table_bytes;
+    alloc_counters allocations[SUBSYSTEM_COUNT];  /* the allocations of each subsystem */
+} assembly_stats;
+
+/* The start of a timed phase */
+typedef struct {
+    double wall;
+    double cpu;
+} stats_timer;
+
+/**
+ * Initializes empty statistics.
+ *
+ * @param stats The statistics to initialize.
+ */
+void stats_init(assembly_stats* stats);
+
+/**
+ * Starts timing a phase.
+ *
+ * @param timer The timer to start.
+ */
+void stats_start(stats_timer* timer);
+
+/**
+ * Adds the time since the timer was started to a phase.
+ *
+ * @param stats The statistics, may be NULL when statistics are not collected.
+ * @param phase The phase being timed.
+ * @param timer The timer started at the beginning of the phase.
+ */
+void stats_stop(assembly_stats* stats, stats_phase phase, const stats_timer* timer);
+
+/**
+ * @return The wall clock time in seconds, from an arbitrary starting point.
+ */
+double stats_wall_time(void);
+
+/**
+ * Adds the statistics of a file to the totals of a batch. Times and counters are summed,
+ * table sizes keep the largest value, allocations are added with alloc_counters_add.
+ *
+ * @param total The batch totals.
+ * @param file The statistics of the file.
+ */
+void stats_add(assembly_stats* total, const assembly_stats* file);
+
+/**
+ * Prints statistics.
+ *
+ * @param out The stream to print to.
+ * @param name The name of the file, or NULL for the totals of a batch.
+ * @param stats The statistics to print.
+ * @param format TEXT_STATS or JSON_STATS (one JSON object on a single line).
+ */
+void stats_print(FILE* out, const char* name, const assembly_stats* stats, stats_format format);
@@ -0,0 +1,157 @@
+/**
+ * Streaming driver: assembles a source piped to the standard input and writes everything produced
+ * for it (see stream.h) to the standard output with a single write, so a build can pipe sources
+ * through the assembler without any temporary file.
+ */
+
+#include "stream.h"
+
+#include <stdio.h>
+
+#include "consts.h"
+#include "libassembler.h"
+#include "source_file.h"
+#include "output_buffer.h"
+#include "object_file.h"
+#include "diagnostics.h"
+#include "stats.h"
+#include "split_driver.h"
+
+/* The name of the source in the statistics */
+#define STREAM_SOURCE_NAME "<stdin>"
+
+
+/**
+ * Appends the header line of a section.
+ *
+ * @param stream The result stream.
+ * @param name The name of the section.
+ * @param size The size of the content of the section.
+ */
+void append_section_header(output_buffer* stream, const char* name, unsigned long size) {
+    output_append_string(stream, name);
+    output_append_char(stream, ' ');
+    output_append_decimal(stream, size, 1, '0');
+    output_append_char(stream, '\n');
+}
+
+/**
+ * Appends a section.
+ *
+ * @param stream The result stream.
+ * @param name The name of the section.
+ * @param content The content of the section.
+ * @param size The size of the content.
+ */
+void append_section(output_buffer* stream, const char* name, const char* content, size_t size) {
+    append_section_header(stream, name, size);
+    output_append(stream, content, size);
+}
+
+/**
+ * Appends a section built in its own buffer, and frees the buffer.
+ *
+ * @param stream The result stream.
+ * @param name The name of the section.
+ * @param section The content of the section.
+ */
+void append_buffer_section(output_buffer* stream, const char* name, output_buffer* section) {
+    if (section->failed) {
+        stream->failed = 1;
+    }
+    append_section(stream, name, (const char*)section->text.items, section->text.count);
+    output_buffer_free(section);
+}
+
+/**
+ * Appends the sections of an assembled source: obj, ent and ext, or bin.
+ *
+ * @param stream The result stream.
+ * @param image The object image of the source.
+ * @param format The object format.
+ */
+void append_object_sections(output_buffer* stream, const object_file* image, object_format format) {
+    output_buffer section;
+
+    if (format == BINARY_OBJECT) {
+        append_section_header(stream, "bin", object_binary_size(image));
+        object_append_binary(stream, image);
+        return;
+    }
+
+    output_buffer_init_counted(&section, (image->word_count + 1) * OBJ_LINE_SIZE, image->counters);
+    object_append_obj_text(&section, image);
+    append_buffer_section(stream, "obj", &section);
+
+    output_buffer_init_counted(&section, 0, image->counters);
+    object_append_labels_text(&section, image->entries, image->entry_count);
+    append_buffer_section(stream, "ent", &section);
+
+    output_buffer_init_counted(&section, image->extern_count * (MAX_LABEL_LENGTH + OBJ_LINE_SIZE), image->counters);
+    object_append_labels_text(&section, image->externals, image->extern_count);
+    append_buffer_section(stream, "ext", &section);
+}
+
+int assemble_stream(const assembler_options* options) {
+    assembler_context context;
+    source_file input;
+    object_file image;
+    diagnostics diag;
+    output_buffer stream;
+    assembly_stats stats;
+    assembly_stats* collect = options->stats != NO_STATS ? &stats : NULL;
+    assembly_result result = MACRO_FAILED;
+    stats_timer timer;
+    double start = stats_wall_time();
+    size_t source_size;
+    int status = SUCCESS;
+
+    if (source_file_open_stdin(&input)) {
+        fprintf(stderr, "Error: Could not read the standard input.\n");
+        return 1;
+    }
+    if (collect) {
+        stats_init(collect);
+        collect->files = 1;
+    }
+    assembler_context_init(&context);
+    diagnostics_init(&diag);
+    source_size = input.size;
+
+    if (!expand_source(&context, input.data, input.size, &diag, collect)) {
+        result = assemble_expanded_split(&context, &image, &diag, collect, options->jobs);
+    }
+    source_file_close(&input);
+
+    stats_start(&timer);
+    output_buffer_init_counted(&stream, source_size + diag.text.count,
+                               subsystem_counters(collect ? collect->allocations : NULL, OUTPUT_ALLOCS));
+    output_append_string(&stream, STREAM_MAGIC);
+    if (options->emit_am && result != MACRO_FAILED) {
+        append_section(&stream, "am", (const char*)context.source.text.items, context.source.text.count);
+    }
+    if (result == ASSEMBLED) {
+        append_object_sections(&stream, &image, options->format);
+    }
+    if (result != MACRO_FAILED) {
+        object_file_free(&image);
+    }
+    append_section(&stream, "diagnostics", (const char*)diag.text.items, diag.text.count);
+    output_append_string(&stream, STREAM_END);
+    output_append_string(&stream, result == ASSEMBLED ? " 0\n" : " 1\n");
+
+    if (output_buffer_write_stream(&stream, stdout) || fflush(stdout)) {
+        fprintf(stderr, "Error: Could not write the result stream.\n");
+        status = 1;
+    }
+    output_buffer_free(&stream);
+    stats_stop(collect, OBJ_WRITER_PHASE, &timer);
+
+    if (collect) {
+        collect->elapsed_seconds = stats_wall_time() - start;
+        stats_print(stderr, STREAM_SOURCE_NAME, collect, options->stats);
+    }
+    diagnostics_free(&diag);
+    assembler_context_free(&context);
+    return status;
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "batch.h"
+
+/* The result stream of the streaming mode (`assembler --stream`). It starts with the line
+ *   ASSEMBLER-STREAM 1
+ * followed by sections, each a header line with the name and the size in bytes of the section,
+ * then exactly that many bytes of content:
+ *   <name> <size>\n<content>
+ * The sections are, in this order:
+ *   am            the expanded source, with --emit-am, when the macros were expanded
+ *   obj, ent, ext the content of the .obj, .ent and .ext files, when the source was assembled
+ *   bin           the binary object file instead of obj, ent and ext, with --binary
+ *   diagnostics   the messages of the source, as the assembler prints them
+ * and the stream ends with the line
+ *   end <status>
+ * where the status is 0 if the source was assembled and 1 if errors were found in it.
+ */
+#define STREAM_MAGIC "ASSEMBLER-STREAM 1\n"
+#define STREAM_END "end"
+
+/**
+ * Assembles the source read from the standard input and writes the result stream to the standard
+ * output. No file is opened. Statistics, if enabled, are printed to the standard error.
+ *
+ * @param options The assembler options; the cache is not used, the jobs split a large source.
+ * @return SUCCESS if the result stream was written, 1 if the input could not be read or the output written.
+ */
+int assemble_stream(const assembler_options* options);
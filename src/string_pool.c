@@ -0,0 +1,216 @@
+/**
+ * String interning pool implementation.
+ * The strings are copied into large blocks, so interning a new string is a bump of a pointer
+ * rather than an allocation, and freeing the pool frees a handful of blocks.
+ */
+
+#include "string_pool.h"
+
+#include <string.h>
+
+#include "utils.h"
+#include "consts.h"
+
+#define INITIAL_SLOT_COUNT 64
+#define BLOCK_SIZE 65536
+
+
+/**
+ * Finds the slot holding a string, or the empty slot where it should be inserted.
+ *
+ * @param pool The pool (must have slots allocated).
+ * @param text The string to look for.
+ * @param hash The hash of the string.
+ * @return The index of the matching or empty slot.
+ */
+size_t find_string_slot(const string_pool* pool, const char* text, size_t hash) {
+    size_t mask = pool->slot_count - 1;
+    size_t slot = hash & mask;
+
+    while (pool->slots[slot] != 0) {
+        if (!strcmp(VECTOR_ITEMS(pool->strings, const char*)[pool->slots[slot] - 1], text)) {
+            break;
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    return slot;
+}
+
+/**
+ * Grows the hash index to the given number of slots and rehashes all strings.
+ *
+ * @param pool The pool.
+ * @param slot_count The new number of slots (power of two).
+ * @return SUCCESS on success, MEMORY_ALLOCATION_FAILED on failure.
+ */
+int rehash_strings(string_pool* pool, size_t slot_count) {
+    size_t* old_slots = pool->slots;
+    const char* text;
+    size_t i;
+
+    size_t old_count = pool->slot_count;
+
+    pool->slots = (size_t*)counted_calloc(pool->counters, slot_count, sizeof(size_t));
+    if (!pool->slots) {
+        pool->slots = old_slots;
+        return MEMORY_ALLOCATION_FAILED;
+    }
+    pool->slot_count = slot_count;
+
+    for (i = 0; i < pool->strings.count; i++) {
+        text = VECTOR_ITEMS(pool->strings, const char*)[i];
+        pool->slots[find_string_slot(pool, text, hash_string(text))] = i + 1;
+    }
+
+    counted_free(pool->counters, old_slots, old_count * sizeof(size_t));
+    return SUCCESS;
+}
+
+/**
+ * Copies a string into the arena, starting a new block when the last one is full.
+ *
+ * @param pool The pool.
+ * @param text The string.
+ * @param size The size of the string, including its null terminator.
+ * @return The copy, or NULL on memory allocation failure.
+ */
+char* copy_to_arena(string_pool* pool, const char* text, size_t size) {
+    char* block;
+    char** block_item;
+    size_t block_size;
+    char* copy;
+
+    if (size > pool->free_size) {
+        block_size = size > BLOCK_SIZE ? size : BLOCK_SIZE;
+        block = (char*)counted_malloc(pool->counters, block_size);
+        block_item = (char**)vector_push(&pool->blocks);
+        if (!block || !block_item) {
+            counted_free(pool->counters, block, block_size);
+            if (block_item) {
+                pool->blocks.count--;
+            }
+            return NULL;
+        }
+        *block_item = block;
+        pool->free_space = block;
+        pool->free_size = block_size;
+        pool->arena_bytes += block_size;
+    }
+
+    copy = pool->free_space;
+    memcpy(copy, text, size);
+    pool->free_space += size;
+    pool->free_size -= size;
+    return copy;
+}
+
+void string_pool_init(string_pool* pool) {
+    vector_init(&pool->blocks, sizeof(char*));
+    vector_init(&pool->strings, sizeof(const char*));
+    pool->free_space = NULL;
+    pool->free_size = 0;
+    pool->slots = NULL;
+    pool->slot_count = 0;
+    pool->arena_bytes = 0;
+    pool->counters = NULL;
+}
+
+int string_pool_reserve(string_pool* pool, size_t count) {
+    size_t slot_count = pool->slot_count ? pool->slot_count : INITIAL_SLOT_COUNT;
+
+    if (vector_reserve(&pool->strings, count)) {
+        return MEMORY_ALLOCATION_FAILED;
+    }
+
+    while (count * 2 > slot_count) {
+        slot_count *= 2;
+    }
+    if (slot_count != pool->slot_count) {
+        return rehash_strings(pool, slot_count);
+    }
+    return SUCCESS;
+}
+
+int string_pool_intern(string_pool* pool, const char* text, size_t* string_id) {
+    size_t length = strlen(text);
+    size_t hash = hash_bytes(text, length);
+    size_t slot;
+    const char** string;
+
+    /* Keep the load factor at or below 1/2 */
+    if ((pool->strings.count + 1) * 2 > pool->slot_count) {
+        if (rehash_strings(pool, pool->slot_count ? pool->slot_count * 2 : INITIAL_SLOT_COUNT)) {
+            return MEMORY_ALLOCATION_FAILED;
+        }
+    }
+
+    slot = find_string_slot(pool, text, hash);
+    if (pool->slots[slot] != 0) {
+        *string_id = pool->slots[slot] - 1;
+        return SUCCESS;
+    }
+
+    string = (const char**)vector_push(&pool->strings);
+    if (!string) {
+        return MEMORY_ALLOCATION_FAILED;
+    }
+    *string = copy_to_arena(pool, text, length + 1);
+    if (!*string) {
+        pool->strings.count--;
+        return MEMORY_ALLOCATION_FAILED;
+    }
+
+    *string_id = pool->strings.count - 1;
+    pool->slots[slot] = *string_id + 1;
+    return SUCCESS;
+}
+
+int string_pool_find(const string_pool* pool, const char* text, size_t* string_id) {
+    size_t slot;
+
+    if (pool->strings.count == 0) {
+        return 0;
+    }
+
+    slot = find_string_slot(pool, text, hash_string(text));
+    if (pool->slots[slot] == 0) {
+        return 0;
+    }
+    *string_id = pool->slots[slot] - 1;
+    return 1;
+}
+
+const char* string_pool_get(const string_pool* pool, size_t string_id) {
+    return VECTOR_ITEMS(pool->strings, const char*)[string_id];
+}
+
+size_t string_pool_count(const string_pool* pool) {
+    return pool->strings.count;
+}
+
+size_t string_pool_bytes(const string_pool* pool) {
+    return pool->arena_bytes + vector_bytes(&pool->blocks) + vector_bytes(&pool->strings) +
+           pool->slot_count * sizeof(size_t);
+}
+
+void string_pool_track(string_pool* pool, alloc_counters* counters) {
+    pool->counters = counters;
+    count_held(counters, pool->arena_bytes + pool->slot_count * sizeof(size_t));
+    vector_track(&pool->blocks, counters);
+    vector_track(&pool->strings, counters);
+}
+
+void string_pool_free(string_pool* pool) {
+    size_t i;
+
+    for (i = 0; i < pool->blocks.count; i++) {
+        free(VECTOR_ITEMS(pool->blocks, char*)[i]);
+    }
+    /* Only the size of all the blocks together is known */
+    count_frees(pool->counters, pool->blocks.count, pool->arena_bytes);
+    vector_free(&pool->blocks);
+    vector_free(&pool->strings);
+    counted_free(pool->counters, pool->slots, pool->slot_count * sizeof(size_t));
+    string_pool_init(pool);
+}
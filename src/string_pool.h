@@ -0,0 +1,93 @@
+#pragma once
+
+#include <stdlib.h>
+
+#include "vector.h"
+
+
+/* String interning pool: every distinct string is stored once, in blocks of an arena, and gets a
+ * string id numbering the distinct strings in the order they were first interned. The strings never
+ * move, so the pointers handed out stay valid until the pool is freed. Strings are indexed by an
+ * open-addressing hash for constant time interning and lookups.
+ */
+typedef struct {
+    vector blocks;       /* char* items, the blocks of the arena */
+    char* free_space;    /* the unused end of the last block */
+    size_t free_size;    /* the size of the unused end of the last block */
+    vector strings;      /* const char* items, indexed by string id */
+    size_t* slots;       /* hash index, each slot holds (string id + 1) or 0 if empty */
+    size_t slot_count;   /* number of slots, always a power of two */
+    size_t arena_bytes;  /* the size of all the blocks */
+    alloc_counters* counters;  /* where the allocations are counted, NULL if they are not */
+} string_pool;
+
+/**
+ * Initializes an empty pool. No memory is allocated until the first string is interned.
+ *
+ * @param pool The pool to initialize.
+ */
+void string_pool_init(string_pool* pool);
+
+/**
+ * Reserves room in the hash index for a number of strings, so interning up to that many strings does not rehash.
+ *
+ * @param pool The pool.
+ * @param count The expected number of distinct strings.
+ * @return SUCCESS on success, MEMORY_ALLOCATION_FAILED on failure.
+ */
+int string_pool_reserve(string_pool* pool, size_t count);
+
+/**
+ * Interns a string: finds it in the pool or adds a copy of it.
+ *
+ * @param pool The pool.
+ * @param text The null-terminated string.
+ * @param string_id Receives the string id.
+ * @return SUCCESS on success, MEMORY_ALLOCATION_FAILED on failure.
+ */
+int string_pool_intern(string_pool* pool, const char* text, size_t* string_id);
+
+/**
+ * Finds a string without adding it.
+ *
+ * @param pool The pool.
+ * @param text The null-terminated string.
+ * @param string_id Receives the string id if the string is in the pool.
+ * @return 1 if the string is in the pool, 0 otherwise.
+ */
+int string_pool_find(const string_pool* pool, const char* text, size_t* string_id);
+
+/**
+ * @param pool The pool.
+ * @param string_id A string id given by the pool.
+ * @return The interned string.
+ */
+const char* string_pool_get(const string_pool* pool, size_t string_id);
+
+/**
+ * @param pool The pool.
+ * @return The number of distinct strings in the pool.
+ */
+size_t string_pool_count(const string_pool* pool);
+
+/**
+ * @param pool The pool.
+ * @return The number of bytes allocated by the pool.
+ */
+size_t string_pool_bytes(const string_pool* pool);
+
+/**
+ * Counts the allocations of the pool in the given counters from now on. The memory the pool
+ * already holds is counted as held there.
+ *
+ * @param pool The pool.
+ * @param counters The counters, NULL to stop counting.
+ */
+void string_pool_track(string_pool* pool, alloc_counters* counters);
+
+/**
+ * Releases all memory held by the pool and leaves it empty, no longer counted.
+ *
+ * @param pool The pool to free.
+ */
+void string_pool_free(string_pool* pool);
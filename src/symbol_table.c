@@ -0,0 +1,128 @@
+/**
+ * Symbol table implementation.
+ * Labels are stored in an array indexed by symbol id; the names are interned in a string pool whose
+ * hash index finds the symbol id of a name, so inserts and lookups do not depend on the number of labels.
+ */
+
+#include "symbol_table.h"
+
+#include <string.h>
+
+#include "consts.h"
+
+
+/**
+ * Finds a label by its name, adding it as an undefined label if it is not in the table yet.
+ * The symbol id of a label is the string id of its name.
+ * 
+ * @param table The symbol table.
+ * @param name The label name.
+ * @param symbol_id Receives the symbol id of the label.
+ * @return SUCCESS on success, MEMORY_ALLOCATION_FAILED on failure.
+ */
+int find_or_add(symbol_table* table, const char* name, size_t* symbol_id) {
+    label_element* label;
+
+    if (string_pool_intern(&table->names, name, symbol_id)) {
+        return MEMORY_ALLOCATION_FAILED;
+    }
+    if (*symbol_id < table->labels.count) {
+        return SUCCESS;
+    }
+
+    label = (label_element*)vector_push(&table->labels);
+    if (!label) {
+        return MEMORY_ALLOCATION_FAILED;
+    }
+    label->address = 0;
+    label->label_type = undefined_label;
+    label->label_name = string_pool_get(&table->names, *symbol_id);
+    return SUCCESS;
+}
+
+void symbol_table_init(symbol_table* table) {
+    string_pool_init(&table->names);
+    vector_init(&table->labels, sizeof(label_element));
+    vector_init(&table->definitions, sizeof(size_t));
+}
+
+int symbol_table_reserve(symbol_table* table, size_t count) {
+    if (string_pool_reserve(&table->names, count) || vector_reserve(&table->labels, count) ||
+        vector_reserve(&table->definitions, count)) {
+        return MEMORY_ALLOCATION_FAILED;
+    }
+    return SUCCESS;
+}
+
+int symbol_table_insert(symbol_table* table, const char* name, int address, label_options label_type) {
+    size_t symbol_id;
+    size_t* definition;
+    label_element* label;
+
+    if (find_or_add(table, name, &symbol_id)) {
+        return MEMORY_ALLOCATION_FAILED;
+    }
+
+    label = symbol_table_get(table, symbol_id);
+    if (label->label_type != undefined_label) {
+        return SUCCESS;  /* already defined, the first definition wins */
+    }
+
+    definition = (size_t*)vector_push(&table->definitions);
+    if (!definition) {
+        return MEMORY_ALLOCATION_FAILED;
+    }
+    *definition = symbol_id;
+
+    label->address = address;
+    label->label_type = label_type;
+    return SUCCESS;
+}
+
+int symbol_table_reference(symbol_table* table, const char* name, size_t* symbol_id) {
+    return find_or_add(table, name, symbol_id);
+}
+
+label_element* symbol_table_lookup(const symbol_table* table, const char* name) {
+    size_t symbol_id;
+    label_element* label;
+
+    if (!string_pool_find(&table->names, name, &symbol_id)) {
+        return NULL;
+    }
+    label = symbol_table_get(table, symbol_id);
+    return label->label_type != undefined_label ? label : NULL;
+}
+
+label_element* symbol_table_get(const symbol_table* table, size_t symbol_id) {
+    return &VECTOR_ITEMS(table->labels, label_element)[symbol_id];
+}
+
+size_t symbol_table_count(const symbol_table* table) {
+    return table->definitions.count;
+}
+
+size_t symbol_table_id_count(const symbol_table* table) {
+    return table->labels.count;
+}
+
+label_element* symbol_table_at(const symbol_table* table, size_t index) {
+    return symbol_table_get(table, VECTOR_ITEMS(table->definitions, size_t)[index]);
+}
+
+size_t symbol_table_bytes(const symbol_table* table) {
+    return string_pool_bytes(&table->names) + vector_bytes(&table->labels) + vector_bytes(&table->definitions);
+}
+
+void symbol_table_track(symbol_table* table, alloc_counters* counters) {
+    string_pool_track(&table->names, counters);
+    vector_track(&table->labels, counters);
+    vector_track(&table->definitions, counters);
+}
+
+void symbol_table_free(symbol_table* table) {
+    string_pool_free(&table->names);
+    vector_free(&table->labels);
+    vector_free(&table->definitions);
+    symbol_table_init(table);
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <stdlib.h>
+
+#include "data_structs.h"
+#include "vector.h"
+#include "string_pool.h"
+
+
+/* Symbol table: every label gets a symbol id when it is first defined or referenced, so references
+ * to labels that are defined later (e.g., in the fixup list) can point at their future entry.
+ * The label names are interned in a string pool, which stores each name once and finds it in constant
+ * time; the symbol id of a label is the string id of its name. The definition order is kept for
+ * writing the entries file.
+ */
+typedef struct {
+    string_pool names;   /* the label names, string ids are symbol ids */
+    vector labels;       /* label_element items, indexed by symbol id */
+    vector definitions;  /* size_t items, the symbol ids of the defined labels in definition order */
+} symbol_table;
+
+/**
+ * Initializes an empty symbol table. No memory is allocated until the first insert.
+ * 
+ * @param table The symbol table to initialize.
+ */
+void symbol_table_init(symbol_table* table);
+
+/**
+ * Reserves room for a number of labels, so filling the table up to that size does not reallocate.
+ * 
+ * @param table The symbol table.
+ * @param count The expected number of labels (e.g., the number of lines in the source file).
+ * @return SUCCESS on success, MEMORY_ALLOCATION_FAILED on failure.
+ */
+int symbol_table_reserve(symbol_table* table, size_t count);
+
+/**
+ * Defines a label. If the label was only referenced so far, its symbol id is kept.
+ * Defining a label that is already defined keeps the first definition; the caller is
+ * responsible for reporting duplicates.
+ * 
+ * @param table The symbol table.
+ * @param name The label name, interned in the table.
+ * @param address The address associated with the label.
+ * @param label_type The type of the label (e.g., data, code, extern).
+ * @return SUCCESS on success, MEMORY_ALLOCATION_FAILED on failure.
+ */
+int symbol_table_insert(symbol_table* table, const char* name, int address, label_options label_type);
+
+/**
+ * Gets the symbol id of a label, adding it as an undefined label if it is not in the table yet.
+ * 
+ * @param table The symbol table.
+ * @param name The label name.
+ * @param symbol_id Receives the symbol id of the label.
+ * @return SUCCESS on success, MEMORY_ALLOCATION_FAILED on failure.
+ */
+int symbol_table_reference(symbol_table* table, const char* name, size_t* symbol_id);
+
+/**
+ * Finds a defined label by its name.
+ * 
+ * @param table The symbol table.
+ * @param name The label name to look for.
+ * @return Pointer to the label, or NULL if no such label is defined.
+ */
+label_element* symbol_table_lookup(const symbol_table* table, const char* name);
+
+/**
+ * @param table The symbol table.
+ * @param symbol_id The symbol id of the label.
+ * @return Pointer to the label; its type is undefined_label if it was referenced but never defined.
+ */
+label_element* symbol_table_get(const symbol_table* table, size_t symbol_id);
+
+/**
+ * @param table The symbol table.
+ * @return The number of defined labels.
+ */
+size_t symbol_table_count(const symbol_table* table);
+
+/**
+ * @param table The symbol table.
+ * @return The number of symbol ids given out, to labels defined or only referenced (0 to count - 1).
+ */
+size_t symbol_table_id_count(const symbol_table* table);
+
+/**
+ * @param table The symbol table.
+ * @param index The index of the label in definition order (0 to symbol_table_count - 1).
+ * @return Pointer to the label.
+ */
+label_element* symbol_table_at(const symbol_table* table, size_t index);
+
+/**
+ * @param table The symbol table.
+ * @return The number of bytes allocated by the table, including the label names.
+ */
+size_t symbol_table_bytes(const symbol_table* table);
+
+/**
+ * Counts the allocations of the symbol table, label names included, in the given counters from now on.
+ * The memory the table already holds is counted as held there.
+ * 
+ * @param table The symbol table.
+ * @param counters The counters, NULL to stop counting.
+ */
+void symbol_table_track(symbol_table* table, alloc_counters* counters);
+
+/**
+ * Releases all memory held by the symbol table and leaves it empty.
+ * 
+ * @param table The symbol table to free.
+ */
+void symbol_table_free(symbol_table* table);
@@ -1,8 +1,8 @@
 #include "utils.h"
+#include "consts.h"
 
 #include <stdio.h>
 #include <string.h>
-#include <ctype.h>
 
 void copy_filename_with_different_extension(const char* source_filename, char* target_filename, const char* extension) {
     int len = strlen(source_filename);
@@ -31,67 +31,39 @@ void copy_filename_with_different_extension(const char* source_filename, char* t
     return;
 }
 
-void strip_whitespace(char *str) {
-    int i;
-    int start = 0;
-    int end = strlen(str) - 1;
-
-    /* Trim leading whitespace */
-    while (isspace((unsigned char)str[start])) {
-        start++;
-    }
+const keyword* find_keyword(const char* name) {
+    size_t length = strlen(name);
+    const keyword* entry;
 
-    /* Trim trailing whitespace */
-    while (end > start && isspace((unsigned char)str[end])) {
-        end--;
+    if (length == 0) {
+        return NULL;
     }
-
-    /* Shift characters forward */
-    for (i = 0; i <= end - start; i++) {
-        str[i] = str[start + i];
+    entry = &KEYWORD_TABLE[KEYWORD_HASH(name, length)];
+    if (entry->kind == NO_KEYWORD || strcmp(name, entry->name)) {
+        return NULL;
     }
-    str[i] = '\0'; /* Null-terminate the string */
+    return entry;
 }
 
-int is_consecutive(char* str, char search_str) {
-    int flag = 0;
-    while (*str) {
-        if (*str == search_str) {
-            if (flag) {
-                return 1;
-            }
-            flag = 1;
-        } else if (!isspace(*str)) {
-            flag = 0;
-        }
-        str++;
-    }
-    return 0;
+int is_reserved_word(const char* name) {
+    const keyword* entry = find_keyword(name);
+
+    /* Directives start with a dot, so they are never taken as names */
+    return entry != NULL && entry->kind != DIRECTIVE_KEYWORD;
 }
 
-int is_reserved_word(const char* name) {
-    char* reserved_words[] = {
-        "stop", "rts", "prn", "red", "jsr", "bne", "jmp", 
-        "dec", "inc", "not", "clr", "lea", "sub", "add", "cmp", "mov", "mcro", "mcroend"
-    };
-    int i;
-    int num_reserved = sizeof(reserved_words) / sizeof(reserved_words[0]);
-    
-    for (i = 0; i < num_reserved; i++) {
-        if (strcmp(name, reserved_words[i]) == 0) {
-            return 1;
-        }
+size_t hash_bytes(const char* data, size_t length) {
+    unsigned long hash = 2166136261UL;
+    size_t i;
+
+    for (i = 0; i < length; i++) {
+        hash ^= (unsigned char)data[i];
+        hash = (hash * 16777619UL) & 0xFFFFFFFFUL;
     }
-    
-    return 0;
+
+    return (size_t)hash;
 }
 
-int extend_array(void** array, size_t* current_size, size_t new_size, size_t element_size) {
-    void* new_array = realloc(*array, new_size * element_size);
-    if (!new_array) {
-        return 1; /* Memory allocation failed */
-    }
-    *array = new_array;
-    *current_size = new_size;
-    return 0; /* Success */
+size_t hash_string(const char* str) {
+    return hash_bytes(str, strlen(str));
 }
\ No newline at end of file
@@ -2,6 +2,8 @@
 
 #include <stdlib.h>
 
+#include "data_structs.h"
+
 
 /**
  * Copies the filename from the source filename into the target filename with a different extension.
@@ -13,20 +15,12 @@
 void copy_filename_with_different_extension(const char* source_filename, char* target_filename, const char* extension);
 
 /**
- * Removes leading and trailing whitespace from a string.
- * 
- * @param str The string to be stripped of whitespace. The operation is performed in-place.
- */
-void strip_whitespace(char *str);
-
-/**
- * Checks if a character appears consecutively in a string, ignoring spaces in between.
+ * Looks up a word in the keyword table (mnemonics, directives and macro keywords).
  * 
- * @param str The string to search.
- * @param search_str The character to look for.
- * @return 1 if the character appears consecutively, 0 otherwise.
+ * @param name The word to look up.
+ * @return The keyword entry, or NULL if the word is not a keyword.
  */
-int is_consecutive(char* str, char search_str);
+const keyword* find_keyword(const char* name);
 
 /**
  * Checks if a given name is a reserved word.
@@ -37,12 +31,18 @@ int is_consecutive(char* str, char search_str);
 int is_reserved_word(const char* name);
 
 /**
- * Checks if a given label is valid according to assembler rules.
+ * Computes a hash value for a string (FNV-1a), used by the hash based tables.
+ * 
+ * @param str The null-terminated string to hash.
+ * @return The hash value of the string.
+ */
+size_t hash_string(const char* str);
+
+/**
+ * Computes the hash value of a block of bytes, the same way `hash_string` hashes a string.
  * 
- * @param array The array to extend.
- * @param current_size The current size of the array.
- * @param new_size The new size of the array.
- * @param element_size The size of each element in the array.
- * @return 0 on success, 1 on failure.
+ * @param data The bytes to hash.
+ * @param length The number of bytes.
+ * @return The hash value of the bytes.
  */
-int extend_array(void** array, size_t* current_size, size_t new_size, size_t element_size);
\ No newline at end of file
+size_t hash_bytes(const char* data, size_t length);
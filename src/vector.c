@@ -0,0 +1,67 @@
+#include "vector.h"
+
+#include "consts.h"
+
+#define VECTOR_MIN_CAPACITY 16
+
+
+void vector_init(vector* vec, size_t element_size) {
+    vec->items = NULL;
+    vec->count = 0;
+    vec->capacity = 0;
+    vec->element_size = element_size;
+    vec->counters = NULL;
+}
+
+int vector_reserve(vector* vec, size_t capacity) {
+    void* new_items;
+
+    if (capacity <= vec->capacity) {
+        return SUCCESS;
+    }
+
+    new_items = counted_realloc(vec->counters, vec->items, vector_bytes(vec), capacity * vec->element_size);
+    if (!new_items) {
+        return MEMORY_ALLOCATION_FAILED;
+    }
+    vec->items = new_items;
+    vec->capacity = capacity;
+    return SUCCESS;
+}
+
+void* vector_extend(vector* vec, size_t amount) {
+    size_t needed = vec->count + amount;
+    size_t new_capacity = vec->capacity ? vec->capacity : VECTOR_MIN_CAPACITY;
+    void* first;
+
+    if (needed > vec->capacity) {
+        while (new_capacity < needed) {
+            new_capacity *= 2;
+        }
+        if (vector_reserve(vec, new_capacity)) {
+            return NULL;
+        }
+    }
+
+    first = (char*)vec->items + vec->count * vec->element_size;
+    vec->count = needed;
+    return first;
+}
+
+void* vector_push(vector* vec) {
+    return vector_extend(vec, 1);
+}
+
+size_t vector_bytes(const vector* vec) {
+    return vec->capacity * vec->element_size;
+}
+
+void vector_track(vector* vec, alloc_counters* counters) {
+    vec->counters = counters;
+    count_held(counters, vector_bytes(vec));
+}
+
+void vector_free(vector* vec) {
+    counted_free(vec->counters, vec->items, vector_bytes(vec));
+    vector_init(vec, vec->element_size);
+}
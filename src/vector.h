@@ -0,0 +1,76 @@
+#pragma once
+
+#include <stdlib.h>
+
+#include "alloc_counters.h"
+
+/* Typed access to the elements of a vector */
+#define VECTOR_ITEMS(vec, type) ((type*)(vec).items)
+
+
+/* Growable array with capacity tracking. The capacity grows geometrically (doubling),
+ * so appending n elements costs O(n) copies and O(log n) reallocations in total.
+ */
+typedef struct {
+    void* items;          /* the elements, contiguous in memory */
+    size_t count;         /* number of elements in use */
+    size_t capacity;      /* number of elements allocated */
+    size_t element_size;  /* size of each element in bytes */
+    alloc_counters* counters;  /* where the allocations are counted, NULL if they are not */
+} vector;
+
+/**
+ * Initializes an empty vector. No memory is allocated until elements are added or reserved.
+ * 
+ * @param vec The vector to initialize.
+ * @param element_size The size of each element in bytes.
+ */
+void vector_init(vector* vec, size_t element_size);
+
+/**
+ * Makes sure the vector can hold at least the given number of elements without reallocating.
+ * 
+ * @param vec The vector.
+ * @param capacity The number of elements to reserve room for (e.g., a size hint from the input).
+ * @return SUCCESS on success, MEMORY_ALLOCATION_FAILED on failure.
+ */
+int vector_reserve(vector* vec, size_t capacity);
+
+/**
+ * Appends uninitialized elements to the end of the vector.
+ * 
+ * @param vec The vector.
+ * @param amount The number of elements to append.
+ * @return Pointer to the first appended element, or NULL if memory allocation failed.
+ */
+void* vector_extend(vector* vec, size_t amount);
+
+/**
+ * Appends a single uninitialized element to the end of the vector.
+ * 
+ * @param vec The vector.
+ * @return Pointer to the appended element, or NULL if memory allocation failed.
+ */
+void* vector_push(vector* vec);
+
+/**
+ * @param vec The vector.
+ * @return The number of bytes allocated for the elements of the vector.
+ */
+size_t vector_bytes(const vector* vec);
+
+/**
+ * Counts the allocations of the vector in the given counters from now on. The memory the vector
+ * already holds is counted as held there.
+ * 
+ * @param vec The vector.
+ * @param counters The counters, NULL to stop counting.
+ */
+void vector_track(vector* vec, alloc_counters* counters);
+
+/**
+ * Releases the memory held by the vector and leaves it empty, no longer counted.
+ * 
+ * @param vec The vector to free.
+ */
+void vector_free(vector* vec);
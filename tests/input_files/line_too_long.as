@@ -0,0 +1,4 @@
+; a statement longer than the limit is reported once, not split into two lines
+MAIN: mov r1, r2
+LONG: .data 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22
+stop
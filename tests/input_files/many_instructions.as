@@ -0,0 +1,1205 @@
+; more than 1000 instructions (used to overflow the fixed size code array)
+.entry LAST
+.extern OUT
+L0: add #0, r0
+ jmp &L0
+L2: add #2, r2
+ jmp &L2
+L4: add #4, r4
+ jmp &L4
+L6: add #6, r6
+ jmp &L6
+L8: add #8, r0
+ jmp &L8
+L10: add #10, r2
+ jmp &L10
+L12: add #12, r4
+ jmp &L12
+L14: add #14, r6
+ jmp &L14
+L16: add #16, r0
+ jmp &L16
+L18: add #18, r2
+ jmp &L18
+L20: add #20, r4
+ jmp &L20
+L22: add #22, r6
+ jmp &L22
+L24: add #24, r0
+ jmp &L24
+L26: add #26, r2
+ jmp &L26
+L28: add #28, r4
+ jmp &L28
+L30: add #30, r6
+ jmp &L30
+L32: add #32, r0
+ jmp &L32
+L34: add #34, r2
+ jmp &L34
+L36: add #36, r4
+ jmp &L36
+L38: add #38, r6
+ jmp &L38
+L40: add #40, r0
+ jmp &L40
+L42: add #42, r2
+ jmp &L42
+L44: add #44, r4
+ jmp &L44
+L46: add #46, r6
+ jmp &L46
+L48: add #48, r0
+ jmp &L48
+L50: add #50, r2
+ jmp &L50
+L52: add #52, r4
+ jmp &L52
+L54: add #54, r6
+ jmp &L54
+L56: add #56, r0
+ jmp &L56
+L58: add #58, r2
+ jmp &L58
+L60: add #60, r4
+ jmp &L60
+L62: add #62, r6
+ jmp &L62
+L64: add #64, r0
+ jmp &L64
+L66: add #66, r2
+ jmp &L66
+L68: add #68, r4
+ jmp &L68
+L70: add #70, r6
+ jmp &L70
+L72: add #72, r0
+ jmp &L72
+L74: add #74, r2
+ jmp &L74
+L76: add #76, r4
+ jmp &L76
+L78: add #78, r6
+ jmp &L78
+L80: add #80, r0
+ jmp &L80
+L82: add #82, r2
+ jmp &L82
+L84: add #84, r4
+ jmp &L84
+L86: add #86, r6
+ jmp &L86
+L88: add #88, r0
+ jmp &L88
+L90: add #90, r2
+ jmp &L90
+L92: add #92, r4
+ jmp &L92
+L94: add #94, r6
+ jmp &L94
+L96: add #96, r0
+ jmp &L96
+L98: add #98, r2
+ jmp &L98
+L100: add #100, r4
+ jmp &L100
+L102: add #102, r6
+ jmp &L102
+L104: add #104, r0
+ jmp &L104
+L106: add #106, r2
+ jmp &L106
+L108: add #108, r4
+ jmp &L108
+L110: add #110, r6
+ jmp &L110
+L112: add #112, r0
+ jmp &L112
+L114: add #114, r2
+ jmp &L114
+L116: add #116, r4
+ jmp &L116
+L118: add #118, r6
+ jmp &L118
+L120: add #120, r0
+ jmp &L120
+L122: add #122, r2
+ jmp &L122
+L124: add #124, r4
+ jmp &L124
+L126: add #126, r6
+ jmp &L126
+L128: add #128, r0
+ jmp &L128
+L130: add #130, r2
+ jmp &L130
+L132: add #132, r4
+ jmp &L132
+L134: add #134, r6
+ jmp &L134
+L136: add #136, r0
+ jmp &L136
+L138: add #138, r2
+ jmp &L138
+L140: add #140, r4
+ jmp &L140
+L142: add #142, r6
+ jmp &L142
+L144: add #144, r0
+ jmp &L144
+L146: add #146, r2
+ jmp &L146
+L148: add #148, r4
+ jmp &L148
+L150: add #150, r6
+ jmp &L150
+L152: add #152, r0
+ jmp &L152
+L154: add #154, r2
+ jmp &L154
+L156: add #156, r4
+ jmp &L156
+L158: add #158, r6
+ jmp &L158
+L160: add #160, r0
+ jmp &L160
+L162: add #162, r2
+ jmp &L162
+L164: add #164, r4
+ jmp &L164
+L166: add #166, r6
+ jmp &L166
+L168: add #168, r0
+ jmp &L168
+L170: add #170, r2
+ jmp &L170
+L172: add #172, r4
+ jmp &L172
+L174: add #174, r6
+ jmp &L174
+L176: add #176, r0
+ jmp &L176
+L178: add #178, r2
+ jmp &L178
+L180: add #180, r4
+ jmp &L180
+L182: add #182, r6
+ jmp &L182
+L184: add #184, r0
+ jmp &L184
+L186: add #186, r2
+ jmp &L186
+L188: add #188, r4
+ jmp &L188
+L190: add #190, r6
+ jmp &L190
+L192: add #192, r0
+ jmp &L192
+L194: add #194, r2
+ jmp &L194
+L196: add #196, r4
+ jmp &L196
+L198: add #198, r6
+ jmp &L198
+L200: add #200, r0
+ jmp &L200
+L202: add #202, r2
+ jmp &L202
+L204: add #204, r4
+ jmp &L204
+L206: add #206, r6
+ jmp &L206
+L208: add #208, r0
+ jmp &L208
+L210: add #210, r2
+ jmp &L210
+L212: add #212, r4
+ jmp &L212
+L214: add #214, r6
+ jmp &L214
+L216: add #216, r0
+ jmp &L216
+L218: add #218, r2
+ jmp &L218
+L220: add #220, r4
+ jmp &L220
+L222: add #222, r6
+ jmp &L222
+L224: add #224, r0
+ jmp &L224
+L226: add #226, r2
+ jmp &L226
+L228: add #228, r4
+ jmp &L228
+L230: add #230, r6
+ jmp &L230
+L232: add #232, r0
+ jmp &L232
+L234: add #234, r2
+ jmp &L234
+L236: add #236, r4
+ jmp &L236
+L238: add #238, r6
+ jmp &L238
+L240: add #240, r0
+ jmp &L240
+L242: add #242, r2
+ jmp &L242
+L244: add #244, r4
+ jmp &L244
+L246: add #246, r6
+ jmp &L246
+L248: add #248, r0
+ jmp &L248
+L250: add #250, r2
+ jmp &L250
+L252: add #252, r4
+ jmp &L252
+L254: add #254, r6
+ jmp &L254
+L256: add #256, r0
+ jmp &L256
+L258: add #258, r2
+ jmp &L258
+L260: add #260, r4
+ jmp &L260
+L262: add #262, r6
+ jmp &L262
+L264: add #264, r0
+ jmp &L264
+L266: add #266, r2
+ jmp &L266
+L268: add #268, r4
+ jmp &L268
+L270: add #270, r6
+ jmp &L270
+L272: add #272, r0
+ jmp &L272
+L274: add #274, r2
+ jmp &L274
+L276: add #276, r4
+ jmp &L276
+L278: add #278, r6
+ jmp &L278
+L280: add #280, r0
+ jmp &L280
+L282: add #282, r2
+ jmp &L282
+L284: add #284, r4
+ jmp &L284
+L286: add #286, r6
+ jmp &L286
+L288: add #288, r0
+ jmp &L288
+L290: add #290, r2
+ jmp &L290
+L292: add #292, r4
+ jmp &L292
+L294: add #294, r6
+ jmp &L294
+L296: add #296, r0
+ jmp &L296
+L298: add #298, r2
+ jmp &L298
+L300: add #300, r4
+ jmp &L300
+L302: add #302, r6
+ jmp &L302
+L304: add #304, r0
+ jmp &L304
+L306: add #306, r2
+ jmp &L306
+L308: add #308, r4
+ jmp &L308
+L310: add #310, r6
+ jmp &L310
+L312: add #312, r0
+ jmp &L312
+L314: add #314, r2
+ jmp &L314
+L316: add #316, r4
+ jmp &L316
+L318: add #318, r6
+ jmp &L318
+L320: add #320, r0
+ jmp &L320
+L322: add #322, r2
+ jmp &L322
+L324: add #324, r4
+ jmp &L324
+L326: add #326, r6
+ jmp &L326
+L328: add #328, r0
+ jmp &L328
+L330: add #330, r2
+ jmp &L330
+L332: add #332, r4
+ jmp &L332
+L334: add #334, r6
+ jmp &L334
+L336: add #336, r0
+ jmp &L336
+L338: add #338, r2
+ jmp &L338
+L340: add #340, r4
+ jmp &L340
+L342: add #342, r6
+ jmp &L342
+L344: add #344, r0
+ jmp &L344
+L346: add #346, r2
+ jmp &L346
+L348: add #348, r4
+ jmp &L348
+L350: add #350, r6
+ jmp &L350
+L352: add #352, r0
+ jmp &L352
+L354: add #354, r2
+ jmp &L354
+L356: add #356, r4
+ jmp &L356
+L358: add #358, r6
+ jmp &L358
+L360: add #360, r0
+ jmp &L360
+L362: add #362, r2
+ jmp &L362
+L364: add #364, r4
+ jmp &L364
+L366: add #366, r6
+ jmp &L366
+L368: add #368, r0
+ jmp &L368
+L370: add #370, r2
+ jmp &L370
+L372: add #372, r4
+ jmp &L372
+L374: add #374, r6
+ jmp &L374
+L376: add #376, r0
+ jmp &L376
+L378: add #378, r2
+ jmp &L378
+L380: add #380, r4
+ jmp &L380
+L382: add #382, r6
+ jmp &L382
+L384: add #384, r0
+ jmp &L384
+L386: add #386, r2
+ jmp &L386
+L388: add #388, r4
+ jmp &L388
+L390: add #390, r6
+ jmp &L390
+L392: add #392, r0
+ jmp &L392
+L394: add #394, r2
+ jmp &L394
+L396: add #396, r4
+ jmp &L396
+L398: add #398, r6
+ jmp &L398
+L400: add #400, r0
+ jmp &L400
+L402: add #402, r2
+ jmp &L402
+L404: add #404, r4
+ jmp &L404
+L406: add #406, r6
+ jmp &L406
+L408: add #408, r0
+ jmp &L408
+L410: add #410, r2
+ jmp &L410
+L412: add #412, r4
+ jmp &L412
+L414: add #414, r6
+ jmp &L414
+L416: add #416, r0
+ jmp &L416
+L418: add #418, r2
+ jmp &L418
+L420: add #420, r4
+ jmp &L420
+L422: add #422, r6
+ jmp &L422
+L424: add #424, r0
+ jmp &L424
+L426: add #426, r2
+ jmp &L426
+L428: add #428, r4
+ jmp &L428
+L430: add #430, r6
+ jmp &L430
+L432: add #432, r0
+ jmp &L432
+L434: add #434, r2
+ jmp &L434
+L436: add #436, r4
+ jmp &L436
+L438: add #438, r6
+ jmp &L438
+L440: add #440, r0
+ jmp &L440
+L442: add #442, r2
+ jmp &L442
+L444: add #444, r4
+ jmp &L444
+L446: add #446, r6
+ jmp &L446
+L448: add #448, r0
+ jmp &L448
+L450: add #450, r2
+ jmp &L450
+L452: add #452, r4
+ jmp &L452
+L454: add #454, r6
+ jmp &L454
+L456: add #456, r0
+ jmp &L456
+L458: add #458, r2
+ jmp &L458
+L460: add #460, r4
+ jmp &L460
+L462: add #462, r6
+ jmp &L462
+L464: add #464, r0
+ jmp &L464
+L466: add #466, r2
+ jmp &L466
+L468: add #468, r4
+ jmp &L468
+L470: add #470, r6
+ jmp &L470
+L472: add #472, r0
+ jmp &L472
+L474: add #474, r2
+ jmp &L474
+L476: add #476, r4
+ jmp &L476
+L478: add #478, r6
+ jmp &L478
+L480: add #480, r0
+ jmp &L480
+L482: add #482, r2
+ jmp &L482
+L484: add #484, r4
+ jmp &L484
+L486: add #486, r6
+ jmp &L486
+L488: add #488, r0
+ jmp &L488
+L490: add #490, r2
+ jmp &L490
+L492: add #492, r4
+ jmp &L492
+L494: add #494, r6
+ jmp &L494
+L496: add #496, r0
+ jmp &L496
+L498: add #498, r2
+ jmp &L498
+L500: add #500, r4
+ jmp &L500
+L502: add #502, r6
+ jmp &L502
+L504: add #504, r0
+ jmp &L504
+L506: add #506, r2
+ jmp &L506
+L508: add #508, r4
+ jmp &L508
+L510: add #510, r6
+ jmp &L510
+L512: add #512, r0
+ jmp &L512
+L514: add #514, r2
+ jmp &L514
+L516: add #516, r4
+ jmp &L516
+L518: add #518, r6
+ jmp &L518
+L520: add #520, r0
+ jmp &L520
+L522: add #522, r2
+ jmp &L522
+L524: add #524, r4
+ jmp &L524
+L526: add #526, r6
+ jmp &L526
+L528: add #528, r0
+ jmp &L528
+L530: add #530, r2
+ jmp &L530
+L532: add #532, r4
+ jmp &L532
+L534: add #534, r6
+ jmp &L534
+L536: add #536, r0
+ jmp &L536
+L538: add #538, r2
+ jmp &L538
+L540: add #540, r4
+ jmp &L540
+L542: add #542, r6
+ jmp &L542
+L544: add #544, r0
+ jmp &L544
+L546: add #546, r2
+ jmp &L546
+L548: add #548, r4
+ jmp &L548
+L550: add #550, r6
+ jmp &L550
+L552: add #552, r0
+ jmp &L552
+L554: add #554, r2
+ jmp &L554
+L556: add #556, r4
+ jmp &L556
+L558: add #558, r6
+ jmp &L558
+L560: add #560, r0
+ jmp &L560
+L562: add #562, r2
+ jmp &L562
+L564: add #564, r4
+ jmp &L564
+L566: add #566, r6
+ jmp &L566
+L568: add #568, r0
+ jmp &L568
+L570: add #570, r2
+ jmp &L570
+L572: add #572, r4
+ jmp &L572
+L574: add #574, r6
+ jmp &L574
+L576: add #576, r0
+ jmp &L576
+L578: add #578, r2
+ jmp &L578
+L580: add #580, r4
+ jmp &L580
+L582: add #582, r6
+ jmp &L582
+L584: add #584, r0
+ jmp &L584
+L586: add #586, r2
+ jmp &L586
+L588: add #588, r4
+ jmp &L588
+L590: add #590, r6
+ jmp &L590
+L592: add #592, r0
+ jmp &L592
+L594: add #594, r2
+ jmp &L594
+L596: add #596, r4
+ jmp &L596
+L598: add #598, r6
+ jmp &L598
+L600: add #600, r0
+ jmp &L600
+L602: add #602, r2
+ jmp &L602
+L604: add #604, r4
+ jmp &L604
+L606: add #606, r6
+ jmp &L606
+L608: add #608, r0
+ jmp &L608
+L610: add #610, r2
+ jmp &L610
+L612: add #612, r4
+ jmp &L612
+L614: add #614, r6
+ jmp &L614
+L616: add #616, r0
+ jmp &L616
+L618: add #618, r2
+ jmp &L618
+L620: add #620, r4
+ jmp &L620
+L622: add #622, r6
+ jmp &L622
+L624: add #624, r0
+ jmp &L624
+L626: add #626, r2
+ jmp &L626
+L628: add #628, r4
+ jmp &L628
+L630: add #630, r6
+ jmp &L630
+L632: add #632, r0
+ jmp &L632
+L634: add #634, r2
+ jmp &L634
+L636: add #636, r4
+ jmp &L636
+L638: add #638, r6
+ jmp &L638
+L640: add #640, r0
+ jmp &L640
+L642: add #642, r2
+ jmp &L642
+L644: add #644, r4
+ jmp &L644
+L646: add #646, r6
+ jmp &L646
+L648: add #648, r0
+ jmp &L648
+L650: add #650, r2
+ jmp &L650
+L652: add #652, r4
+ jmp &L652
+L654: add #654, r6
+ jmp &L654
+L656: add #656, r0
+ jmp &L656
+L658: add #658, r2
+ jmp &L658
+L660: add #660, r4
+ jmp &L660
+L662: add #662, r6
+ jmp &L662
+L664: add #664, r0
+ jmp &L664
+L666: add #666, r2
+ jmp &L666
+L668: add #668, r4
+ jmp &L668
+L670: add #670, r6
+ jmp &L670
+L672: add #672, r0
+ jmp &L672
+L674: add #674, r2
+ jmp &L674
+L676: add #676, r4
+ jmp &L676
+L678: add #678, r6
+ jmp &L678
+L680: add #680, r0
+ jmp &L680
+L682: add #682, r2
+ jmp &L682
+L684: add #684, r4
+ jmp &L684
+L686: add #686, r6
+ jmp &L686
+L688: add #688, r0
+ jmp &L688
+L690: add #690, r2
+ jmp &L690
+L692: add #692, r4
+ jmp &L692
+L694: add #694, r6
+ jmp &L694
+L696: add #696, r0
+ jmp &L696
+L698: add #698, r2
+ jmp &L698
+L700: add #700, r4
+ jmp &L700
+L702: add #702, r6
+ jmp &L702
+L704: add #704, r0
+ jmp &L704
+L706: add #706, r2
+ jmp &L706
+L708: add #708, r4
+ jmp &L708
+L710: add #710, r6
+ jmp &L710
+L712: add #712, r0
+ jmp &L712
+L714: add #714, r2
+ jmp &L714
+L716: add #716, r4
+ jmp &L716
+L718: add #718, r6
+ jmp &L718
+L720: add #720, r0
+ jmp &L720
+L722: add #722, r2
+ jmp &L722
+L724: add #724, r4
+ jmp &L724
+L726: add #726, r6
+ jmp &L726
+L728: add #728, r0
+ jmp &L728
+L730: add #730, r2
+ jmp &L730
+L732: add #732, r4
+ jmp &L732
+L734: add #734, r6
+ jmp &L734
+L736: add #736, r0
+ jmp &L736
+L738: add #738, r2
+ jmp &L738
+L740: add #740, r4
+ jmp &L740
+L742: add #742, r6
+ jmp &L742
+L744: add #744, r0
+ jmp &L744
+L746: add #746, r2
+ jmp &L746
+L748: add #748, r4
+ jmp &L748
+L750: add #750, r6
+ jmp &L750
+L752: add #752, r0
+ jmp &L752
+L754: add #754, r2
+ jmp &L754
+L756: add #756, r4
+ jmp &L756
+L758: add #758, r6
+ jmp &L758
+L760: add #760, r0
+ jmp &L760
+L762: add #762, r2
+ jmp &L762
+L764: add #764, r4
+ jmp &L764
+L766: add #766, r6
+ jmp &L766
+L768: add #768, r0
+ jmp &L768
+L770: add #770, r2
+ jmp &L770
+L772: add #772, r4
+ jmp &L772
+L774: add #774, r6
+ jmp &L774
+L776: add #776, r0
+ jmp &L776
+L778: add #778, r2
+ jmp &L778
+L780: add #780, r4
+ jmp &L780
+L782: add #782, r6
+ jmp &L782
+L784: add #784, r0
+ jmp &L784
+L786: add #786, r2
+ jmp &L786
+L788: add #788, r4
+ jmp &L788
+L790: add #790, r6
+ jmp &L790
+L792: add #792, r0
+ jmp &L792
+L794: add #794, r2
+ jmp &L794
+L796: add #796, r4
+ jmp &L796
+L798: add #798, r6
+ jmp &L798
+L800: add #800, r0
+ jmp &L800
+L802: add #802, r2
+ jmp &L802
+L804: add #804, r4
+ jmp &L804
+L806: add #806, r6
+ jmp &L806
+L808: add #808, r0
+ jmp &L808
+L810: add #810, r2
+ jmp &L810
+L812: add #812, r4
+ jmp &L812
+L814: add #814, r6
+ jmp &L814
+L816: add #816, r0
+ jmp &L816
+L818: add #818, r2
+ jmp &L818
+L820: add #820, r4
+ jmp &L820
+L822: add #822, r6
+ jmp &L822
+L824: add #824, r0
+ jmp &L824
+L826: add #826, r2
+ jmp &L826
+L828: add #828, r4
+ jmp &L828
+L830: add #830, r6
+ jmp &L830
+L832: add #832, r0
+ jmp &L832
+L834: add #834, r2
+ jmp &L834
+L836: add #836, r4
+ jmp &L836
+L838: add #838, r6
+ jmp &L838
+L840: add #840, r0
+ jmp &L840
+L842: add #842, r2
+ jmp &L842
+L844: add #844, r4
+ jmp &L844
+L846: add #846, r6
+ jmp &L846
+L848: add #848, r0
+ jmp &L848
+L850: add #850, r2
+ jmp &L850
+L852: add #852, r4
+ jmp &L852
+L854: add #854, r6
+ jmp &L854
+L856: add #856, r0
+ jmp &L856
+L858: add #858, r2
+ jmp &L858
+L860: add #860, r4
+ jmp &L860
+L862: add #862, r6
+ jmp &L862
+L864: add #864, r0
+ jmp &L864
+L866: add #866, r2
+ jmp &L866
+L868: add #868, r4
+ jmp &L868
+L870: add #870, r6
+ jmp &L870
+L872: add #872, r0
+ jmp &L872
+L874: add #874, r2
+ jmp &L874
+L876: add #876, r4
+ jmp &L876
+L878: add #878, r6
+ jmp &L878
+L880: add #880, r0
+ jmp &L880
+L882: add #882, r2
+ jmp &L882
+L884: add #884, r4
+ jmp &L884
+L886: add #886, r6
+ jmp &L886
+L888: add #888, r0
+ jmp &L888
+L890: add #890, r2
+ jmp &L890
+L892: add #892, r4
+ jmp &L892
+L894: add #894, r6
+ jmp &L894
+L896: add #896, r0
+ jmp &L896
+L898: add #898, r2
+ jmp &L898
+L900: add #900, r4
+ jmp &L900
+L902: add #902, r6
+ jmp &L902
+L904: add #904, r0
+ jmp &L904
+L906: add #906, r2
+ jmp &L906
+L908: add #908, r4
+ jmp &L908
+L910: add #910, r6
+ jmp &L910
+L912: add #912, r0
+ jmp &L912
+L914: add #914, r2
+ jmp &L914
+L916: add #916, r4
+ jmp &L916
+L918: add #918, r6
+ jmp &L918
+L920: add #920, r0
+ jmp &L920
+L922: add #922, r2
+ jmp &L922
+L924: add #924, r4
+ jmp &L924
+L926: add #926, r6
+ jmp &L926
+L928: add #928, r0
+ jmp &L928
+L930: add #930, r2
+ jmp &L930
+L932: add #932, r4
+ jmp &L932
+L934: add #934, r6
+ jmp &L934
+L936: add #936, r0
+ jmp &L936
+L938: add #938, r2
+ jmp &L938
+L940: add #940, r4
+ jmp &L940
+L942: add #942, r6
+ jmp &L942
+L944: add #944, r0
+ jmp &L944
+L946: add #946, r2
+ jmp &L946
+L948: add #948, r4
+ jmp &L948
+L950: add #950, r6
+ jmp &L950
+L952: add #952, r0
+ jmp &L952
+L954: add #954, r2
+ jmp &L954
+L956: add #956, r4
+ jmp &L956
+L958: add #958, r6
+ jmp &L958
+L960: add #960, r0
+ jmp &L960
+L962: add #962, r2
+ jmp &L962
+L964: add #964, r4
+ jmp &L964
+L966: add #966, r6
+ jmp &L966
+L968: add #968, r0
+ jmp &L968
+L970: add #970, r2
+ jmp &L970
+L972: add #972, r4
+ jmp &L972
+L974: add #974, r6
+ jmp &L974
+L976: add #976, r0
+ jmp &L976
+L978: add #978, r2
+ jmp &L978
+L980: add #980, r4
+ jmp &L980
+L982: add #982, r6
+ jmp &L982
+L984: add #984, r0
+ jmp &L984
+L986: add #986, r2
+ jmp &L986
+L988: add #988, r4
+ jmp &L988
+L990: add #990, r6
+ jmp &L990
+L992: add #992, r0
+ jmp &L992
+L994: add #994, r2
+ jmp &L994
+L996: add #996, r4
+ jmp &L996
+L998: add #998, r6
+ jmp &L998
+L1000: add #1000, r0
+ jmp &L1000
+L1002: add #1002, r2
+ jmp &L1002
+L1004: add #1004, r4
+ jmp &L1004
+L1006: add #1006, r6
+ jmp &L1006
+L1008: add #1008, r0
+ jmp &L1008
+L1010: add #1010, r2
+ jmp &L1010
+L1012: add #1012, r4
+ jmp &L1012
+L1014: add #1014, r6
+ jmp &L1014
+L1016: add #1016, r0
+ jmp &L1016
+L1018: add #1018, r2
+ jmp &L1018
+L1020: add #1020, r4
+ jmp &L1020
+L1022: add #1022, r6
+ jmp &L1022
+L1024: add #1024, r0
+ jmp &L1024
+L1026: add #1026, r2
+ jmp &L1026
+L1028: add #1028, r4
+ jmp &L1028
+L1030: add #1030, r6
+ jmp &L1030
+L1032: add #1032, r0
+ jmp &L1032
+L1034: add #1034, r2
+ jmp &L1034
+L1036: add #1036, r4
+ jmp &L1036
+L1038: add #1038, r6
+ jmp &L1038
+L1040: add #1040, r0
+ jmp &L1040
+L1042: add #1042, r2
+ jmp &L1042
+L1044: add #1044, r4
+ jmp &L1044
+L1046: add #1046, r6
+ jmp &L1046
+L1048: add #1048, r0
+ jmp &L1048
+L1050: add #1050, r2
+ jmp &L1050
+L1052: add #1052, r4
+ jmp &L1052
+L1054: add #1054, r6
+ jmp &L1054
+L1056: add #1056, r0
+ jmp &L1056
+L1058: add #1058, r2
+ jmp &L1058
+L1060: add #1060, r4
+ jmp &L1060
+L1062: add #1062, r6
+ jmp &L1062
+L1064: add #1064, r0
+ jmp &L1064
+L1066: add #1066, r2
+ jmp &L1066
+L1068: add #1068, r4
+ jmp &L1068
+L1070: add #1070, r6
+ jmp &L1070
+L1072: add #1072, r0
+ jmp &L1072
+L1074: add #1074, r2
+ jmp &L1074
+L1076: add #1076, r4
+ jmp &L1076
+L1078: add #1078, r6
+ jmp &L1078
+L1080: add #1080, r0
+ jmp &L1080
+L1082: add #1082, r2
+ jmp &L1082
+L1084: add #1084, r4
+ jmp &L1084
+L1086: add #1086, r6
+ jmp &L1086
+L1088: add #1088, r0
+ jmp &L1088
+L1090: add #1090, r2
+ jmp &L1090
+L1092: add #1092, r4
+ jmp &L1092
+L1094: add #1094, r6
+ jmp &L1094
+L1096: add #1096, r0
+ jmp &L1096
+L1098: add #1098, r2
+ jmp &L1098
+L1100: add #1100, r4
+ jmp &L1100
+L1102: add #1102, r6
+ jmp &L1102
+L1104: add #1104, r0
+ jmp &L1104
+L1106: add #1106, r2
+ jmp &L1106
+L1108: add #1108, r4
+ jmp &L1108
+L1110: add #1110, r6
+ jmp &L1110
+L1112: add #1112, r0
+ jmp &L1112
+L1114: add #1114, r2
+ jmp &L1114
+L1116: add #1116, r4
+ jmp &L1116
+L1118: add #1118, r6
+ jmp &L1118
+L1120: add #1120, r0
+ jmp &L1120
+L1122: add #1122, r2
+ jmp &L1122
+L1124: add #1124, r4
+ jmp &L1124
+L1126: add #1126, r6
+ jmp &L1126
+L1128: add #1128, r0
+ jmp &L1128
+L1130: add #1130, r2
+ jmp &L1130
+L1132: add #1132, r4
+ jmp &L1132
+L1134: add #1134, r6
+ jmp &L1134
+L1136: add #1136, r0
+ jmp &L1136
+L1138: add #1138, r2
+ jmp &L1138
+L1140: add #1140, r4
+ jmp &L1140
+L1142: add #1142, r6
+ jmp &L1142
+L1144: add #1144, r0
+ jmp &L1144
+L1146: add #1146, r2
+ jmp &L1146
+L1148: add #1148, r4
+ jmp &L1148
+L1150: add #1150, r6
+ jmp &L1150
+L1152: add #1152, r0
+ jmp &L1152
+L1154: add #1154, r2
+ jmp &L1154
+L1156: add #1156, r4
+ jmp &L1156
+L1158: add #1158, r6
+ jmp &L1158
+L1160: add #1160, r0
+ jmp &L1160
+L1162: add #1162, r2
+ jmp &L1162
+L1164: add #1164, r4
+ jmp &L1164
+L1166: add #1166, r6
+ jmp &L1166
+L1168: add #1168, r0
+ jmp &L1168
+L1170: add #1170, r2
+ jmp &L1170
+L1172: add #1172, r4
+ jmp &L1172
+L1174: add #1174, r6
+ jmp &L1174
+L1176: add #1176, r0
+ jmp &L1176
+L1178: add #1178, r2
+ jmp &L1178
+L1180: add #1180, r4
+ jmp &L1180
+L1182: add #1182, r6
+ jmp &L1182
+L1184: add #1184, r0
+ jmp &L1184
+L1186: add #1186, r2
+ jmp &L1186
+L1188: add #1188, r4
+ jmp &L1188
+L1190: add #1190, r6
+ jmp &L1190
+L1192: add #1192, r0
+ jmp &L1192
+L1194: add #1194, r2
+ jmp &L1194
+L1196: add #1196, r4
+ jmp &L1196
+L1198: add #1198, r6
+ jmp &L1198
+LAST: mov OUT, r1
+ stop
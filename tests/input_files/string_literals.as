@@ -0,0 +1,8 @@
+; commas, colons and directive names inside a string are plain characters
+.entry MSG
+MSG: .string "a:b,,c .data"
+NUMS: .data 1, -2 ,3
+LOOP: mov MSG, r1
+.string"x, y"
+jmp LOOP
+stop
@@ -0,0 +1,50 @@
+/**
+ * Library test driver.
+ * Assembles sources with the library entry point assemble_source, the way a program embedding
+ * libassembler.a does, and writes what the command line assembler writes for the same sources:
+ * the messages on the standard output and the .obj, .ent and .ext files of every assembled source.
+ * `make test_library` compares both.
+ *
+ * Usage: library_test <base1> [base2] ...
+ */
+
+#include <stdio.h>
+
+#include "consts.h"
+#include "utils.h"
+#include "libassembler.h"
+#include "source_file.h"
+
+
+int main(int argc, char* argv[]) {
+    char as_file[FILENAME_MAX];
+    assembler_context context;
+    source_file input;
+    object_file image;
+    diagnostics diag;
+    int status = 0;
+    int i;
+
+    assembler_context_init(&context);
+    for (i = 1; i < argc; i++) {
+        copy_filename_with_different_extension(argv[i], as_file, ".as");
+        if (source_file_open(&input, as_file)) {
+            fprintf(stderr, "Error: Could not read %s.\n", as_file);
+            status = 1;
+            continue;
+        }
+
+        diagnostics_init(&diag);
+        if (assemble_source(&context, input.data, input.size, &image, &diag, NULL) == ASSEMBLED &&
+            object_file_write_text(&image, as_file)) {
+            fprintf(stderr, "Error: Could not write the output files of %s.\n", as_file);
+            status = 1;
+        }
+        diagnostics_flush(&diag, stdout);
+        object_file_free(&image);
+        diagnostics_free(&diag);
+        source_file_close(&input);
+    }
+    assembler_context_free(&context);
+    return status;
+}
@@ -0,0 +1,119 @@
+/**
+ * Client of the resident assembler server (`assembler --server`): sends its arguments and working
+ * directory to the server, which assembles the files and writes its output to the standard output
+ * and standard error of the client. The client exits with the status of the request, so it takes
+ * the place of the assembler in a build rule.
+ *
+ * Usage: assembler_client [assembler options] <file1> [file2] ...
+ *        assembler_client --shutdown   (stops the server)
+ * The server socket is $ASSEMBLER_SOCKET, $XDG_RUNTIME_DIR/assembler.sock by default (see server_protocol.h).
+ */
+
+/* Sockets are not part of ANSI C, request them from the POSIX headers */
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "consts.h"
+#include "server_protocol.h"
+
+
+/**
+ * Connects to the assembler server.
+ *
+ * @param socket_path The path of the server socket.
+ * @return The connected socket, or -1 on failure.
+ */
+int connect_server(const char* socket_path) {
+    struct sockaddr_un address;
+    int fd;
+
+    if (strlen(socket_path) >= sizeof(address.sun_path)) {
+        return -1;
+    }
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, socket_path);
+
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd >= 0 && connect(fd, (struct sockaddr*)&address, sizeof(address))) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/**
+ * Builds the body of a request: the working directory, then the arguments.
+ *
+ * @param argc The number of arguments.
+ * @param argv The arguments.
+ * @param size Receives the size of the body in bytes.
+ * @return The body, or NULL on failure.
+ */
+char* build_request(int argc, char* argv[], unsigned long* size) {
+    char directory[FILENAME_MAX];
+    char* body;
+    char* end;
+    int i;
+
+    if (!getcwd(directory, sizeof(directory))) {
+        return NULL;
+    }
+    *size = strlen(directory) + 1;
+    for (i = 0; i < argc; i++) {
+        *size += strlen(argv[i]) + 1;
+    }
+    body = (char*)malloc(*size);
+    if (!body) {
+        return NULL;
+    }
+
+    strcpy(body, directory);
+    end = body + strlen(directory) + 1;
+    for (i = 0; i < argc; i++) {
+        strcpy(end, argv[i]);
+        end += strlen(argv[i]) + 1;
+    }
+    return body;
+}
+
+int main(int argc, char* argv[]) {
+    const char* socket_path = server_socket_path();
+    unsigned long size;
+    char* body;
+    int status = 1;
+    int fd;
+
+    body = build_request(argc, argv, &size);
+    if (!body) {
+        printf("Error: Could not build the request.\n");
+        return 1;
+    }
+    fd = connect_server(socket_path);
+    if (fd < 0) {
+        printf("Error: No assembler server is listening on %s (start one with `assembler --server`).\n",
+               socket_path);
+        free(body);
+        return 1;
+    }
+
+    /* A server that refuses the client closes the connection: report it instead of dying on SIGPIPE */
+    signal(SIGPIPE, SIG_IGN);
+    fflush(stdout);
+    if (send_request(fd, STDOUT_FILENO, STDERR_FILENO, body, size) || receive_status(fd, &status)) {
+        printf("Error: The connection to the assembler server failed.\n");
+        status = 1;
+    }
+
+    close(fd);
+    free(body);
+    return status;
+}
@@ -0,0 +1,717 @@
+/**
+ * Emulator: runs an assembled program, a text object file (.obj, with the entry labels of the .ent
+ * file next to it) or a binary object file (.bin, e.g., an image written by the linker).
+ * The code is decoded once, before the run, into an array of instructions whose operands point
+ * straight at the register, memory word or constant they use; the run then only dispatches from one
+ * decoded instruction to the next, with computed gotos when the compiler supports them.
+ * The program starts at its first code word and runs until `stop`. `prn` prints its operand as a
+ * decimal number on a line of its own and `red` reads a character (-1 at the end of the input).
+ * `cmp` sets the zero flag tested by `bne`, `jsr` and `rts` use a return stack of their own.
+ * At the end the number of instructions executed, the instructions per second and the instructions
+ * executed under each entry label of the code are printed to the standard error.
+ *
+ * Usage: emulator [-n MAX_STEPS] <program.obj | program.bin>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "consts.h"
+#include "lexer.h"
+#include "object_file.h"
+#include "source_file.h"
+#include "stats.h"
+
+#define STEPS_FLAG "-n"
+#define TEXT_OBJECT_EXTENSION ".obj"
+#define ENTRIES_EXTENSION ".ent"
+
+#define MEMORY_SIZE (OPERAND_MASK + 1)  /* every address an operand word can hold */
+#define REGISTER_COUNT 8
+#define STACK_DEPTH 65536
+#define TEXT_LINE_SIZE 64
+
+#define ARE_MASK 0x7UL
+#define FIELD_MASK(bits) ((1UL << (bits)) - 1)
+#define OPERAND_SIGN_BIT 0x100000L
+
+/* A word as a signed 24-bit number, and an operand value as a signed 21-bit number */
+#define SIGN_EXTEND_WORD(value) ((long)(((unsigned long)(value) & WORD_MASK) ^ WORD_SIGN_BIT) - (long)WORD_SIGN_BIT)
+#define SIGN_EXTEND_OPERAND(value) ((long)(((unsigned long)(value) & OPERAND_MASK) ^ OPERAND_SIGN_BIT) - OPERAND_SIGN_BIT)
+
+/* Operations the decoder leaves in place of an instruction that cannot run; they stop the program when reached */
+typedef enum {
+    ILLEGAL_INSTRUCTION = STOP + 1,  /* not an instruction, or an addressing mode the instruction does not allow */
+    OPERAND_WORD,                    /* an operand word of an instruction, or a data word */
+    EXTERNAL_OPERAND,                /* an operand referring to an external label, not linked */
+    CODE_WRITE,                      /* an instruction writing to the code */
+    END_OF_CODE,                     /* past the last code word */
+    OPERATION_COUNT
+} fault;
+
+/* An instruction decoded for running */
+typedef struct decoded_instruction {
+    int operation;                          /* the opcode, or a fault */
+    long* source;                           /* the source operand */
+    long* dest;                             /* the destination operand */
+    struct decoded_instruction* target;     /* the instruction jumped to, NULL if it is not one */
+    struct decoded_instruction* next;       /* the instruction that follows */
+    long source_value;                      /* the source constant: an immediate value or an address */
+    long dest_value;                        /* the destination constant */
+    unsigned long target_address;           /* the address jumped to */
+    unsigned long address;                  /* the address of the first word */
+    unsigned long executions;               /* the number of times the instruction was executed */
+} decoded_instruction;
+
+/* A label of the program */
+typedef struct {
+    char name[MAX_LABEL_LENGTH + 1];
+    unsigned long address;
+    unsigned long executions;  /* instructions executed from the label up to the next label */
+} program_label;
+
+/* The machine running a program */
+typedef struct {
+    object_file object;
+    long* memory;                        /* MEMORY_SIZE words, the program loaded at its base address */
+    long registers[REGISTER_COUNT];
+    int zero;                            /* the zero flag, set by cmp */
+    decoded_instruction* code;           /* one per code word, and one END_OF_CODE past the last */
+    unsigned long code_count;
+    program_label* labels;
+    unsigned long label_count;
+    decoded_instruction** stack;         /* the return addresses of jsr */
+    unsigned long executed;
+    double seconds;
+} machine;
+
+
+/**
+ * Reads a text object file (.obj) into an object file held in memory.
+ *
+ * @param object The object file to fill, released with object_file_free.
+ * @param filename The name of the .obj file.
+ * @return SUCCESS on success, 1 if the file could not be read or is not a text object file.
+ */
+int read_text_object(object_file* object, const char* filename) {
+    source_file file;
+    line_reader reader;
+    line_view line;
+    char text[TEXT_LINE_SIZE];
+    unsigned long code_count, data_count, address, word;
+    unsigned long i = 0;
+    int header = 1;
+
+    memset(object, 0, sizeof(*object));
+    if (source_file_open(&file, filename)) {
+        return 1;
+    }
+    line_reader_init(&reader, file.data, file.size);
+    while (line_reader_next(&reader, &line)) {
+        if (line.length >= TEXT_LINE_SIZE) {
+            break;
+        }
+        memcpy(text, line.text, line.length);
+        text[line.length] = '\0';
+
+        if (header) {
+            if (sscanf(text, "%lu %lu", &code_count, &data_count) != 2 || code_count + data_count > MEMORY_SIZE) {
+                break;
+            }
+            object->base_address = CODE_BASE_ADDRESS;
+            object->ICF = CODE_BASE_ADDRESS + code_count;
+            object->DCF = data_count;
+            object->word_count = code_count + data_count;
+            if (object_file_allocate(object)) {
+                break;
+            }
+            header = 0;
+            continue;
+        }
+        if (i == object->word_count || sscanf(text, "%lu %lx", &address, &word) != 2 ||
+            address != object->base_address + i) {
+            break;
+        }
+        object->words[i++] = word & WORD_MASK;
+    }
+    source_file_close(&file);
+
+    if (header || i != object->word_count) {
+        object_file_free(object);
+        return 1;
+    }
+    return SUCCESS;
+}
+
+/**
+ * Reads the labels of a text entries file (.ent) into the labels of the machine.
+ *
+ * @param vm The machine.
+ * @param filename The name of the .ent file.
+ * @return SUCCESS on success (a missing file has no labels), MEMORY_ALLOCATION_FAILED on failure.
+ */
+int read_text_entries(machine* vm, const char* filename) {
+    source_file file;
+    line_reader reader;
+    line_view line;
+    char text[TEXT_LINE_SIZE];
+    program_label* label;
+    unsigned long count = 0;
+
+    if (source_file_open(&file, filename)) {
+        return SUCCESS;
+    }
+    line_reader_init(&reader, file.data, file.size);
+    while (line_reader_next(&reader, &line)) {
+        count++;
+    }
+    vm->labels = (program_label*)calloc(count ? count : 1, sizeof(program_label));
+    if (!vm->labels) {
+        source_file_close(&file);
+        return MEMORY_ALLOCATION_FAILED;
+    }
+
+    line_reader_init(&reader, file.data, file.size);
+    while (line_reader_next(&reader, &line)) {
+        label = &vm->labels[vm->label_count];
+        if (line.length >= TEXT_LINE_SIZE) {
+            continue;
+        }
+        memcpy(text, line.text, line.length);
+        text[line.length] = '\0';
+        if (sscanf(text, "%31s %lu", label->name, &label->address) == 2) {
+            vm->label_count++;
+        }
+    }
+    source_file_close(&file);
+    return SUCCESS;
+}
+
+/**
+ * Loads a program: a text object file with its entries file, or a binary object file.
+ *
+ * @param vm The machine.
+ * @param filename The name of the .obj or .bin file.
+ * @return SUCCESS on success, 1 if the program could not be read, MEMORY_ALLOCATION_FAILED on failure.
+ */
+int load_program(machine* vm, const char* filename) {
+    char entries_filename[FILENAME_MAX];
+    size_t length = strlen(filename);
+    size_t extension = strlen(TEXT_OBJECT_EXTENSION);
+    unsigned long i;
+
+    if (length > extension && !strcmp(filename + length - extension, TEXT_OBJECT_EXTENSION)) {
+        if (read_text_object(&vm->object, filename) || length - extension + sizeof(ENTRIES_EXTENSION) > FILENAME_MAX) {
+            return 1;
+        }
+        memcpy(entries_filename, filename, length - extension);
+        strcpy(entries_filename + length - extension, ENTRIES_EXTENSION);
+        return read_text_entries(vm, entries_filename);
+    }
+
+    if (object_file_read(&vm->object, filename)) {
+        return 1;
+    }
+    vm->labels = (program_label*)calloc(vm->object.entry_count ? vm->object.entry_count : 1, sizeof(program_label));
+    if (!vm->labels) {
+        return MEMORY_ALLOCATION_FAILED;
+    }
+    for (i = 0; i < vm->object.entry_count; i++) {
+        strncpy(vm->labels[i].name, vm->object.entries[i].name, MAX_LABEL_LENGTH);
+        vm->labels[i].address = vm->object.entries[i].address;
+    }
+    vm->label_count = vm->object.entry_count;
+    return SUCCESS;
+}
+
+/**
+ * @param opcode_value The opcode field of a first word.
+ * @param funct The funct field of a first word.
+ * @return The row of OPCODE_TABLE of the instruction, -1 if there is none.
+ */
+int find_opcode_rule(unsigned long opcode_value, unsigned long funct) {
+    int i;
+
+    for (i = 0; i < OPCODE_TABLE_SIZE; i++) {
+        if ((unsigned long)OPCODE_TABLE[i].opcode_value == opcode_value && (unsigned long)OPCODE_TABLE[i].funct == funct) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @param opcode An opcode.
+ * @return 1 if the instruction writes its destination operand.
+ */
+int writes_dest(int opcode) {
+    return opcode != CMP && opcode != PRN && opcode != JMP && opcode != BNE && opcode != JSR;
+}
+
+/**
+ * Decodes an operand of an instruction, pointing it at the register, memory word or constant it uses.
+ *
+ * @param vm The machine.
+ * @param instruction The instruction.
+ * @param mode The addressing mode of the operand.
+ * @param reg The register field of the operand.
+ * @param word_address The address of the next unused operand word of the instruction, advanced past the operand's word.
+ * @param location Receives where the operand is read and written.
+ * @param constant The constant of the operand, for an immediate value.
+ * @param address Receives the address the operand refers to (direct and relative modes).
+ * @return SUCCESS, or the fault of the operand.
+ */
+int decode_operand(machine* vm, decoded_instruction* instruction, unsigned long mode, unsigned long reg,
+                   unsigned long* word_address, long** location, long* constant, unsigned long* address) {
+    unsigned long word;
+
+    if (mode == REGISTER_ADDRESS_MODE) {
+        *location = &vm->registers[reg];
+        return SUCCESS;
+    }
+    if (*word_address >= vm->object.ICF) {
+        return ILLEGAL_INSTRUCTION;
+    }
+    word = (unsigned long)vm->memory[*word_address] & WORD_MASK;
+    (*word_address)++;
+
+    if ((word & ARE_MASK) == ARE_EXTERNAL) {
+        return EXTERNAL_OPERAND;
+    }
+    if (mode == IMMEDIATE_ADDRESS_MODE) {
+        *constant = SIGN_EXTEND_OPERAND(word >> OPERAND_SHIFT);
+        *location = constant;
+        return SUCCESS;
+    }
+    if (mode == DIRECT_ADDRESS_MODE) {
+        *address = (word >> OPERAND_SHIFT) & OPERAND_MASK;
+    } else {
+        /* relative to the first word of the instruction */
+        *address = (instruction->address + SIGN_EXTEND_OPERAND(word >> OPERAND_SHIFT)) & OPERAND_MASK;
+    }
+    *location = &vm->memory[*address];
+    return SUCCESS;
+}
+
+/**
+ * Decodes the instruction at an address.
+ *
+ * @param vm The machine.
+ * @param address The address of the first word.
+ * @return The number of words of the instruction, 1 if it is not an instruction.
+ */
+unsigned long decode_instruction(machine* vm, unsigned long address) {
+    decoded_instruction* instruction = &vm->code[address - vm->object.base_address];
+    unsigned long word = (unsigned long)vm->memory[address] & WORD_MASK;
+    unsigned long source_mode = (word >> SRC_MODE_SHIFT) & FIELD_MASK(2);
+    unsigned long dest_mode = (word >> DEST_MODE_SHIFT) & FIELD_MASK(2);
+    unsigned long word_address = address + 1;
+    unsigned long ignored;
+    const OpcodeRule* rule;
+    int row = find_opcode_rule(word >> OPCODE_SHIFT, (word >> FUNCT_SHIFT) & FIELD_MASK(5));
+    int fault = SUCCESS;
+
+    instruction->address = address;
+    instruction->source = &instruction->source_value;
+    instruction->dest = &instruction->dest_value;
+    if (row < 0) {
+        instruction->operation = ILLEGAL_INSTRUCTION;
+        return 1;
+    }
+    rule = &OPCODE_TABLE[row];
+    instruction->operation = rule->opcode;
+
+    /* The modes of missing operands must be zero */
+    if ((rule->num_of_operands == 2 && !(rule->source_modes & MODE_BIT(source_mode))) ||
+        (rule->num_of_operands < 2 && source_mode) ||
+        (rule->num_of_operands >= 1 && !(rule->dest_modes & MODE_BIT(dest_mode))) ||
+        (rule->num_of_operands < 1 && dest_mode)) {
+        instruction->operation = ILLEGAL_INSTRUCTION;
+        return 1;
+    }
+
+    if (rule->num_of_operands == 2) {
+        fault = decode_operand(vm, instruction, source_mode, (word >> SRC_REG_SHIFT) & FIELD_MASK(3), &word_address,
+                               &instruction->source, &instruction->source_value, &ignored);
+        if (rule->opcode == LEA) {
+            instruction->source_value = (long)ignored;  /* the address itself */
+            instruction->source = &instruction->source_value;
+        }
+    }
+    if (rule->num_of_operands >= 1 && fault == SUCCESS) {
+        fault = decode_operand(vm, instruction, dest_mode, (word >> DEST_REG_SHIFT) & FIELD_MASK(3), &word_address,
+                               &instruction->dest, &instruction->dest_value, &instruction->target_address);
+    }
+    if (fault == SUCCESS && writes_dest(rule->opcode) && instruction->dest >= vm->memory + vm->object.base_address &&
+        instruction->dest < vm->memory + vm->object.ICF) {
+        fault = CODE_WRITE;
+    }
+    if (fault != SUCCESS) {
+        instruction->operation = fault;
+    }
+    return word_address - address;
+}
+
+/**
+ * Decodes the code of the program once, instruction by instruction from its first word, and links
+ * every instruction to the next one and every jump to its target.
+ *
+ * @param vm The machine, with the program loaded.
+ * @return SUCCESS on success, MEMORY_ALLOCATION_FAILED on failure.
+ */
+int decode_program(machine* vm) {
+    unsigned long base = vm->object.base_address;
+    unsigned long address = base;
+    unsigned long length;
+    unsigned long i;
+    decoded_instruction* instruction;
+
+    vm->code_count = vm->object.ICF - base;
+    vm->code = (decoded_instruction*)calloc(vm->code_count + 1, sizeof(decoded_instruction));
+    if (!vm->code) {
+        return MEMORY_ALLOCATION_FAILED;
+    }
+    for (i = 0; i <= vm->code_count; i++) {
+        vm->code[i].operation = i < vm->code_count ? OPERAND_WORD : END_OF_CODE;
+        vm->code[i].address = base + i;
+    }
+
+    while (address < vm->object.ICF) {
+        length = decode_instruction(vm, address);
+        vm->code[address - base].next = &vm->code[address - base + length];
+        address += length;
+    }
+
+    for (i = 0; i < vm->code_count; i++) {
+        instruction = &vm->code[i];
+        if ((instruction->operation == JMP || instruction->operation == BNE || instruction->operation == JSR) &&
+            instruction->target_address >= base && instruction->target_address < vm->object.ICF) {
+            instruction->target = &vm->code[instruction->target_address - base];
+        }
+    }
+    return SUCCESS;
+}
+
+/**
+ * Reports why the program stopped before `stop`.
+ *
+ * @param instruction The instruction that could not run.
+ */
+void report_fault(const decoded_instruction* instruction) {
+    fflush(stdout);
+    switch (instruction->operation) {
+        case ILLEGAL_INSTRUCTION:
+            fprintf(stderr, "Error: Illegal instruction at address %lu.\n", instruction->address);
+            break;
+        case OPERAND_WORD:
+            fprintf(stderr, "Error: Jump into the middle of an instruction at address %lu.\n", instruction->address);
+            break;
+        case EXTERNAL_OPERAND:
+            fprintf(stderr, "Error: Unlinked external operand at address %lu.\n", instruction->address);
+            break;
+        case CODE_WRITE:
+            fprintf(stderr, "Error: Write to the code at address %lu.\n", instruction->address);
+            break;
+        case END_OF_CODE:
+            fprintf(stderr, "Error: Ran past the end of the code at address %lu.\n", instruction->address);
+            break;
+        default:
+            /* a jump outside the code */
+            fprintf(stderr, "Error: Jump to address %lu outside the code at address %lu.\n",
+                    instruction->target_address, instruction->address);
+            break;
+    }
+}
+
+#if defined(__GNUC__) && !defined(EMULATOR_SWITCH_DISPATCH)
+#define COMPUTED_GOTO
+#endif
+
+/* Every operation ends by moving on to the next instruction to run, counting it */
+#ifdef COMPUTED_GOTO
+#define OPERATION(name) name##_operation:
+#define FAULT_OPERATION fault_operation:
+#define DISPATCH() \
+    do { \
+        if (!remaining--) goto step_limit; \
+        current->executions++; \
+        __extension__ ({ goto *handlers[current->operation]; }); \
+    } while (0)
+#else
+#define OPERATION(name) case name:
+#define FAULT_OPERATION default:
+#define DISPATCH() continue
+#endif
+
+/**
+ * Runs the decoded program from its first instruction.
+ *
+ * @param vm The machine, with the program decoded.
+ * @param max_steps The most instructions to run, 0 for no limit.
+ * @return SUCCESS if the program reached `stop`, 1 otherwise.
+ */
+int run_program(machine* vm, unsigned long max_steps) {
+#ifdef COMPUTED_GOTO
+    static const void* const handlers[OPERATION_COUNT] = {
+        __extension__ &&MOV_operation, __extension__ &&CMP_operation, __extension__ &&ADD_operation,
+        __extension__ &&SUB_operation, __extension__ &&LEA_operation, __extension__ &&CLR_operation,
+        __extension__ &&NOT_operation, __extension__ &&INC_operation, __extension__ &&DEC_operation,
+        __extension__ &&JMP_operation, __extension__ &&BNE_operation, __extension__ &&JSR_operation,
+        __extension__ &&RED_operation, __extension__ &&PRN_operation, __extension__ &&RTS_operation,
+        __extension__ &&STOP_operation, __extension__ &&fault_operation, __extension__ &&fault_operation,
+        __extension__ &&fault_operation, __extension__ &&fault_operation, __extension__ &&fault_operation
+    };
+#endif
+    decoded_instruction* current = vm->code;
+    decoded_instruction** stack = vm->stack;
+    unsigned long depth = 0;
+    unsigned long remaining = max_steps ? max_steps : (unsigned long)-1;
+    int zero = 0;
+    int result = 1;
+    double start = stats_wall_time();
+    int c;
+
+#ifdef COMPUTED_GOTO
+    DISPATCH();
+#else
+    for (;;) {
+        if (!remaining--) {
+            goto step_limit;
+        }
+        current->executions++;
+        switch (current->operation) {
+#endif
+    OPERATION(MOV)
+        *current->dest = *current->source;
+        current = current->next;
+        DISPATCH();
+    OPERATION(CMP)
+        zero = *current->source == *current->dest;
+        current = current->next;
+        DISPATCH();
+    OPERATION(ADD)
+        *current->dest = SIGN_EXTEND_WORD(*current->dest + *current->source);
+        current = current->next;
+        DISPATCH();
+    OPERATION(SUB)
+        *current->dest = SIGN_EXTEND_WORD(*current->dest - *current->source);
+        current = current->next;
+        DISPATCH();
+    OPERATION(LEA)
+        *current->dest = *current->source;
+        current = current->next;
+        DISPATCH();
+    OPERATION(CLR)
+        *current->dest = 0;
+        current = current->next;
+        DISPATCH();
+    OPERATION(NOT)
+        *current->dest = SIGN_EXTEND_WORD(~*current->dest);
+        current = current->next;
+        DISPATCH();
+    OPERATION(INC)
+        *current->dest = SIGN_EXTEND_WORD(*current->dest + 1);
+        current = current->next;
+        DISPATCH();
+    OPERATION(DEC)
+        *current->dest = SIGN_EXTEND_WORD(*current->dest - 1);
+        current = current->next;
+        DISPATCH();
+    OPERATION(JMP)
+        if (!current->target) {
+            goto fault;
+        }
+        current = current->target;
+        DISPATCH();
+    OPERATION(BNE)
+        if (zero) {
+            current = current->next;
+            DISPATCH();
+        }
+        if (!current->target) {
+            goto fault;
+        }
+        current = current->target;
+        DISPATCH();
+    OPERATION(JSR)
+        if (!current->target) {
+            goto fault;
+        }
+        if (depth == STACK_DEPTH) {
+            fflush(stdout);
+            fprintf(stderr, "Error: Return stack overflow at address %lu.\n", current->address);
+            current->executions--;
+            goto done;
+        }
+        stack[depth++] = current->next;
+        current = current->target;
+        DISPATCH();
+    OPERATION(RED)
+        c = getchar();
+        *current->dest = c == EOF ? -1 : c;
+        current = current->next;
+        DISPATCH();
+    OPERATION(PRN)
+        printf("%ld\n", *current->dest);
+        current = current->next;
+        DISPATCH();
+    OPERATION(RTS)
+        if (depth == 0) {
+            fflush(stdout);
+            fprintf(stderr, "Error: Return stack underflow at address %lu.\n", current->address);
+            current->executions--;
+            goto done;
+        }
+        current = stack[--depth];
+        DISPATCH();
+    OPERATION(STOP)
+        result = SUCCESS;
+        goto done;
+    FAULT_OPERATION
+        goto fault;
+#ifndef COMPUTED_GOTO
+        }
+    }
+#endif
+
+fault:
+    current->executions--;  /* it did not run */
+    report_fault(current);
+    goto done;
+step_limit:
+    fflush(stdout);
+    fprintf(stderr, "Error: Stopped after %lu instructions at address %lu.\n", max_steps, current->address);
+done:
+    vm->zero = zero;
+    vm->seconds = stats_wall_time() - start;
+    fflush(stdout);
+    return result;
+}
+
+/**
+ * Orders labels by address.
+ */
+int compare_label_addresses(const void* a, const void* b) {
+    unsigned long first = ((const program_label*)a)->address;
+    unsigned long second = ((const program_label*)b)->address;
+    return first < second ? -1 : first > second;
+}
+
+/**
+ * Orders labels by the number of instructions executed under them, the most first.
+ */
+int compare_label_executions(const void* a, const void* b) {
+    unsigned long first = ((const program_label*)a)->executions;
+    unsigned long second = ((const program_label*)b)->executions;
+    return first > second ? -1 : first < second;
+}
+
+/**
+ * Prints the number of instructions executed, their rate and how many ran under each code label:
+ * the instructions from a label up to the next one count for the label.
+ *
+ * @param vm The machine, after the run.
+ */
+void print_profile(machine* vm) {
+    unsigned long before_labels = 0;
+    unsigned long label = 0;
+    unsigned long i;
+
+    qsort(vm->labels, vm->label_count, sizeof(program_label), compare_label_addresses);
+    vm->executed = 0;
+    for (i = 0; i < vm->code_count; i++) {
+        while (label < vm->label_count && vm->labels[label].address <= vm->code[i].address) {
+            label++;
+        }
+        if (label == 0) {
+            before_labels += vm->code[i].executions;
+        } else {
+            vm->labels[label - 1].executions += vm->code[i].executions;
+        }
+        vm->executed += vm->code[i].executions;
+    }
+    qsort(vm->labels, vm->label_count, sizeof(program_label), compare_label_executions);
+
+    fprintf(stderr, "Executed %lu instructions in %.3f seconds", vm->executed, vm->seconds);
+    if (vm->seconds > 0) {
+        fprintf(stderr, ", %.0f instructions/sec", vm->executed / vm->seconds);
+    }
+    fprintf(stderr, "\n%-31s %14s %7s\n", "label", "instructions", "share");
+    if (before_labels) {
+        fprintf(stderr, "%-31s %14lu %6.2f%%\n", "(before any label)", before_labels,
+                100.0 * before_labels / vm->executed);
+    }
+    for (i = 0; i < vm->label_count && vm->labels[i].executions; i++) {
+        fprintf(stderr, "%-31s %14lu %6.2f%%\n", vm->labels[i].name, vm->labels[i].executions,
+                100.0 * vm->labels[i].executions / vm->executed);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    machine vm;
+    const char* filename = NULL;
+    unsigned long max_steps = 0;
+    char* end;
+    int failed = 1;
+    unsigned long i;
+    int arg;
+
+    for (arg = 1; arg < argc; arg++) {
+        if (!strcmp(argv[arg], STEPS_FLAG) && arg + 1 < argc) {
+            max_steps = strtoul(argv[++arg], &end, 10);
+            if (*end != '\0' || max_steps == 0) {
+                printf("Error: %s expects a positive number of instructions.\n", STEPS_FLAG);
+                return NO_INPUT_FILES;
+            }
+        } else {
+            filename = argv[arg];
+        }
+    }
+    if (filename == NULL) {
+        printf("Usage: %s [%s MAX_STEPS] <program%s | program%s>\n", argv[0], STEPS_FLAG, TEXT_OBJECT_EXTENSION,
+               BINARY_OBJECT_EXTENSION);
+        return NO_INPUT_FILES;
+    }
+
+    memset(&vm, 0, sizeof(vm));
+    switch (load_program(&vm, filename)) {
+        case SUCCESS:
+            break;
+        case MEMORY_ALLOCATION_FAILED:
+            printf("Error: Memory allocation failed.\n");
+            goto cleanup;
+        default:
+            printf("Error: %s is not a valid object file.\n", filename);
+            goto cleanup;
+    }
+    if (vm.object.base_address + vm.object.word_count > MEMORY_SIZE) {
+        printf("Error: The program of %lu words does not fit the memory.\n", vm.object.word_count);
+        goto cleanup;
+    }
+
+    vm.memory = (long*)calloc(MEMORY_SIZE, sizeof(long));
+    vm.stack = (decoded_instruction**)malloc(STACK_DEPTH * sizeof(decoded_instruction*));
+    if (!vm.memory || !vm.stack) {
+        printf("Error: Memory allocation failed.\n");
+        goto cleanup;
+    }
+    for (i = 0; i < vm.object.word_count; i++) {
+        vm.memory[vm.object.base_address + i] = SIGN_EXTEND_WORD(vm.object.words[i]);
+    }
+    if (decode_program(&vm)) {
+        printf("Error: Memory allocation failed.\n");
+        goto cleanup;
+    }
+
+    failed = run_program(&vm, max_steps);
+    print_profile(&vm);
+
+cleanup:
+    object_file_free(&vm.object);
+    free(vm.memory);
+    free(vm.stack);
+    free(vm.code);
+    free(vm.labels);
+    return failed;
+}
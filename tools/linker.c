@@ -0,0 +1,350 @@
+/**
+ * Linker: combines binary object modules (.bin, written by `assembler --binary`) into a single image.
+ * The code of all the modules comes first, in command line order, followed by their data. Every
+ * `.entry` label goes into one hashed global index; the external references of each module
+ * (the E-bit operand words) are patched with the address of the matching entry, and the relocatable
+ * (R-bit) operand words are moved by the new base of their module. Duplicate entries and undefined
+ * externals are reported and no image is written. The work is linear in the number of words and
+ * references, with a constant time index lookup per external reference.
+ *
+ * The image is a binary object file as well: its entries are the global index, it has no externals,
+ * and its relocations list every word holding an address, so it can be placed at another base.
+ *
+ * Usage: linker -o <image.bin> <module1.bin> [module2.bin] ...
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "consts.h"
+#include "vector.h"
+#include "symbol_table.h"
+#include "object_file.h"
+
+#define OUTPUT_FLAG "-o"
+
+#define ARE_BITS 3
+#define ARE_MASK 0x7UL
+#define ADDRESS_MASK 0x1FFFFFUL  /* the 21-bit address field of an operand word */
+
+/* A module being linked */
+typedef struct {
+    const char* path;
+    object_file object;
+    unsigned long code_base;  /* the address of the first code word of the module in the image */
+    unsigned long data_base;  /* the address of the first data word of the module in the image */
+} module;
+
+/* The state of a link */
+typedef struct {
+    module* modules;
+    int module_count;
+    symbol_table index;    /* the entry labels of all the modules, with their addresses in the image */
+    vector owners;         /* int items: the module defining each symbol id of the index */
+    unsigned long code_words;
+    unsigned long data_words;
+    unsigned long references;
+    int errors;
+} linker;
+
+
+/**
+ * Reads every module.
+ *
+ * @param linker The link.
+ * @return SUCCESS on success, 1 if a module could not be read.
+ */
+int load_modules(linker* linker) {
+    int i;
+
+    for (i = 0; i < linker->module_count; i++) {
+        if (object_file_read(&linker->modules[i].object, linker->modules[i].path)) {
+            printf("Error: %s is not a valid binary object file.\n", linker->modules[i].path);
+            linker->module_count = i;  /* only the modules read so far are freed */
+            return 1;
+        }
+    }
+    return SUCCESS;
+}
+
+/**
+ * Places the code of every module, then the data of every module, one after the other.
+ *
+ * @param linker The link.
+ * @return SUCCESS on success, 1 if the image does not fit the address space.
+ */
+int layout_modules(linker* linker) {
+    unsigned long code_words = 0, data_words = 0;
+    int i;
+
+    for (i = 0; i < linker->module_count; i++) {
+        code_words += linker->modules[i].object.ICF - linker->modules[i].object.base_address;
+        data_words += linker->modules[i].object.DCF;
+    }
+    if (CODE_BASE_ADDRESS + code_words + data_words > ADDRESS_MASK) {
+        printf("Error: The image of %lu words does not fit the address space.\n", code_words + data_words);
+        return 1;
+    }
+
+    linker->code_words = code_words;
+    linker->data_words = data_words;
+    code_words = 0;
+    data_words = 0;
+    for (i = 0; i < linker->module_count; i++) {
+        module* module = &linker->modules[i];
+        module->code_base = CODE_BASE_ADDRESS + code_words;
+        module->data_base = CODE_BASE_ADDRESS + linker->code_words + data_words;
+        code_words += module->object.ICF - module->object.base_address;
+        data_words += module->object.DCF;
+    }
+    return SUCCESS;
+}
+
+/**
+ * @param module The module.
+ * @param address An address of the module, as assembled.
+ * @return The address in the image.
+ */
+unsigned long map_address(const module* module, unsigned long address) {
+    if (address < module->object.ICF) {
+        return module->code_base + (address - module->object.base_address);
+    }
+    return module->data_base + (address - module->object.ICF);
+}
+
+/**
+ * @param module The module.
+ * @param address An address of the module, as assembled.
+ * @return 1 if the address is a code word of the module, 0 otherwise.
+ */
+int is_code_address(const module* module, unsigned long address) {
+    return address >= module->object.base_address && address < module->object.ICF;
+}
+
+/**
+ * Adds the entry labels of every module to the global index, reporting duplicates.
+ *
+ * @param linker The link.
+ * @return SUCCESS on success, MEMORY_ALLOCATION_FAILED on failure.
+ */
+int index_entries(linker* linker) {
+    size_t total = 0;
+    size_t symbol_id;
+    label_element* label;
+    int* owner;
+    unsigned long i;
+    int m;
+
+    for (m = 0; m < linker->module_count; m++) {
+        total += linker->modules[m].object.entry_count;
+    }
+    if (symbol_table_reserve(&linker->index, total) || vector_reserve(&linker->owners, total)) {
+        return MEMORY_ALLOCATION_FAILED;
+    }
+
+    for (m = 0; m < linker->module_count; m++) {
+        const module* module = &linker->modules[m];
+
+        for (i = 0; i < module->object.entry_count; i++) {
+            const object_symbol* entry = &module->object.entries[i];
+
+            if (symbol_table_reference(&linker->index, entry->name, &symbol_id)) {
+                return MEMORY_ALLOCATION_FAILED;
+            }
+            label = symbol_table_get(&linker->index, symbol_id);
+            if (label->label_type != undefined_label) {
+                printf("Error: Symbol (%s) is defined in both %s and %s.\n", entry->name,
+                       linker->modules[VECTOR_ITEMS(linker->owners, int)[symbol_id]].path, module->path);
+                linker->errors++;
+                continue;
+            }
+            if (symbol_table_insert(&linker->index, entry->name, (int)map_address(module, entry->address),
+                                    entry_label)) {
+                return MEMORY_ALLOCATION_FAILED;
+            }
+            while (linker->owners.count <= symbol_id) {
+                owner = (int*)vector_push(&linker->owners);
+                if (!owner) {
+                    return MEMORY_ALLOCATION_FAILED;
+                }
+            }
+            VECTOR_ITEMS(linker->owners, int)[symbol_id] = m;
+        }
+    }
+    return SUCCESS;
+}
+
+/**
+ * Copies the words of a module into the image, moving its relocatable words and resolving its
+ * external references.
+ *
+ * @param linker The link.
+ * @param module The module.
+ * @param words The words of the image.
+ * @param relocations Receives the addresses of the words of the image holding an address.
+ * @return SUCCESS on success, MEMORY_ALLOCATION_FAILED on failure.
+ */
+int link_module(linker* linker, const module* module, unsigned long* words, vector* relocations) {
+    const object_file* object = &module->object;
+    unsigned long code_count = object->ICF - object->base_address;
+    unsigned long address;
+    unsigned long word;
+    unsigned long* relocation;
+    const label_element* label;
+    unsigned long i;
+
+    memcpy(words + (module->code_base - CODE_BASE_ADDRESS), object->words, code_count * sizeof(unsigned long));
+    memcpy(words + (module->data_base - CODE_BASE_ADDRESS), object->words + code_count,
+           object->DCF * sizeof(unsigned long));
+
+    for (i = 0; i < object->relocation_count; i++) {
+        address = object->relocations[i];
+        if (!is_code_address(module, address)) {
+            printf("Error: Invalid relocation address %lu in %s.\n", address, module->path);
+            linker->errors++;
+            continue;
+        }
+        address = map_address(module, address);
+        word = words[address - CODE_BASE_ADDRESS];
+        words[address - CODE_BASE_ADDRESS] =
+            (map_address(module, (word >> ARE_BITS) & ADDRESS_MASK) << ARE_BITS) | (word & ARE_MASK);
+        relocation = (unsigned long*)vector_push(relocations);
+        if (!relocation) {
+            return MEMORY_ALLOCATION_FAILED;
+        }
+        *relocation = address;
+    }
+
+    /* An external reference becomes a relocatable word holding the address of the entry */
+    for (i = 0; i < object->extern_count; i++) {
+        address = object->externals[i].address;
+        if (!is_code_address(module, address)) {
+            printf("Error: Invalid external reference address %lu in %s.\n", address, module->path);
+            linker->errors++;
+            continue;
+        }
+        label = symbol_table_lookup(&linker->index, object->externals[i].name);
+        if (label == NULL) {
+            printf("Error: Undefined symbol (%s) referenced in %s at address %lu.\n", object->externals[i].name,
+                   module->path, address);
+            linker->errors++;
+            continue;
+        }
+        address = map_address(module, address);
+        words[address - CODE_BASE_ADDRESS] = ((unsigned long)label->address << ARE_BITS) | RELOCATABLE_BIT;
+        relocation = (unsigned long*)vector_push(relocations);
+        if (!relocation) {
+            return MEMORY_ALLOCATION_FAILED;
+        }
+        *relocation = address;
+        linker->references++;
+    }
+    return SUCCESS;
+}
+
+/**
+ * Links the modules and writes the image.
+ *
+ * @param linker The link, with its modules read and placed.
+ * @param output The name of the image file.
+ * @return SUCCESS on success, 1 on errors.
+ */
+int write_image(linker* linker, const char* output) {
+    object_file image;
+    vector relocations;
+    size_t i;
+    int result = SUCCESS;
+    int m;
+
+    memset(&image, 0, sizeof(image));
+    vector_init(&relocations, sizeof(unsigned long));
+    image.base_address = CODE_BASE_ADDRESS;
+    image.ICF = CODE_BASE_ADDRESS + linker->code_words;
+    image.DCF = linker->data_words;
+    image.word_count = linker->code_words + linker->data_words;
+    image.words = (unsigned long*)malloc((image.word_count ? image.word_count : 1) * sizeof(unsigned long));
+    image.entry_count = symbol_table_count(&linker->index);
+    image.entries = (object_symbol*)malloc((image.entry_count ? image.entry_count : 1) * sizeof(object_symbol));
+    if (!image.words || !image.entries) {
+        result = MEMORY_ALLOCATION_FAILED;
+    }
+
+    for (m = 0; m < linker->module_count && result == SUCCESS; m++) {
+        result = link_module(linker, &linker->modules[m], image.words, &relocations);
+    }
+    if (result == MEMORY_ALLOCATION_FAILED) {
+        printf("Error: Memory allocation failed.\n");
+    } else if (!linker->errors) {
+        for (i = 0; i < image.entry_count; i++) {
+            const label_element* label = symbol_table_at(&linker->index, i);
+            image.entries[i].name = label->label_name;
+            image.entries[i].address = (unsigned long)label->address;
+        }
+        image.relocation_count = relocations.count;
+        image.relocations = VECTOR_ITEMS(relocations, unsigned long);
+
+        result = object_file_write(&image, output);
+        if (result) {
+            printf("Could not create output file: %s\n", output);
+        }
+    }
+
+    free(image.words);
+    free(image.entries);
+    vector_free(&relocations);
+    return result != SUCCESS || linker->errors;
+}
+
+int main(int argc, char* argv[]) {
+    linker linker;
+    const char* output = NULL;
+    int failed = 1;
+    int i;
+
+    memset(&linker, 0, sizeof(linker));
+    linker.modules = (module*)malloc(argc * sizeof(module));
+    if (!linker.modules) {
+        printf("Error: Memory allocation failed.\n");
+        return MEMORY_ALLOCATION_FAILED;
+    }
+    for (i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], OUTPUT_FLAG) && i + 1 < argc) {
+            output = argv[++i];
+        } else {
+            linker.modules[linker.module_count++].path = argv[i];
+        }
+    }
+    if (output == NULL || linker.module_count == 0) {
+        printf("Usage: %s %s <image%s> <module1%s> [module2%s] ...\n", argv[0], OUTPUT_FLAG, BINARY_OBJECT_EXTENSION,
+               BINARY_OBJECT_EXTENSION, BINARY_OBJECT_EXTENSION);
+        free(linker.modules);
+        return NO_INPUT_FILES;
+    }
+
+    symbol_table_init(&linker.index);
+    vector_init(&linker.owners, sizeof(int));
+
+    if (load_modules(&linker) == SUCCESS && layout_modules(&linker) == SUCCESS) {
+        if (index_entries(&linker)) {
+            printf("Error: Memory allocation failed.\n");
+        } else {
+            failed = write_image(&linker, output);
+        }
+    }
+    if (!failed) {
+        printf("Linked %d modules into %s: %lu code words, %lu data words, %lu entries, %lu external references.\n",
+               linker.module_count, output, linker.code_words, linker.data_words,
+               (unsigned long)symbol_table_count(&linker.index), linker.references);
+    } else if (linker.errors) {
+        printf("Linking failed with %d errors.\n", linker.errors);
+    }
+
+    for (i = 0; i < linker.module_count; i++) {
+        object_file_free(&linker.modules[i].object);
+    }
+    symbol_table_free(&linker.index);
+    vector_free(&linker.owners);
+    free(linker.modules);
+    return failed;
+}
@@ -0,0 +1,71 @@
+/**
+ * Binary object dump tool.
+ * Reads binary object files (.bin) written by `assembler --binary` and writes the .obj, .ent and .ext
+ * text files the assembler writes for the same source, byte for byte, next to each of them.
+ * With -s, prints a summary of the sections of each file instead.
+ *
+ * Usage: object_dump [-s] <file1.bin> [file2.bin] ...
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "consts.h"
+#include "object_file.h"
+
+
+/**
+ * Prints the header and the sections of a binary object file.
+ *
+ * @param filename The name of the file.
+ * @param object The object file.
+ */
+void print_summary(const char* filename, const object_file* object) {
+    unsigned long i;
+
+    printf("%s: base %lu, ICF %lu, DCF %lu, %lu words\n", filename, object->base_address, object->ICF,
+           object->DCF, object->word_count);
+    for (i = 0; i < object->entry_count; i++) {
+        printf("  entry    %-31s %07lu\n", object->entries[i].name, object->entries[i].address);
+    }
+    for (i = 0; i < object->extern_count; i++) {
+        printf("  extern   %-31s %07lu\n", object->externals[i].name, object->externals[i].address);
+    }
+    for (i = 0; i < object->relocation_count; i++) {
+        printf("  relocate %07lu\n", object->relocations[i]);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    object_file object;
+    int summary = 0;
+    int failed = 0;
+    int first = 1;
+    int i;
+
+    if (argc > 1 && !strcmp(argv[1], "-s")) {
+        summary = 1;
+        first = 2;
+    }
+    if (argc <= first) {
+        printf("Usage: %s [-s] <file1%s> [file2%s] ...\n", argv[0], BINARY_OBJECT_EXTENSION, BINARY_OBJECT_EXTENSION);
+        return NO_INPUT_FILES;
+    }
+
+    for (i = first; i < argc; i++) {
+        if (object_file_read(&object, argv[i])) {
+            printf("Error: %s is not a valid binary object file.\n", argv[i]);
+            failed = 1;
+            continue;
+        }
+        if (summary) {
+            print_summary(argv[i], &object);
+        } else if (object_file_write_text(&object, argv[i])) {
+            printf("Error: Could not write the text files of %s.\n", argv[i]);
+            failed = 1;
+        }
+        object_file_free(&object);
+    }
+
+    return failed;
+}